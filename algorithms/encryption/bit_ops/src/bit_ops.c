@@ -9,30 +9,428 @@ extern inline int BitOps_getBit(const Byte_t *bytes, int bitPos);
 extern inline void BitOps_xor(
 	Byte_t *block1, const Byte_t *block2, int numBytes
 );
+extern inline uint64_t BitOps_load64(const Byte_t *bytes);
+extern inline void BitOps_store64(Byte_t *bytes, uint64_t word);
+extern inline uint64_t BitOps_permute(
+	const BitOps_Permutation_t *permutation, uint64_t input
+);
+
+/**
+ * The unit the bulk operations work in: 32 bytes, which GCC maps onto a
+ * single AVX register or a pair of SSE ones, as available.
+ */
+typedef uint64_t _Vector_t __attribute__((vector_size(32)));
+
+/**
+ * Define a bulk operation that applies the compound assignment `operator`
+ * (e.g. `^=`) to every byte of a buffer, a `_Vector_t` at a time.
+ */
+#define DEF_BULK_OP(funcName, operator) \
+	void funcName(Byte_t *target, const Byte_t *source, size_t numBytes){\
+		size_t byte = 0;\
+		for(; byte + sizeof(_Vector_t) <= numBytes; byte += sizeof(_Vector_t)){\
+			_Vector_t targetVector, sourceVector;\
+			memcpy(&targetVector, target + byte, sizeof(_Vector_t));\
+			memcpy(&sourceVector, source + byte, sizeof(_Vector_t));\
+			targetVector operator sourceVector;\
+			memcpy(target + byte, &targetVector, sizeof(_Vector_t));\
+		}\
+		for(; byte < numBytes; byte++){\
+			target[byte] operator source[byte];\
+		}\
+	}
+
+/**
+ * Every byte of a word set to `byte`, for SWAR (SIMD within a register)
+ * arithmetic on the 8 byte lanes of a word.
+ */
+#define LANES(byte) ((uint64_t)(byte) * 0x0101010101010101)
+
+/**
+ * Load 8 bytes of memory as a word of lanes, the first byte in the least
+ * significant lane, whatever the host's byte order.
+ */
+static uint64_t _loadLanes(const void *bytes);
+
+/**
+ * The inverse of `_loadLanes()`.
+ */
+static void _storeLanes(void *bytes, uint64_t lanes);
+
+/**
+ * For lanes below 0x80: set the top bit of each lane that's from `low` to
+ * `high` inclusive, and clear every other bit.
+ */
+static uint64_t _lanesInRange(uint64_t lanes, Byte_t low, Byte_t high);
+
+/**
+ * Return the value of a hexadecimal digit, or -1 if `digit` isn't one.
+ */
+static int _hexValue(char digit);
+
+/**
+ * Load the `numBytes` (at most 8) bytes at `bytes` as the most significant
+ * bytes of a big-endian word, without reading past them.
+ */
+static uint64_t _loadPartial(const Byte_t *bytes, int numBytes);
+
+/**
+ * The inverse of `_loadPartial()`: store the `numBytes` most significant bytes
+ * of `word`.
+ */
+static void _storePartial(Byte_t *bytes, int numBytes, uint64_t word);
+
+/**
+ * Reverse the order of `numBytes` bytes in place.
+ */
+static void _reverseBytes(Byte_t *bytes, size_t numBytes);
+
+/**
+ * Reverse the order of the bits from `first` (inclusive) to `last`
+ * (exclusive) in place, up to 64 from each end at a time.
+ */
+static void _reverseBits(Byte_t *bytes, size_t first, size_t last);
+
+/**
+ * Reverse the order of the bits of a word.
+ */
+static uint64_t _reverseWord(uint64_t word);
 
 void BitOps_rotLeft(Byte_t *bytes, int numBytes){
-	int firstBit = BitOps_getBit(bytes, 0);
-	bytes[0] <<= 1;
-	for(int byte = 1; byte < numBytes; byte++){
-		int firstBitPos = byte * CHAR_BIT;
-		if(BitOps_getBit(bytes, firstBitPos)){
-			BitOps_setBit(bytes, firstBitPos - 1);
+	BitOps_rotLeftBytes(bytes, numBytes, 1);
+}
+
+char *BitOps_getBitString(const Byte_t *bytes, int numBytes){
+	char *bitString = malloc((size_t)numBytes * CHAR_BIT + 1);
+	if(bitString == NULL){
+		return NULL;
+	}
+
+	// Copy each byte into every lane, keep bit `7 - lane` of lane `lane`, and
+	// turn the nonzero lanes into 1s (adding 0x7f carries into the top bit of
+	// any nonzero lane, and never out of it).
+	for(int byte = 0; byte < numBytes; byte++){
+		uint64_t lanes = LANES(bytes[byte]) & 0x0102040810204080;
+		lanes = ((lanes + LANES(0x7f)) >> 7) & LANES(1);
+		_storeLanes(bitString + byte * CHAR_BIT, lanes | LANES('0'));
+	}
+	bitString[(size_t)numBytes * CHAR_BIT] = '\0';
+	return bitString;
+}
+
+bool BitOps_parseBitString(
+	const char *bitString, Byte_t *bytes, size_t numBytes
+){
+	if(strlen(bitString) != numBytes * CHAR_BIT){
+		return false;
+	}
+
+	for(size_t byte = 0; byte < numBytes; byte++){
+		uint64_t lanes = _loadLanes(bitString + byte * CHAR_BIT) ^ LANES('0');
+		if(lanes & ~LANES(1)){
+			return false;
 		}
-		bytes[byte] <<= 1;
+
+		// Multiplying gathers bit `lane` of every lane into bit `63 - lane`;
+		// no two partial products overlap, so nothing carries.
+		bytes[byte] = (lanes * 0x8040201008040201) >> 56;
 	}
+	return true;
+}
 
-	if(firstBit){
-		BitOps_setBit(bytes, numBytes * CHAR_BIT - 1);
+char *BitOps_getHexString(const Byte_t *bytes, size_t numBytes){
+	char *hexString = malloc(numBytes * 2 + 1);
+	if(hexString == NULL){
+		return NULL;
 	}
+
+	// Spread 4 bytes over the even lanes, then split each into its high nibble
+	// and, in the odd lane above it, its low one. `nibble + 6` carries into
+	// bit 4 for the nibbles that are letters.
+	size_t byte = 0;
+	for(; byte + 4 <= numBytes; byte += 4){
+		uint64_t lanes = bytes[byte] | (uint64_t)bytes[byte + 1] << 16 |
+			(uint64_t)bytes[byte + 2] << 32 | (uint64_t)bytes[byte + 3] << 48;
+		lanes = ((lanes >> 4) | (lanes << 8)) & LANES(0x0f);
+		uint64_t letters = ((lanes + LANES(6)) >> 4) & LANES(1);
+		lanes += LANES('0') + letters * ('a' - '0' - 10);
+		_storeLanes(hexString + byte * 2, lanes);
+	}
+	for(; byte < numBytes; byte++){
+		const char *hexDigits = "0123456789abcdef";
+		hexString[byte * 2] = hexDigits[bytes[byte] >> 4];
+		hexString[byte * 2 + 1] = hexDigits[bytes[byte] & 0x0f];
+	}
+	hexString[numBytes * 2] = '\0';
+	return hexString;
 }
 
-char *BitOps_getBitString(const Byte_t *bytes, int numBytes){
-	int numBits = numBytes * CHAR_BIT;
-	char *bitString = malloc(numBits + 1);
-	int bit;
-	for(bit = 0; bit < numBits; bit++){
-		bitString[bit] = '0' + BitOps_getBit(bytes, bit);
+bool BitOps_parseHexString(
+	const char *hexString, Byte_t *bytes, size_t numBytes
+){
+	if(strlen(hexString) != numBytes * 2){
+		return false;
 	}
-	bitString[bit] = 0;
-	return bitString;
+
+	// Setting bit 5 maps capitals onto lowercase letters, and leaves digits
+	// as they are.
+	size_t byte = 0;
+	for(; byte + 4 <= numBytes; byte += 4){
+		uint64_t lanes = _loadLanes(hexString + byte * 2);
+		if(lanes & LANES(0x80)){
+			return false;
+		}
+
+		uint64_t digits = _lanesInRange(lanes, '0', '9');
+		uint64_t letters = _lanesInRange(lanes | LANES(0x20), 'a', 'f');
+		if((digits | letters) != LANES(0x80)){
+			return false;
+		}
+
+		// Then pair up the nibbles and pack the even lanes back together.
+		lanes = (lanes & LANES(0x0f)) + (letters >> 7) * 9;
+		lanes = ((lanes << 4) | (lanes >> 8)) & 0x00ff00ff00ff00ff;
+		lanes = (lanes | (lanes >> 8)) & 0x0000ffff0000ffff;
+		lanes |= lanes >> 16;
+		for(int lane = 0; lane < 4; lane++){
+			bytes[byte + lane] = lanes >> (lane * CHAR_BIT);
+		}
+	}
+	for(; byte < numBytes; byte++){
+		int high = _hexValue(hexString[byte * 2]);
+		int low = _hexValue(hexString[byte * 2 + 1]);
+		if(high < 0 || low < 0){
+			return false;
+		}
+		bytes[byte] = high << 4 | low;
+	}
+	return true;
+}
+
+uint64_t BitOps_extractBits(const Byte_t *bytes, size_t bitPos, int numBits){
+	if(numBits == 0){
+		return 0;
+	}
+
+	// The range spans at most 9 bytes: up to 8 in `word`, and maybe one more.
+	bytes += bitPos / CHAR_BIT;
+	int offset = bitPos % CHAR_BIT,
+		numBytes = (offset + numBits + CHAR_BIT - 1) / CHAR_BIT;
+	uint64_t word = (numBytes >= 8) ?
+		BitOps_load64(bytes) : _loadPartial(bytes, numBytes);
+	word <<= offset;
+	if(numBytes > 8){
+		word |= bytes[8] >> (CHAR_BIT - offset);
+	}
+	return word >> (64 - numBits);
+}
+
+void BitOps_insertBits(
+	Byte_t *bytes, size_t bitPos, int numBits, uint64_t value
+){
+	if(numBits == 0){
+		return;
+	}
+
+	bytes += bitPos / CHAR_BIT;
+	int offset = bitPos % CHAR_BIT,
+		numBytes = (offset + numBits + CHAR_BIT - 1) / CHAR_BIT;
+
+	// Left-align the range, then split it between the first 8 bytes and the
+	// ninth, if it reaches that far.
+	uint64_t mask = ~(uint64_t)0 << (64 - numBits);
+	value <<= 64 - numBits;
+	if(numBytes > 8){
+		int spill = offset + numBits - 64;
+		Byte_t spillMask = (Byte_t)(0xff << (CHAR_BIT - spill));
+		bytes[8] = (bytes[8] & ~spillMask) |
+			((value << (64 - offset)) >> 56 & spillMask);
+	}
+
+	mask >>= offset;
+	value >>= offset;
+	uint64_t word = (numBytes >= 8) ?
+		BitOps_load64(bytes) : _loadPartial(bytes, numBytes);
+	word = (word & ~mask) | (value & mask);
+	if(numBytes >= 8){
+		BitOps_store64(bytes, word);
+	}
+	else {
+		_storePartial(bytes, numBytes, word);
+	}
+}
+
+DEF_BULK_OP(BitOps_xorBytes, ^=)
+DEF_BULK_OP(BitOps_andBytes, &=)
+DEF_BULK_OP(BitOps_orBytes, |=)
+
+void BitOps_rotLeftBytes(Byte_t *bytes, size_t numBytes, size_t rotDist){
+	if(numBytes == 0){
+		return;
+	}
+
+	// Rotate whole bytes by reversing both parts of the array and then the
+	// whole of it, then shift in the remaining bits, 8 bytes at a time.
+	rotDist %= numBytes * CHAR_BIT;
+	size_t byteDist = rotDist / CHAR_BIT;
+	int bitDist = rotDist % CHAR_BIT;
+	if(byteDist != 0){
+		_reverseBytes(bytes, byteDist);
+		_reverseBytes(bytes + byteDist, numBytes - byteDist);
+		_reverseBytes(bytes, numBytes);
+	}
+	if(bitDist == 0){
+		return;
+	}
+
+	Byte_t first = bytes[0];
+	size_t byte = 0;
+	for(; byte + 8 < numBytes; byte += 8){
+		uint64_t word = BitOps_load64(bytes + byte) << bitDist |
+			bytes[byte + 8] >> (CHAR_BIT - bitDist);
+		BitOps_store64(bytes + byte, word);
+	}
+	for(; byte < numBytes; byte++){
+		Byte_t next = (byte + 1 < numBytes) ? bytes[byte + 1] : first;
+		bytes[byte] = bytes[byte] << bitDist | next >> (CHAR_BIT - bitDist);
+	}
+}
+
+void BitOps_compilePermutation(
+	BitOps_Permutation_t *permutation, const int *table, int numOutputBits
+){
+	memset(permutation->lookup, 0, sizeof(permutation->lookup));
+	permutation->numInputBits = 0;
+	permutation->numOutputBits = numOutputBits;
+	for(int bit = 0; bit < numOutputBits; bit++){
+		int inputBit = table[bit] - 1;
+		if(inputBit >= permutation->numInputBits){
+			permutation->numInputBits = inputBit + 1;
+		}
+
+		// Every value of the input bit's byte with that bit set contributes
+		// this output bit.
+		uint64_t outputMask = (uint64_t)1 << (63 - bit);
+		int byteMask = 0x80 >> (inputBit % CHAR_BIT);
+		for(int value = 0; value < 256; value++){
+			if(value & byteMask){
+				permutation->lookup[inputBit / CHAR_BIT][value] |= outputMask;
+			}
+		}
+	}
+}
+
+void BitOps_permuteBytes(
+	const BitOps_Permutation_t *permutation, const Byte_t *input,
+	Byte_t *output
+){
+	int numInputBytes = (permutation->numInputBits + CHAR_BIT - 1) / CHAR_BIT,
+		numOutputBytes =
+			(permutation->numOutputBits + CHAR_BIT - 1) / CHAR_BIT;
+	uint64_t word = BitOps_permute(
+		permutation, _loadPartial(input, numInputBytes)
+	);
+	_storePartial(output, numOutputBytes, word);
+}
+
+void BitOps_rotLeftBits(Byte_t *bytes, size_t numBits, size_t rotDist){
+	if(numBits == 0 || (rotDist %= numBits) == 0){
+		return;
+	}
+
+	// Up to 64 bits fit in a single funnel shift.
+	if(numBits <= 64){
+		uint64_t word = BitOps_extractBits(bytes, 0, numBits);
+		word = word << rotDist | word >> (numBits - rotDist);
+		BitOps_insertBits(bytes, 0, numBits, word);
+	}
+	else if(numBits % CHAR_BIT == 0){
+		BitOps_rotLeftBytes(bytes, numBits / CHAR_BIT, rotDist);
+	}
+	else {
+		_reverseBits(bytes, 0, rotDist);
+		_reverseBits(bytes, rotDist, numBits);
+		_reverseBits(bytes, 0, numBits);
+	}
+}
+
+static uint64_t _loadLanes(const void *bytes){
+	uint64_t lanes;
+	memcpy(&lanes, bytes, sizeof(lanes));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	lanes = __builtin_bswap64(lanes);
+#endif
+	return lanes;
+}
+
+static void _storeLanes(void *bytes, uint64_t lanes){
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	lanes = __builtin_bswap64(lanes);
+#endif
+	memcpy(bytes, &lanes, sizeof(lanes));
+}
+
+static uint64_t _lanesInRange(uint64_t lanes, Byte_t low, Byte_t high){
+	uint64_t atLeastLow = lanes + LANES(0x80 - low);
+	uint64_t aboveHigh = lanes + LANES(0x7f - high);
+	return atLeastLow & ~aboveHigh & LANES(0x80);
+}
+
+static int _hexValue(char digit){
+	if(digit >= '0' && digit <= '9'){
+		return digit - '0';
+	}
+	int lower = digit | 0x20;
+	return (lower >= 'a' && lower <= 'f') ? lower - 'a' + 10 : -1;
+}
+
+static uint64_t _loadPartial(const Byte_t *bytes, int numBytes){
+	uint64_t word = 0;
+	for(int byte = 0; byte < numBytes; byte++){
+		word |= (uint64_t)bytes[byte] << (56 - CHAR_BIT * byte);
+	}
+	return word;
+}
+
+static void _storePartial(Byte_t *bytes, int numBytes, uint64_t word){
+	for(int byte = 0; byte < numBytes; byte++){
+		bytes[byte] = word >> (56 - CHAR_BIT * byte);
+	}
+}
+
+static void _reverseBytes(Byte_t *bytes, size_t numBytes){
+	for(size_t front = 0, back = numBytes - 1; front < back; front++, back--){
+		Byte_t swap = bytes[front];
+		bytes[front] = bytes[back];
+		bytes[back] = swap;
+	}
+}
+
+static void _reverseBits(Byte_t *bytes, size_t first, size_t last){
+	while(last - first >= 2){
+		int numBits = (last - first) / 2;
+		if(numBits > 64){
+			numBits = 64;
+		}
+
+		// Swap and reverse the `numBits` bits at either end of the range.
+		uint64_t front = BitOps_extractBits(bytes, first, numBits),
+			back = BitOps_extractBits(bytes, last - numBits, numBits);
+		BitOps_insertBits(
+			bytes, first, numBits, _reverseWord(back) >> (64 - numBits)
+		);
+		BitOps_insertBits(
+			bytes, last - numBits, numBits,
+			_reverseWord(front) >> (64 - numBits)
+		);
+		first += numBits;
+		last -= numBits;
+	}
+}
+
+static uint64_t _reverseWord(uint64_t word){
+	word = __builtin_bswap64(word);
+	word = (word >> 4 & 0x0f0f0f0f0f0f0f0f) | (word & 0x0f0f0f0f0f0f0f0f) << 4;
+	word = (word >> 2 & 0x3333333333333333) | (word & 0x3333333333333333) << 2;
+	return (word >> 1 & 0x5555555555555555) | (word & 0x5555555555555555) << 1;
 }
@@ -5,6 +5,10 @@
 #pragma once
 
 #include <limits.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
 
 typedef unsigned char Byte_t;
 
@@ -46,7 +50,7 @@ inline void BitOps_xor(Byte_t *block1, const Byte_t *block2, int numBytes){
 }
 
 /**
- * @brief Left-rotate an array of bytes.
+ * @brief Left-rotate an array of bytes by one bit.
  * @param bytes An array of one or more bytes.
  * @param numBytes The number of bytes inside `numBytes`.
  */
@@ -57,6 +61,198 @@ void BitOps_rotLeft(Byte_t *bytes, int numBytes);
  * @param bytes An array of one or more bytes.
  * @param numBytes The number of bytes in `bytes`.
  * @return A null-terminated string containing a 0/1 for every bit in `bytes`.
- *      Must be deallocated by the caller.
+ *      Must be deallocated by the caller. If memory could not be allocated,
+ *      return `NULL`.
  */
 char *BitOps_getBitString(const Byte_t *bytes, int numBytes);
+
+/**
+ * @brief The inverse of `BitOps_getBitString()`: parse a string of 0s and 1s.
+ * @param bitString A null-terminated string of exactly `8 * numBytes` 0s and
+ *      1s, the first being the most significant bit of the first byte.
+ * @param bytes The buffer to write the `numBytes` bytes to.
+ * @param numBytes The number of bytes to parse.
+ * @return `false` if `bitString` has the wrong length or any other character;
+ *      `true` otherwise.
+ */
+bool BitOps_parseBitString(
+	const char *bitString, Byte_t *bytes, size_t numBytes
+);
+
+/**
+ * @brief Returns a hexadecimal string representation of an array of bytes.
+ * @param bytes An array of one or more bytes.
+ * @param numBytes The number of bytes in `bytes`.
+ * @return A null-terminated string of two lowercase hexadecimal digits for
+ *      every byte in `bytes`. Must be deallocated by the caller. If memory
+ *      could not be allocated, return `NULL`.
+ */
+char *BitOps_getHexString(const Byte_t *bytes, size_t numBytes);
+
+/**
+ * @brief The inverse of `BitOps_getHexString()`: parse a hexadecimal string.
+ * @param hexString A null-terminated string of exactly `2 * numBytes`
+ *      hexadecimal digits, in either case.
+ * @param bytes The buffer to write the `numBytes` bytes to.
+ * @param numBytes The number of bytes to parse.
+ * @return `false` if `hexString` has the wrong length or any other character;
+ *      `true` otherwise.
+ */
+bool BitOps_parseHexString(
+	const char *hexString, Byte_t *bytes, size_t numBytes
+);
+
+/**
+ * @brief Load 8 bytes as a big-endian 64-bit word, so that bit 0 of `bytes`
+ *      (in the sense of `BitOps_getBit()`) is its most significant bit.
+ * @param bytes An array of at least 8 bytes, with any alignment.
+ * @return The 64-bit word.
+ */
+inline uint64_t BitOps_load64(const Byte_t *bytes){
+	uint64_t word;
+	memcpy(&word, bytes, sizeof(word));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	word = __builtin_bswap64(word);
+#endif
+	return word;
+}
+
+/**
+ * @brief The inverse of `BitOps_load64()`: store a 64-bit word as 8 bytes,
+ *      most significant byte first.
+ * @param bytes An array of at least 8 bytes, with any alignment.
+ * @param word The 64-bit word.
+ */
+inline void BitOps_store64(Byte_t *bytes, uint64_t word){
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	word = __builtin_bswap64(word);
+#endif
+	memcpy(bytes, &word, sizeof(word));
+}
+
+/**
+ * @brief Retrieve a range of up to 64 bits of an array of bytes at once.
+ * @param bytes An array of one or more bytes. Only the bytes the range
+ *      overlaps are read.
+ * @param bitPos The position of the first bit of the range, counting from
+ *      left-to-right as in `BitOps_getBit()`.
+ * @param numBits The length of the range, from 0 to 64.
+ * @return The bits of the range, right-aligned: the last bit of the range is
+ *      the least significant bit.
+ */
+uint64_t BitOps_extractBits(const Byte_t *bytes, size_t bitPos, int numBits);
+
+/**
+ * @brief Overwrite a range of up to 64 bits of an array of bytes at once,
+ *      leaving the bits around it unchanged.
+ * @param bytes An array of one or more bytes. Only the bytes the range
+ *      overlaps are accessed.
+ * @param bitPos The position of the first bit of the range, counting from
+ *      left-to-right as in `BitOps_getBit()`.
+ * @param numBits The length of the range, from 0 to 64.
+ * @param value The bits to write, right-aligned as returned by
+ *      `BitOps_extractBits()`. Any bits above the lowest `numBits` are
+ *      ignored.
+ */
+void BitOps_insertBits(
+	Byte_t *bytes, size_t bitPos, int numBits, uint64_t value
+);
+
+/**
+ * @brief XOR one buffer into another, many bytes at a time. Unlike
+ *      `BitOps_xor()`, this is meant for large buffers.
+ * @param target The first operand; will be modified in place.
+ * @param source The second operand; will be XOR'ed into `target`.
+ * @param numBytes The length of both buffers, in bytes.
+ */
+void BitOps_xorBytes(Byte_t *target, const Byte_t *source, size_t numBytes);
+
+/**
+ * @brief AND one buffer into another, many bytes at a time. Parameters are as
+ *      for `BitOps_xorBytes()`.
+ */
+void BitOps_andBytes(Byte_t *target, const Byte_t *source, size_t numBytes);
+
+/**
+ * @brief OR one buffer into another, many bytes at a time. Parameters are as
+ *      for `BitOps_xorBytes()`.
+ */
+void BitOps_orBytes(Byte_t *target, const Byte_t *source, size_t numBytes);
+
+/**
+ * @brief Left-rotate an array of bytes by any number of bits, in place.
+ * @param bytes An array of one or more bytes.
+ * @param numBytes The number of bytes in `bytes`.
+ * @param rotDist The number of bits to rotate `bytes` by. May be larger than
+ *      the number of bits in `bytes`.
+ */
+void BitOps_rotLeftBytes(Byte_t *bytes, size_t numBytes, size_t rotDist);
+
+/**
+ * @brief A bit permutation (or any table-driven selection of bits, which may
+ *      repeat or drop input bits) of up to 64 input bits onto up to 64 output
+ *      bits, compiled into byte-indexed lookup tables: each byte of the input
+ *      is looked up in its own table, which holds the output bits that byte
+ *      contributes, and the lookups are OR'd together. Applying one takes a
+ *      lookup per input byte instead of a test and set per output bit.
+ */
+typedef struct {
+	uint64_t lookup[8][256];
+	int numInputBits;
+	int numOutputBits;
+} BitOps_Permutation_t;
+
+/**
+ * @brief Compile a permutation table.
+ * @param permutation The compiled permutation to populate.
+ * @param table For each output bit, the position of the input bit it's copied
+ *      from, counting from 1 (as permutation tables are usually written, e.g.
+ *      in the DES standard).
+ * @param numOutputBits The number of entries in `table`, from 1 to 64.
+ */
+void BitOps_compilePermutation(
+	BitOps_Permutation_t *permutation, const int *table, int numOutputBits
+);
+
+/**
+ * @brief Apply a compiled permutation to a word.
+ * @param permutation A permutation compiled with `BitOps_compilePermutation()`.
+ * @param input The input bits, left-aligned (as loaded by `BitOps_load64()`):
+ *      input bit 1 is the most significant bit.
+ * @return The output bits, also left-aligned.
+ */
+inline uint64_t BitOps_permute(
+	const BitOps_Permutation_t *permutation, uint64_t input
+){
+	uint64_t output = 0;
+	int numInputBytes = (permutation->numInputBits + CHAR_BIT - 1) / CHAR_BIT;
+	for(int byte = 0; byte < numInputBytes; byte++){
+		output |= permutation->lookup[byte][(input >> (56 - 8 * byte)) & 0xff];
+	}
+	return output;
+}
+
+/**
+ * @brief Apply a compiled permutation to an array of bytes.
+ * @param permutation A permutation compiled with `BitOps_compilePermutation()`.
+ * @param input The input bits. Only the bytes holding the highest input bit
+ *      the permutation reads and the ones before it are read.
+ * @param output The buffer to write the output bits to, whose bytes are
+ *      overwritten up to the one holding the last output bit (which is padded
+ *      with zeroes).
+ */
+void BitOps_permuteBytes(
+	const BitOps_Permutation_t *permutation, const Byte_t *input,
+	Byte_t *output
+);
+
+/**
+ * @brief Left-rotate the first bits of an array of bytes, of any length, by
+ *      any number of bits, in place.
+ * @param bytes An array of one or more bytes.
+ * @param numBits The number of bits to rotate, counting from left-to-right as
+ *      in `BitOps_getBit()`. Any bits after them are left unchanged.
+ * @param rotDist The number of bits to rotate by. May be larger than
+ *      `numBits`.
+ */
+void BitOps_rotLeftBits(Byte_t *bytes, size_t numBits, size_t rotDist);
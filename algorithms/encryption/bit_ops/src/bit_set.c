@@ -0,0 +1,249 @@
+#include <stdlib.h>
+
+#include "bit_set.h"
+
+extern inline bool BitSet_get(const BitSet_t *set, size_t bit);
+extern inline void BitSet_set(BitSet_t *set, size_t bit);
+extern inline void BitSet_clear(BitSet_t *set, size_t bit);
+
+/**
+ * The number of words in a superblock of the directory. Small enough that a
+ * superblock's word ranks fit in 16 bits, and that `BitSet_select()` can scan
+ * them.
+ */
+#define SUPERBLOCK_WORDS 8
+
+/**
+ * Set (`value` is `true`) or clear the bits from `first` (inclusive) to
+ * `last` (exclusive).
+ */
+static void _fillRange(BitSet_t *set, size_t first, size_t last, bool value);
+
+/**
+ * Apply `mask` to a word: set its bits if `value` is `true`, clear them
+ * otherwise.
+ */
+static void _fillWord(uint64_t *word, uint64_t mask, bool value);
+
+/**
+ * Return the position (from the most significant bit) of the set bit of
+ * `word` with `rank` set bits before it, which must exist, by halving the
+ * range it's in.
+ */
+static int _selectInWord(uint64_t word, int rank);
+
+bool BitSet_init(BitSet_t *set, size_t numBits){
+	*set = (BitSet_t){.numBits = numBits, .numWords = (numBits + 63) / 64};
+	set->words = calloc(set->numWords, sizeof(uint64_t));
+	// An empty set may get `NULL` words, which are never read.
+	return set->words != NULL || set->numWords == 0;
+}
+
+bool BitSet_fromBytes(BitSet_t *set, const Byte_t *bytes, size_t numBits){
+	if(!BitSet_init(set, numBits)){
+		return false;
+	}
+
+	for(size_t word = 0; word < set->numWords; word++){
+		size_t bitPos = word * 64;
+		if(bitPos + 64 <= numBits){
+			set->words[word] = BitOps_load64(bytes + word * 8);
+		}
+		else {
+			int numTailBits = numBits - bitPos;
+			set->words[word] = BitOps_extractBits(bytes, bitPos, numTailBits) <<
+				(64 - numTailBits);
+		}
+	}
+	return true;
+}
+
+void BitSet_free(BitSet_t *set){
+	free(set->words);
+	free(set->superblockRanks);
+	free(set->wordRanks);
+	free(set->selectSamples);
+	*set = (BitSet_t){0};
+}
+
+void BitSet_setRange(BitSet_t *set, size_t first, size_t last){
+	_fillRange(set, first, last, true);
+}
+
+void BitSet_clearRange(BitSet_t *set, size_t first, size_t last){
+	_fillRange(set, first, last, false);
+}
+
+bool BitSet_buildIndex(BitSet_t *set){
+	size_t numSuperblocks =
+		(set->numWords + SUPERBLOCK_WORDS - 1) / SUPERBLOCK_WORDS;
+	free(set->superblockRanks);
+	free(set->wordRanks);
+	free(set->selectSamples);
+	set->superblockRanks = malloc((numSuperblocks + 1) * sizeof(uint64_t));
+	set->wordRanks = malloc((set->numWords + 1) * sizeof(uint16_t));
+	set->selectSamples = NULL;
+	set->isIndexed = false;
+	if(set->superblockRanks == NULL || set->wordRanks == NULL){
+		return false;
+	}
+
+	uint64_t rank = 0;
+	for(size_t word = 0; word < set->numWords; word++){
+		if(word % SUPERBLOCK_WORDS == 0){
+			set->superblockRanks[word / SUPERBLOCK_WORDS] = rank;
+		}
+		set->wordRanks[word] =
+			rank - set->superblockRanks[word / SUPERBLOCK_WORDS];
+		rank += __builtin_popcountll(set->words[word]);
+	}
+	set->superblockRanks[numSuperblocks] = rank;
+
+	// Sample the superblock holding every `BITSET_SELECT_SAMPLE`th set bit,
+	// so that `BitSet_select()` only searches between two samples.
+	set->numSamples = (rank + BITSET_SELECT_SAMPLE - 1) / BITSET_SELECT_SAMPLE;
+	set->selectSamples = malloc((set->numSamples + 1) * sizeof(size_t));
+	if(set->selectSamples == NULL){
+		return false;
+	}
+	size_t sample = 0;
+	for(size_t superblock = 0; superblock < numSuperblocks; superblock++){
+		while(
+			sample < set->numSamples &&
+			sample * BITSET_SELECT_SAMPLE <
+				set->superblockRanks[superblock + 1]
+		){
+			set->selectSamples[sample++] = superblock;
+		}
+	}
+
+	set->isIndexed = true;
+	return true;
+}
+
+size_t BitSet_count(const BitSet_t *set){
+	if(!set->isIndexed){
+		return BITSET_NO_INDEX;
+	}
+
+	size_t numSuperblocks =
+		(set->numWords + SUPERBLOCK_WORDS - 1) / SUPERBLOCK_WORDS;
+	return set->superblockRanks[numSuperblocks];
+}
+
+size_t BitSet_rank(const BitSet_t *set, size_t bit){
+	if(!set->isIndexed){
+		return BITSET_NO_INDEX;
+	}
+	if(bit >= set->numBits){
+		return BitSet_count(set);
+	}
+
+	size_t word = bit / 64;
+	int numBitsBefore = bit % 64;
+	size_t rank = set->superblockRanks[word / SUPERBLOCK_WORDS] +
+		set->wordRanks[word];
+	if(numBitsBefore > 0){
+		rank += __builtin_popcountll(set->words[word] >> (64 - numBitsBefore));
+	}
+	return rank;
+}
+
+size_t BitSet_select(const BitSet_t *set, size_t rank){
+	if(!set->isIndexed){
+		return BITSET_NO_INDEX;
+	}
+	if(rank >= BitSet_count(set)){
+		return set->numBits;
+	}
+
+	// Binary search for the last superblock starting at or before `rank`,
+	// between the samples either side of it.
+	size_t sample = rank / BITSET_SELECT_SAMPLE;
+	size_t low = set->selectSamples[sample];
+	size_t high = (sample + 1 < set->numSamples) ?
+		set->selectSamples[sample + 1] :
+		(set->numWords - 1) / SUPERBLOCK_WORDS;
+	while(low < high){
+		size_t middle = low + (high - low + 1) / 2;
+		if(set->superblockRanks[middle] <= rank){
+			low = middle;
+		}
+		else {
+			high = middle - 1;
+		}
+	}
+
+	// Then scan its words for the last one starting at or before `rank`.
+	size_t word = low * SUPERBLOCK_WORDS;
+	size_t endWord = word + SUPERBLOCK_WORDS;
+	if(endWord > set->numWords){
+		endWord = set->numWords;
+	}
+	rank -= set->superblockRanks[low];
+	while(word + 1 < endWord && set->wordRanks[word + 1] <= rank){
+		word++;
+	}
+	rank -= set->wordRanks[word];
+	return word * 64 + _selectInWord(set->words[word], rank);
+}
+
+size_t BitSet_next(const BitSet_t *set, size_t bit){
+	if(bit >= set->numBits){
+		return set->numBits;
+	}
+
+	size_t word = bit / 64;
+	uint64_t bits = set->words[word] & (~(uint64_t)0 >> (bit % 64));
+	while(bits == 0){
+		if(++word == set->numWords){
+			return set->numBits;
+		}
+		bits = set->words[word];
+	}
+	return word * 64 + __builtin_clzll(bits);
+}
+
+static void _fillRange(BitSet_t *set, size_t first, size_t last, bool value){
+	set->isIndexed = false;
+	if(first >= last){
+		return;
+	}
+
+	size_t firstWord = first / 64, lastWord = (last - 1) / 64;
+	uint64_t firstMask = ~(uint64_t)0 >> (first % 64);
+	uint64_t lastMask = ~(uint64_t)0 << (63 - (last - 1) % 64);
+	if(firstWord == lastWord){
+		_fillWord(&set->words[firstWord], firstMask & lastMask, value);
+		return;
+	}
+
+	_fillWord(&set->words[firstWord], firstMask, value);
+	memset(
+		&set->words[firstWord + 1], value ? 0xff : 0,
+		(lastWord - firstWord - 1) * sizeof(uint64_t)
+	);
+	_fillWord(&set->words[lastWord], lastMask, value);
+}
+
+static void _fillWord(uint64_t *word, uint64_t mask, bool value){
+	if(value){
+		*word |= mask;
+	}
+	else {
+		*word &= ~mask;
+	}
+}
+
+static int _selectInWord(uint64_t word, int rank){
+	int pos = 0;
+	for(int width = 32; width > 0; width /= 2){
+		int count = __builtin_popcountll(word >> (64 - width));
+		if(rank >= count){
+			rank -= count;
+			word <<= width;
+			pos += width;
+		}
+	}
+	return pos;
+}
@@ -0,0 +1,166 @@
+/**
+ * @brief A bit set with rank and select queries, for using bit vectors as
+ *      compact indexes.
+ *
+ * Bits are numbered as in `bit_ops.h`, from the most significant bit of the
+ * first word, and stored 64 to a word. `BitSet_buildIndex()` adds a two-level
+ * directory of popcounts, so that `BitSet_rank()` takes two lookups and a
+ * popcount, and `BitSet_select()` a short search of the directory; it takes
+ * about 5% on top of the bits, and must be rebuilt after they're modified:
+ * until then, those queries return `BITSET_NO_INDEX`.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "bit_ops.h"
+
+/**
+ * @brief A fixed-size set of bits. Treat the fields as read-only.
+ */
+typedef struct {
+	uint64_t *words;
+	size_t numBits;
+	size_t numWords;
+
+	// The directory, built by `BitSet_buildIndex()`: the number of set bits
+	// before each superblock of 8 words (plus one past the end, holding the
+	// total), before each word within its superblock, and the superblock
+	// holding every `BITSET_SELECT_SAMPLE`th set bit.
+	uint64_t *superblockRanks;
+	uint16_t *wordRanks;
+	size_t *selectSamples;
+	size_t numSamples;
+	bool isIndexed; // Whether the directory is built and up to date.
+} BitSet_t;
+
+/**
+ * @brief The number of set bits between the entries of `selectSamples`.
+ */
+#define BITSET_SELECT_SAMPLE 4096
+
+/**
+ * @brief Returned by `BitSet_count()`, `BitSet_rank()` and `BitSet_select()`
+ *      for a set whose directory hasn't been built since it was last
+ *      modified (or failed to build).
+ */
+#define BITSET_NO_INDEX SIZE_MAX
+
+/**
+ * @brief Initialize a bit set with every bit cleared.
+ * @param set The bit set to initialize.
+ * @param numBits The number of bits in the set.
+ * @return `false` if memory could not be allocated; `true` otherwise.
+ */
+bool BitSet_init(BitSet_t *set, size_t numBits);
+
+/**
+ * @brief Initialize a bit set from a byte array, as used by `bit_ops.h`.
+ * @param set The bit set to initialize.
+ * @param bytes The bits of the set, `(numBits + 7) / 8` bytes of them.
+ * @param numBits The number of bits in the set.
+ * @return `false` if memory could not be allocated; `true` otherwise.
+ */
+bool BitSet_fromBytes(BitSet_t *set, const Byte_t *bytes, size_t numBits);
+
+/**
+ * @brief Deallocate a bit set and its directory.
+ * @param set The bit set.
+ */
+void BitSet_free(BitSet_t *set);
+
+/**
+ * @brief Retrieve the value of a bit.
+ * @param set The bit set.
+ * @param bit The index of the bit, below `set->numBits`.
+ * @return Whether the bit is set.
+ */
+inline bool BitSet_get(const BitSet_t *set, size_t bit){
+	return (set->words[bit / 64] >> (63 - bit % 64)) & 1;
+}
+
+/**
+ * @brief Set a bit, invalidating the directory.
+ * @param set The bit set.
+ * @param bit The index of the bit, below `set->numBits`.
+ */
+inline void BitSet_set(BitSet_t *set, size_t bit){
+	set->words[bit / 64] |= (uint64_t)1 << (63 - bit % 64);
+	set->isIndexed = false;
+}
+
+/**
+ * @brief Clear a bit, invalidating the directory.
+ * @param set The bit set.
+ * @param bit The index of the bit, below `set->numBits`.
+ */
+inline void BitSet_clear(BitSet_t *set, size_t bit){
+	set->words[bit / 64] &= ~((uint64_t)1 << (63 - bit % 64));
+	set->isIndexed = false;
+}
+
+/**
+ * @brief Set a range of bits, a word at a time, invalidating the directory.
+ * @param set The bit set.
+ * @param first The index of the first bit to set.
+ * @param last The index one past the last bit to set, at most
+ *      `set->numBits`.
+ */
+void BitSet_setRange(BitSet_t *set, size_t first, size_t last);
+
+/**
+ * @brief Clear a range of bits, a word at a time, invalidating the directory.
+ * @param set The bit set.
+ * @param first The index of the first bit to clear.
+ * @param last The index one past the last bit to clear, at most
+ *      `set->numBits`.
+ */
+void BitSet_clearRange(BitSet_t *set, size_t first, size_t last);
+
+/**
+ * @brief Build the directory that `BitSet_rank()` and `BitSet_select()` use.
+ * @param set The bit set.
+ * @return `false` if memory could not be allocated; `true` otherwise.
+ */
+bool BitSet_buildIndex(BitSet_t *set);
+
+/**
+ * @brief Count the set bits.
+ * @param set An indexed bit set.
+ * @return The number of set bits, or `BITSET_NO_INDEX` if the set isn't
+ *      indexed.
+ */
+size_t BitSet_count(const BitSet_t *set);
+
+/**
+ * @brief Count the set bits before a position.
+ * @param set An indexed bit set.
+ * @param bit The position, at most `set->numBits`.
+ * @return The number of set bits with an index below `bit`, or
+ *      `BITSET_NO_INDEX` if the set isn't indexed.
+ */
+size_t BitSet_rank(const BitSet_t *set, size_t bit);
+
+/**
+ * @brief Find a set bit by its rank: the inverse of `BitSet_rank()`.
+ * @param set An indexed bit set.
+ * @param rank The number of set bits before the one to find.
+ * @return The index of the set bit with `rank` set bits before it, or
+ *      `set->numBits` if there are no more than `rank` set bits, or
+ *      `BITSET_NO_INDEX` if the set isn't indexed.
+ */
+size_t BitSet_select(const BitSet_t *set, size_t rank);
+
+/**
+ * @brief Find the next set bit, a word at a time. To iterate over the set
+ *      bits, start from `BitSet_next(set, 0)` and continue from
+ *      `BitSet_next(set, bit + 1)`.
+ * @param set The bit set.
+ * @param bit The position to start looking from.
+ * @return The index of the first set bit at or after `bit`, or
+ *      `set->numBits` if there's none.
+ */
+size_t BitSet_next(const BitSet_t *set, size_t bit);
@@ -2,11 +2,15 @@
  * @brief Unit-tests for the `bit_ops` module.
  */
 
+#include <ctype.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <tap.h>
 
 #include "bit_ops.h"
+#include "bit_set.h"
 
 /**
  * @brief Define a unit-test for a function. Saves on boilerplate code.
@@ -95,12 +99,382 @@ DEF_UNIT_TEST(
 	free(actual);
 )
 
+/**
+ * Test `BitOps_parseBitString()` by round trips through
+ * `BitOps_getBitString()` of every byte value, and on malformed strings.
+ */
+DEF_UNIT_TEST(
+	BitOps_parseBitString,
+	Byte_t bytes[256], parsed[256];
+	for(int byte = 0; byte < 256; byte++){
+		bytes[byte] = byte;
+	}
+
+	char *bitString = BitOps_getBitString(bytes, 256);
+	bool matchesExpected = true;
+	for(int bit = 0; bit < 256 * 8; bit++){
+		matchesExpected &= bitString[bit] == '0' + BitOps_getBit(bytes, bit);
+	}
+	ok(matchesExpected, "Formats every byte value.");
+
+	bool isParsed = BitOps_parseBitString(bitString, parsed, 256);
+	ok(isParsed && memcmp(parsed, bytes, 256) == 0, "Parses them back.");
+	free(bitString);
+
+	const char *malformed[] = {"0101010", "010101010", "01010102", "0101 010"};
+	bool rejectsMalformed = true;
+	for(int string = 0; string < 4; string++){
+		rejectsMalformed &=
+			!BitOps_parseBitString(malformed[string], parsed, 1);
+	}
+	ok(rejectsMalformed, "Rejects malformed bit strings.");
+)
+
+/**
+ * Test `BitOps_getHexString()` and `BitOps_parseHexString()` against
+ * `snprintf()` and `isxdigit()`, over lengths with and without a tail.
+ */
+DEF_UNIT_TEST(
+	BitOps_getHexString,
+	Byte_t bytes[256], parsed[256];
+	for(int byte = 0; byte < 256; byte++){
+		bytes[byte] = byte * 167 + 5;
+	}
+
+	char expected[513];
+	for(int byte = 0; byte < 256; byte++){
+		snprintf(expected + byte * 2, 3, "%02x", bytes[byte]);
+	}
+
+	bool formatsAll = true, parsesAll = true;
+	for(int numBytes = 0; numBytes <= 256; numBytes += 1 + numBytes / 8){
+		char *hexString = BitOps_getHexString(bytes, numBytes);
+		formatsAll &= strlen(hexString) == (size_t)numBytes * 2 &&
+			strncmp(hexString, expected, numBytes * 2) == 0;
+		parsesAll &= BitOps_parseHexString(hexString, parsed, numBytes) &&
+			memcmp(parsed, bytes, numBytes) == 0;
+		free(hexString);
+	}
+	ok(formatsAll, "Formats hex strings.");
+	ok(parsesAll, "Parses them back.");
+
+	bool isParsed = BitOps_parseHexString("0AbCdEf9", parsed, 4);
+	ok(
+		isParsed && memcmp(parsed, "\x0a\xbc\xde\xf9", 4) == 0,
+		"Parses either case."
+	);
+
+	// Every character in every position of a full word and of the tail.
+	char hexString[] = "0123456789";
+	bool checksDigits = true;
+	for(int pos = 0; pos < 10; pos++){
+		for(int character = 1; character < 256; character++){
+			hexString[pos] = character;
+			checksDigits &= BitOps_parseHexString(hexString, parsed, 5) ==
+				(isxdigit(character) != 0);
+		}
+		hexString[pos] = '0';
+	}
+	ok(checksDigits, "Accepts exactly the hexadecimal digits.");
+	ok(!BitOps_parseHexString("012", parsed, 1), "Rejects wrong lengths.");
+)
+
+/**
+ * Test `BitOps_load64()` and `BitOps_store64()`.
+ */
+DEF_UNIT_TEST(
+	BitOps_load64,
+	const Byte_t bytes[] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef, 0};
+	ok(
+		BitOps_load64(bytes + 1) == 0x23456789abcdef00,
+		"Loads big-endian words."
+	);
+
+	Byte_t stored[8];
+	BitOps_store64(stored, 0x0123456789abcdef);
+	ok(memcmp(stored, bytes, 8) == 0, "Stores big-endian words.");
+)
+
+/**
+ * Test `BitOps_extractBits()` and `BitOps_insertBits()` against
+ * `BitOps_getBit()`, over every range of a 12-byte array.
+ */
+DEF_UNIT_TEST(
+	BitOps_extractBits,
+	const Byte_t bytes[] = {
+		0x9a, 0x3c, 0x51, 0xe7, 0x08, 0xbd, 0x62, 0xf4, 0x1e, 0xc3, 0x75, 0xa9
+	};
+	bool extractsRanges = true, insertsRanges = true;
+	for(int bitPos = 0; bitPos < 96; bitPos++){
+		int maxBits = (96 - bitPos < 64) ? 96 - bitPos : 64;
+		for(int numBits = 0; numBits <= maxBits; numBits++){
+			uint64_t expected = 0;
+			for(int bit = bitPos; bit < bitPos + numBits; bit++){
+				expected = expected << 1 | BitOps_getBit(bytes, bit);
+			}
+			extractsRanges &=
+				BitOps_extractBits(bytes, bitPos, numBits) == expected;
+
+			// Flip the range in a copy, which should leave everything else be.
+			Byte_t copy[12];
+			memcpy(copy, bytes, 12);
+			BitOps_insertBits(copy, bitPos, numBits, ~expected);
+			for(int bit = 0; bit < 96; bit++){
+				bool inRange = bit >= bitPos && bit < bitPos + numBits;
+				insertsRanges &= BitOps_getBit(copy, bit) ==
+					(BitOps_getBit(bytes, bit) ^ inRange);
+			}
+		}
+	}
+	ok(extractsRanges, "Extracted ranges match expected.");
+	ok(insertsRanges, "Inserted ranges match expected.");
+)
+
+/**
+ * Test `BitOps_xorBytes()`, `BitOps_andBytes()` and `BitOps_orBytes()` on a
+ * buffer longer than a vector but not a multiple of one.
+ */
+DEF_UNIT_TEST(
+	BitOps_xorBytes,
+	Byte_t target[3][77], source[77];
+	for(int byte = 0; byte < 77; byte++){
+		source[byte] = byte * 37 + 11;
+		for(int op = 0; op < 3; op++){
+			target[op][byte] = byte * 91 + 5;
+		}
+	}
+	BitOps_xorBytes(target[0], source, 77);
+	BitOps_andBytes(target[1], source, 77);
+	BitOps_orBytes(target[2], source, 77);
+
+	bool matchesExpected[3] = {true, true, true};
+	for(int byte = 0; byte < 77; byte++){
+		Byte_t original = byte * 91 + 5;
+		matchesExpected[0] &= target[0][byte] == (original ^ source[byte]);
+		matchesExpected[1] &= target[1][byte] == (original & source[byte]);
+		matchesExpected[2] &= target[2][byte] == (original | source[byte]);
+	}
+	ok(matchesExpected[0], "XOR matches expected.");
+	ok(matchesExpected[1], "AND matches expected.");
+	ok(matchesExpected[2], "OR matches expected.");
+)
+
+/**
+ * Test `BitOps_rotLeftBytes()` against `BitOps_getBit()`.
+ */
+DEF_UNIT_TEST(
+	BitOps_rotLeftBytes,
+	Byte_t original[19], rotated[19];
+	for(int byte = 0; byte < 19; byte++){
+		original[byte] = byte * 73 + 29;
+	}
+
+	bool matchesExpected = true;
+	for(int rotDist = 0; rotDist <= 2 * 19 * 8; rotDist++){
+		memcpy(rotated, original, 19);
+		BitOps_rotLeftBytes(rotated, 19, rotDist);
+		for(int bit = 0; bit < 19 * 8; bit++){
+			matchesExpected &= BitOps_getBit(rotated, bit) ==
+				BitOps_getBit(original, (bit + rotDist) % (19 * 8));
+		}
+	}
+	ok(matchesExpected, "Rotations by 0 to 304 bits match expected.");
+)
+
+/**
+ * Test `BitOps_compilePermutation()`, `BitOps_permute()` and
+ * `BitOps_permuteBytes()` against `BitOps_getBit()`/`BitOps_setBit()`, with
+ * an expansion that repeats and skips input bits.
+ */
+DEF_UNIT_TEST(
+	BitOps_permute,
+	const Byte_t input[] = {0x5d, 0xa2, 0x0f, 0xc6, 0x93, 0x71};
+	int table[52];
+	for(int bit = 0; bit < 52; bit++){
+		table[bit] = (bit * 29) % 44 + 1;
+	}
+
+	Byte_t expected[7] = {0}, actual[7];
+	for(int bit = 0; bit < 52; bit++){
+		if(BitOps_getBit(input, table[bit] - 1)){
+			BitOps_setBit(expected, bit);
+		}
+	}
+
+	BitOps_Permutation_t permutation;
+	BitOps_compilePermutation(&permutation, table, 52);
+	BitOps_permuteBytes(&permutation, input, actual);
+	ok(memcmp(actual, expected, 7) == 0, "Permuted bytes match expected.");
+
+	Byte_t inputWord[8] = {0};
+	memcpy(inputWord, input, 6);
+	ok(
+		BitOps_permute(&permutation, BitOps_load64(inputWord)) >> 12 ==
+			BitOps_extractBits(expected, 0, 52),
+		"Permuted word matches expected."
+	);
+)
+
+/**
+ * Test `BitOps_rotLeftBits()` against `BitOps_getBit()`, over lengths that do
+ * and don't fit in a word or end on a byte boundary.
+ */
+DEF_UNIT_TEST(
+	BitOps_rotLeftBits,
+	const int lengths[] = {1, 7, 28, 64, 65, 100, 128, 203};
+	Byte_t original[26], rotated[26];
+	for(int byte = 0; byte < 26; byte++){
+		original[byte] = byte * 151 + 43;
+	}
+
+	for(int length = 0; length < 8; length++){
+		int numBits = lengths[length];
+		bool matchesExpected = true;
+		for(int rotDist = 0; rotDist <= numBits + 1; rotDist++){
+			memcpy(rotated, original, 26);
+			BitOps_rotLeftBits(rotated, numBits, rotDist);
+			for(int bit = 0; bit < 26 * 8; bit++){
+				int sourceBit = (bit < numBits) ?
+					(bit + rotDist) % numBits : bit;
+				matchesExpected &= BitOps_getBit(rotated, bit) ==
+					BitOps_getBit(original, sourceBit);
+			}
+		}
+		ok(matchesExpected, "Rotations of %d bits match expected.", numBits);
+	}
+)
+
+/**
+ * Test `BitSet_fromBytes()`, `BitSet_setRange()` and `BitSet_clearRange()`
+ * against `BitOps_getBit()` and single-bit updates.
+ */
+DEF_UNIT_TEST(
+	BitSet_setRange,
+	Byte_t bytes[40];
+	for(int byte = 0; byte < 40; byte++){
+		bytes[byte] = byte * 73 + 19;
+	}
+
+	BitSet_t set, expected;
+	BitSet_fromBytes(&set, bytes, 300);
+	bool matchesBytes = true;
+	for(int bit = 0; bit < 300; bit++){
+		matchesBytes &= BitSet_get(&set, bit) == BitOps_getBit(bytes, bit);
+	}
+	ok(matchesBytes && set.words[4] << 44 == 0, "Loads bits from bytes.");
+
+	BitSet_fromBytes(&expected, bytes, 300);
+	bool matchesExpected = true;
+	for(int first = 0; first <= 300; first += 7){
+		for(int last = first; last <= 300; last += 11){
+			bool value = (first + last) % 2;
+			if(value){
+				BitSet_setRange(&set, first, last);
+			}
+			else {
+				BitSet_clearRange(&set, first, last);
+			}
+
+			for(int bit = first; bit < last; bit++){
+				if(value){
+					BitSet_set(&expected, bit);
+				}
+				else {
+					BitSet_clear(&expected, bit);
+				}
+			}
+			matchesExpected &=
+				memcmp(set.words, expected.words, 5 * sizeof(uint64_t)) == 0;
+		}
+	}
+	ok(matchesExpected, "Set and cleared ranges match expected.");
+	BitSet_free(&set);
+	BitSet_free(&expected);
+)
+
+/**
+ * Test `BitSet_rank()`, `BitSet_select()` and `BitSet_next()` against a
+ * linear scan, over sets of several densities.
+ */
+DEF_UNIT_TEST(
+	BitSet_rank,
+	const int densities[] = {0, 1, 50, 99, 100};
+	size_t numBits = 100003;
+	uint64_t random = 1;
+	for(int density = 0; density < 5; density++){
+		BitSet_t set;
+		BitSet_init(&set, numBits);
+		for(size_t bit = 0; bit < numBits; bit++){
+			random = random * 6364136223846793005 + 1442695040888963407;
+			if((int)(random >> 33) % 100 < densities[density]){
+				BitSet_set(&set, bit);
+			}
+		}
+		bool isIndexed = BitSet_buildIndex(&set);
+
+		bool ranksMatch = true, selectsMatch = true, nextsMatch = true;
+		size_t rank = 0, next = numBits;
+		for(size_t bit = numBits + 1; bit-- > 0;){
+			if(bit < numBits && BitSet_get(&set, bit)){
+				next = bit;
+			}
+			nextsMatch &= BitSet_next(&set, bit) == next;
+		}
+		for(size_t bit = 0; bit <= numBits; bit++){
+			ranksMatch &= BitSet_rank(&set, bit) == rank;
+			if(bit < numBits && BitSet_get(&set, bit)){
+				selectsMatch &= BitSet_select(&set, rank) == bit;
+				rank++;
+			}
+		}
+		selectsMatch &= BitSet_count(&set) == rank &&
+			BitSet_select(&set, rank) == numBits;
+
+		ok(
+			isIndexed && ranksMatch && selectsMatch && nextsMatch,
+			"Rank, select and next match expected at %d%% density.",
+			densities[density]
+		);
+		BitSet_free(&set);
+	}
+
+	BitSet_t set;
+	bool isEmpty = BitSet_init(&set, 0) && BitSet_buildIndex(&set) &&
+		BitSet_count(&set) == 0 && BitSet_select(&set, 0) == 0;
+	BitSet_free(&set);
+	ok(isEmpty, "An empty set can be indexed.");
+
+	BitSet_init(&set, 1000);
+	bool isUnindexed = BitSet_count(&set) == BITSET_NO_INDEX;
+	BitSet_buildIndex(&set);
+	BitSet_set(&set, 10);
+	isUnindexed &= BitSet_rank(&set, 500) == BITSET_NO_INDEX;
+	BitSet_buildIndex(&set);
+	BitSet_clearRange(&set, 0, 100);
+	isUnindexed &= BitSet_select(&set, 0) == BITSET_NO_INDEX;
+	ok(
+		isUnindexed && BitSet_buildIndex(&set) && BitSet_count(&set) == 0,
+		"Queries refuse a set modified since it was indexed."
+	);
+	BitSet_free(&set);
+)
+
 int main(){
 	note("Begin unit tests.");
 	EXEC_UNIT_TEST(BitOps_getBit);
 	EXEC_UNIT_TEST(BitOps_setBit);
 	EXEC_UNIT_TEST(BitOps_getBitString);
+	EXEC_UNIT_TEST(BitOps_parseBitString);
+	EXEC_UNIT_TEST(BitOps_getHexString);
 	EXEC_UNIT_TEST(BitOps_rotLeft);
+	EXEC_UNIT_TEST(BitOps_load64);
+	EXEC_UNIT_TEST(BitOps_extractBits);
+	EXEC_UNIT_TEST(BitOps_xorBytes);
+	EXEC_UNIT_TEST(BitOps_rotLeftBytes);
+	EXEC_UNIT_TEST(BitOps_permute);
+	EXEC_UNIT_TEST(BitOps_rotLeftBits);
+	EXEC_UNIT_TEST(BitSet_setRange);
+	EXEC_UNIT_TEST(BitSet_rank);
 	done_testing();
 	return EXIT_SUCCESS;
 }
@@ -1,25 +1,71 @@
+#include <pthread.h>
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 
 #include "des.h"
 #include "des_tables.h"
 
-static const int g_DECIPHER = 0, g_ENCIPHER = 1;
+/**
+ * `permutedChoice1` and `permutedChoice2`, compiled into lookup tables by
+ * `_compilePermutations()` before the first key schedule is generated.
+ */
+static BitOps_Permutation_t compiledChoice1, compiledChoice2;
+static pthread_once_t permutationsCompiled = PTHREAD_ONCE_INIT;
 
 /**
- * The DES algorithm, generalized for both encryption/decryption.
- * @param buffer An 8-byte buffer.
- * @param key An 8-byte encryption key.
- * @param direction Either of g_DECIPHER (to decipher `buffer`), or
- *      `g_ENCIPHER`, to encipher buffer.
- * @return A pointer to an either enciphered or deciphered version of `buffer`;
- *      `NULL` if memory could not be allocated.
+ * The DES algorithm, generalized for both encryption/decryption, and for
+ * chaining several DES operations as in Triple-DES.
+ * @param input An 8-byte buffer.
+ * @param output The 8-byte buffer to write the enciphered or deciphered
+ *      version of `input` to; may be the same as `input`.
+ * @param subkeys The 16 subkeys to apply to `input` per pass, in order: the
+ *      `encipherSubkeys` of a `DES_Key_t` to encipher it, or its
+ *      `decipherSubkeys` to decipher it.
+ * @param numPasses The number of consecutive DES operations to apply, each
+ *      with the next 16 of `subkeys`. The final permutation of one pass and
+ *      the initial permutation of the next cancel out, so they're skipped.
  */
-static Byte_t *_process(
-	const Byte_t *buffer, const Byte_t *key, int direction
+static void _process(
+	const Byte_t *input, Byte_t *output, const Byte_t subkeys[][8],
+	int numPasses
 );
 
+/**
+ * Copy `input` into a newly allocated 8-byte buffer, and `_process()` it in
+ * place. Used by the allocating `DES_encipher()`/`DES_decipher()`.
+ * @return The processed buffer, or `NULL` if memory could not be allocated.
+ */
+static Byte_t *_processCopy(const Byte_t *input, const Byte_t subkeys[][8]);
+
+/**
+ * The DES round function: expand `half`, XOR it with `subkey` and pass it
+ * through the S-boxes and permutation, using the combined `spBoxes` tables.
+ * @param half The right half of the block, with its first bit as the most
+ *      significant.
+ * @param subkey A subkey split into 6-bit groups, as in `DES_Key_t`.
+ * @return The 32-bit output of the round function.
+ */
+static uint32_t _feistel(uint32_t half, const Byte_t *subkey);
+
+/**
+ * Apply the initial permutation to a block split into two big-endian words,
+ * with a network of masked bit swaps between them rather than bit by bit.
+ */
+static void _initialPermutation(uint32_t *left, uint32_t *right);
+
+/**
+ * The inverse of `_initialPermutation()`.
+ */
+static void _finalPermutation(uint32_t *left, uint32_t *right);
+
+/**
+ * Split a 6-byte subkey as created by `_generateSubkeys()` into the 6-bit
+ * groups used by `_feistel()`.
+ */
+static void _splitSubkey(const Byte_t *subkey, Byte_t *groups);
+
 /**
  * @brief Generate the 16 DES subkeys from the master key.
  * @param key The master 8-byte encryption key.
@@ -29,186 +75,246 @@ static Byte_t *_process(
 test_static void _generateSubkeys(const Byte_t *key, Byte_t subkeys[][6]);
 
 /**
- * @brief Perform an expansion permutation and s-box substition on a block.
- * @param target The 4-byte buffer to write the results of operations to.
- *      In DES, this is the right half of an 8-byte block.
- * @param block The 4-byte block used as a seed value; in DES, the right half
- *      of the preceding 8-byte block.
- * @param subkey The subkey corresponding to this block (first subkey for the
- *      first permutation, second for second, etc.).
+ * Compile `compiledChoice1` and `compiledChoice2`. Run once, through
+ * `pthread_once()`.
  */
-test_static void _expansionPermutation(
-	Byte_t *target, const Byte_t *block, const Byte_t *subkey
-);
+static void _compilePermutations(void);
 
 /**
- * @brief Left-rotate the first 28 bits of 4 8-bit bytes. The last 4 bits are
- *      passed over when transferring bits shifted off the left end to the
- *      right end.
+ * @brief Left-rotate the first 28 bits of 4 8-bit bytes, leaving the last 4
+ *      bits as they are.
  * @param bytes An array of four bytes (assumed to have eight bits each).
  * @param rotDist The number of bits to rotate the array by.
  */
 test_static void _rotLeft(Byte_t *bytes, int rotDist);
 
+void DES_initKey(DES_Key_t *schedule, const Byte_t *key){
+	Byte_t subkeys[16][6] = {{0}};
+	_generateSubkeys(key, subkeys);
+	for(int subkey = 0; subkey < 16; subkey++){
+		_splitSubkey(subkeys[subkey], schedule->encipherSubkeys[subkey]);
+		_splitSubkey(subkeys[subkey], schedule->decipherSubkeys[15 - subkey]);
+	}
+}
+
+void DES_encipherBlock(
+	const Byte_t *plaintext, Byte_t *ciphertext, const DES_Key_t *key
+){
+	_process(plaintext, ciphertext, key->encipherSubkeys, 1);
+}
+
+void DES_decipherBlock(
+	const Byte_t *ciphertext, Byte_t *plaintext, const DES_Key_t *key
+){
+	_process(ciphertext, plaintext, key->decipherSubkeys, 1);
+}
+
 Byte_t *DES_encipher(const Byte_t *plaintext, const Byte_t *key){
-	return _process(plaintext, key, g_ENCIPHER);
+	DES_Key_t schedule;
+	DES_initKey(&schedule, key);
+	return _processCopy(plaintext, schedule.encipherSubkeys);
 }
 
 Byte_t *DES_decipher(const Byte_t *ciphertext, const Byte_t *key){
-	return _process(ciphertext, key, g_DECIPHER);
+	DES_Key_t schedule;
+	DES_initKey(&schedule, key);
+	return _processCopy(ciphertext, schedule.decipherSubkeys);
 }
 
-static Byte_t *_process(
-	const Byte_t *buffer, const Byte_t *key, int direction
+void TDES_initKey(
+	TDES_Key_t *schedule, const Byte_t *key1, const Byte_t *key2,
+	const Byte_t *key3
 ){
-	Byte_t subkeys[16][6] = {{0}};
-	_generateSubkeys(key, subkeys);
+	// Encryption is E(key3, D(key2, E(key1, block))), and decryption is its
+	// inverse, D(key1, E(key2, D(key3, block))): the same 48 subkeys, reversed.
+	DES_Key_t keys[3];
+	DES_initKey(&keys[0], key1);
+	DES_initKey(&keys[1], key2);
+	DES_initKey(&keys[2], (key3 != NULL) ? key3 : key1);
 
-	int initialPermutation[] = {
-		58, 50, 42, 34, 26, 18, 10, 2, 60, 52, 44, 36, 28, 20, 12, 4,
-		62, 54, 46, 38, 30, 22, 14, 6, 64, 56, 48, 40, 32, 24, 16, 8,
-		57, 49, 41, 33, 25, 17, 9, 1, 59, 51, 43, 35, 27, 19, 11, 3,
-		61, 53, 45, 37, 29, 21, 13, 5, 63, 55, 47, 39, 31, 23, 15, 7
-	};
-
-	Byte_t blocks[17][2][4] = {{{0}}};
-	int bit;
-	for(bit = 0; bit < 32; bit++){
-		if(BitOps_getBit(buffer, initialPermutation[bit] - 1)){
-			BitOps_setBit(blocks[0][0], bit);
-		}
+	memcpy(schedule->encipherSubkeys[0], keys[0].encipherSubkeys, 16 * 8);
+	memcpy(schedule->encipherSubkeys[16], keys[1].decipherSubkeys, 16 * 8);
+	memcpy(schedule->encipherSubkeys[32], keys[2].encipherSubkeys, 16 * 8);
+	for(int subkey = 0; subkey < 48; subkey++){
+		memcpy(
+			schedule->decipherSubkeys[subkey],
+			schedule->encipherSubkeys[47 - subkey], 8
+		);
 	}
+}
 
-	for(; bit < 64; bit++){
-		if(BitOps_getBit(buffer, initialPermutation[bit] - 1)){
-			BitOps_setBit(blocks[0][1], bit - 32);
-		}
-	}
+void TDES_encipherBlock(
+	const Byte_t *plaintext, Byte_t *ciphertext, const TDES_Key_t *key
+){
+	_process(plaintext, ciphertext, key->encipherSubkeys, 3);
+}
 
-	for(int block = 1; block < 17; block++){
-		for(int byte = 0; byte < 4; byte++){
-			blocks[block][0][byte] = blocks[block - 1][1][byte];
-			blocks[block][1][byte] = blocks[block - 1][0][byte];
-		}
+void TDES_decipherBlock(
+	const Byte_t *ciphertext, Byte_t *plaintext, const TDES_Key_t *key
+){
+	_process(ciphertext, plaintext, key->decipherSubkeys, 3);
+}
 
-		int subkeyInd = (direction == g_ENCIPHER) ?
-			block - 1 :
-			16 - block;
-		_expansionPermutation(
-			blocks[block][1], blocks[block - 1][1], subkeys[subkeyInd]
-		);
+static Byte_t *_processCopy(const Byte_t *input, const Byte_t subkeys[][8]){
+	Byte_t *output;
+	if((output = malloc(8))){
+		_process(input, output, subkeys, 1);
 	}
+	return output;
+}
 
-	Byte_t finalBlocks[17][8] = {{0}};
-	for(int block = 0; block < 17; block++){
-		for(bit = 0; bit < 64; bit++){
-			int bitPos = finalPermutation[bit] - 1;
-			int bitVal = (bitPos < 32) ?
-				BitOps_getBit(blocks[block][1], bitPos) :
-				BitOps_getBit(blocks[block][0], bitPos - 32);
-
-			if(bitVal){
-				BitOps_setBit(finalBlocks[block], bit);
-			}
-		}
-	}
+/**
+ * Read/write a big-endian 32-bit word, so that the first bit of `bytes` is the
+ * most significant bit of the word.
+ */
+static uint32_t _loadWord(const Byte_t *bytes){
+	return (uint32_t)bytes[0] << 24 | (uint32_t)bytes[1] << 16 |
+		(uint32_t)bytes[2] << 8 | bytes[3];
+}
 
-	Byte_t *ciphertext;
-	if((ciphertext = malloc(8))){
-		for(int byte = 0; byte < 8; byte++){
-			ciphertext[byte] = finalBlocks[16][byte];
-		}
-	};
-	return ciphertext;
+static void _storeWord(Byte_t *bytes, uint32_t word){
+	bytes[0] = word >> 24;
+	bytes[1] = word >> 16;
+	bytes[2] = word >> 8;
+	bytes[3] = word;
 }
 
-test_static void _generateSubkeys(const Byte_t *key, Byte_t subkeys[][6]){
-	Byte_t permutedBlocks[17][2][4] = {{{0}}};
-	int bit;
-	for(bit = 0; bit < 28; bit++){
-		if(BitOps_getBit(key, permutedChoice1[bit] - 1)){
-			BitOps_setBit(permutedBlocks[0][0], bit);
+static void _process(
+	const Byte_t *input, Byte_t *output, const Byte_t subkeys[][8],
+	int numPasses
+){
+	uint32_t left = _loadWord(input), right = _loadWord(input + 4);
+	_initialPermutation(&left, &right);
+
+	for(int pass = 0; pass < numPasses; pass++){
+		// Between passes, the halves are swapped (as they would be by the
+		// final permutation followed by the next initial permutation).
+		if(pass > 0){
+			uint32_t swap = left;
+			left = right;
+			right = swap;
 		}
-	}
 
-	for(; bit < 56; bit++){
-		if(BitOps_getBit(key, permutedChoice1[bit] - 1)){
-			BitOps_setBit(permutedBlocks[0][1], bit - 28);
+		// The halves aren't swapped after each round; instead, alternate
+		// rounds update alternate halves.
+		const Byte_t (*passSubkeys)[8] = subkeys + 16 * pass;
+		for(int round = 0; round < 16; round += 2){
+			left ^= _feistel(right, passSubkeys[round]);
+			right ^= _feistel(left, passSubkeys[round + 1]);
 		}
 	}
 
-	for(int block = 1; block < 17; block++){
-		memcpy(permutedBlocks[block], permutedBlocks[block - 1], 2 * 4);
-		_rotLeft(permutedBlocks[block][0], leftRotSchedule[block - 1]);
-		_rotLeft(permutedBlocks[block][1], leftRotSchedule[block - 1]);
-	}
+	// The final permutation is applied to the right half followed by the left
+	// half.
+	_finalPermutation(&right, &left);
+	_storeWord(output, right);
+	_storeWord(output + 4, left);
+}
 
-	for(int subkey = 0; subkey < 16; subkey++){
-		for(bit = 0; bit < 48; bit++){
-			int bitPos = permutedChoice2[bit] - 1;
-			int bitVal = (bitPos < 28) ?
-				BitOps_getBit(permutedBlocks[subkey + 1][0], bitPos) :
-				BitOps_getBit(permutedBlocks[subkey + 1][1], bitPos - 28);
-			if(bitVal){
-				BitOps_setBit(subkeys[subkey], bit);
-			}
-		}
+static uint32_t _feistel(uint32_t half, const Byte_t *subkey){
+	// The expansion's 6-bit group for S-box `box` is made of bits `4 * box - 1`
+	// through `4 * box + 4` of `half` (wrapping around at either end), so once
+	// `half` is rotated right by one bit, each group but the last is a plain
+	// 6-bit field.
+	uint32_t bits = (half >> 1) | (half << 31);
+	uint32_t output = 0;
+	for(int box = 0; box < 7; box++){
+		int group = (bits >> (26 - 4 * box)) & 0x3f;
+		output |= spBoxes[box][group ^ subkey[box]];
 	}
+
+	int lastGroup = ((bits << 2) | (bits >> 30)) & 0x3f;
+	return output | spBoxes[7][lastGroup ^ subkey[7]];
 }
 
-test_static void _expansionPermutation(
-	Byte_t *target, const Byte_t *block, const Byte_t *subkey
-){
-	Byte_t expandedBlock[6] = {0};
-	for(int bit = 0; bit < 48; bit++){
-		if(BitOps_getBit(block, expansionTable[bit] - 1)){
-			BitOps_setBit(expandedBlock, bit);
-		}
-	}
+/**
+ * Swap the bits of `*a` selected by `mask << shift` with the bits of `*b`
+ * selected by `mask`.
+ */
+static void _swapBits(uint32_t *a, uint32_t *b, int shift, uint32_t mask){
+	uint32_t swapped = ((*a >> shift) ^ *b) & mask;
+	*b ^= swapped;
+	*a ^= swapped << shift;
+}
 
-	BitOps_xor(expandedBlock, subkey, 6);
+static void _initialPermutation(uint32_t *left, uint32_t *right){
+	_swapBits(left, right, 4, 0x0f0f0f0f);
+	_swapBits(left, right, 16, 0x0000ffff);
+	_swapBits(right, left, 2, 0x33333333);
+	_swapBits(right, left, 8, 0x00ff00ff);
+	_swapBits(left, right, 1, 0x55555555);
+}
 
-	int bit4Groups[8] = {0};
-	for(int bit6Group = 0; bit6Group < 8; bit6Group++){
-		int bitOffset = bit6Group * 6;
-		int sBoxCol = (BitOps_getBit(expandedBlock, bitOffset) << 1) |
-			BitOps_getBit(expandedBlock, bitOffset + 5);
-		int sBoxRow = 0;
+static void _finalPermutation(uint32_t *left, uint32_t *right){
+	_swapBits(left, right, 1, 0x55555555);
+	_swapBits(right, left, 8, 0x00ff00ff);
+	_swapBits(right, left, 2, 0x33333333);
+	_swapBits(left, right, 16, 0x0000ffff);
+	_swapBits(left, right, 4, 0x0f0f0f0f);
+}
 
-		for(int bit = 1; bit < 5; bit++){
-			if(BitOps_getBit(expandedBlock, bitOffset + bit)){
-				sBoxRow |= 1 << (4 - bit);
-			}
-		}
+static void _splitSubkey(const Byte_t *subkey, Byte_t *groups){
+	uint64_t bits = 0;
+	for(int byte = 0; byte < 6; byte++){
+		bits = bits << 8 | subkey[byte];
+	}
 
-		bit4Groups[bit6Group] = sBoxes[bit6Group][sBoxCol][sBoxRow];
+	for(int group = 0; group < 8; group++){
+		groups[group] = (bits >> (42 - 6 * group)) & 0x3f;
 	}
+}
+
+test_static void _generateSubkeys(const Byte_t *key, Byte_t subkeys[][6]){
+	pthread_once(&permutationsCompiled, _compilePermutations);
 
-	for(int byte = 0; byte < 4; byte++){
-		int groupOffset = byte * 2;
-		expandedBlock[byte] = (bit4Groups[groupOffset] << 4) |
-			(bit4Groups[groupOffset + 1]);
+	// Each 28-bit half of the permuted key is left-aligned in 4 bytes.
+	Byte_t permutedBlocks[17][2][4] = {{{0}}};
+	uint64_t permutedKey = BitOps_permute(&compiledChoice1, BitOps_load64(key));
+	BitOps_insertBits(permutedBlocks[0][0], 0, 28, permutedKey >> 36);
+	BitOps_insertBits(permutedBlocks[0][1], 0, 28, permutedKey >> 8);
+
+	for(int block = 1; block < 17; block++){
+		memcpy(permutedBlocks[block], permutedBlocks[block - 1], 2 * 4);
+		_rotLeft(permutedBlocks[block][0], leftRotSchedule[block - 1]);
+		_rotLeft(permutedBlocks[block][1], leftRotSchedule[block - 1]);
 	}
 
-	Byte_t finalBlock[4] = {0};
-	for(int bit = 0; bit < 32; bit++){
-		if(BitOps_getBit(expandedBlock, permutation[bit] - 1)){
-			BitOps_setBit(finalBlock, bit);
-		}
+	for(int subkey = 0; subkey < 16; subkey++){
+		uint64_t halves =
+			BitOps_extractBits(permutedBlocks[subkey + 1][0], 0, 28) << 36 |
+			BitOps_extractBits(permutedBlocks[subkey + 1][1], 0, 28) << 8;
+		BitOps_insertBits(
+			subkeys[subkey], 0, 48,
+			BitOps_permute(&compiledChoice2, halves) >> 16
+		);
 	}
+}
 
-	BitOps_xor(target, finalBlock, 4);
+static void _compilePermutations(void){
+	BitOps_compilePermutation(&compiledChoice1, permutedChoice1, 56);
+	BitOps_compilePermutation(&compiledChoice2, permutedChoice2, 48);
 }
 
+#ifdef DES_TEST
+/**
+ * @brief Perform an expansion permutation and s-box substition on a block.
+ * @param target The 4-byte buffer to write the results of operations to.
+ *      In DES, this is the right half of an 8-byte block.
+ * @param block The 4-byte block used as a seed value; in DES, the right half
+ *      of the preceding 8-byte block.
+ * @param subkey The subkey corresponding to this block (first subkey for the
+ *      first permutation, second for second, etc.).
+ * Only the unit tests call this, as a check of `_feistel()`.
+ */
+void _expansionPermutation(
+	Byte_t *target, const Byte_t *block, const Byte_t *subkey
+){
+	Byte_t groups[8];
+	_splitSubkey(subkey, groups);
+	_storeWord(target, _loadWord(target) ^ _feistel(_loadWord(block), groups));
+}
+#endif
+
 test_static void _rotLeft(Byte_t *bytes, int rotDist){
-	Byte_t frontShiftedBits = bytes[0] >> (8 - rotDist);
-	bytes[0] <<= rotDist;
-
-	int byte;
-	for(byte = 1; byte < 4; byte++){
-		Byte_t shiftedBits = bytes[byte] >> (8 - rotDist);
-		bytes[byte - 1] |= shiftedBits;
-		bytes[byte] <<= rotDist;
-	}
-	bytes[byte - 1] |= frontShiftedBits << 4;
+	BitOps_rotLeftBits(bytes, 28, rotDist);
 }
@@ -6,6 +6,49 @@
 
 #include "bit_ops.h"
 
+/**
+ * @brief A precomputed DES key schedule. Generating the 16 subkeys is the most
+ *      expensive part of processing a single block, so a `DES_Key_t` should be
+ *      created once per key with `DES_initKey()` and reused for every block.
+ */
+typedef struct {
+	// Each 48-bit subkey is split into the eight 6-bit groups that are XOR'd
+	// with the input of each S-box, one group per byte.
+	Byte_t encipherSubkeys[16][8]; // The subkeys in encryption order.
+	Byte_t decipherSubkeys[16][8]; // The subkeys in decryption order.
+} DES_Key_t;
+
+/**
+ * @brief Generate the key schedule for a key.
+ * @param schedule The key schedule to populate.
+ * @param key An 8-byte key.
+ */
+void DES_initKey(DES_Key_t *schedule, const Byte_t *key);
+
+/**
+ * @brief Encrypt a block of plaintext using a precomputed key schedule,
+ *      without allocating any memory.
+ * @param plaintext An 8-byte block.
+ * @param ciphertext The 8-byte buffer to write the encrypted block to. May be
+ *      the same as `plaintext`, to encrypt it in place.
+ * @param key A key schedule created with `DES_initKey()`.
+ */
+void DES_encipherBlock(
+	const Byte_t *plaintext, Byte_t *ciphertext, const DES_Key_t *key
+);
+
+/**
+ * @brief Decrypt a block of ciphertext using a precomputed key schedule,
+ *      without allocating any memory.
+ * @param ciphertext An 8-byte block.
+ * @param plaintext The 8-byte buffer to write the decrypted block to. May be
+ *      the same as `ciphertext`, to decrypt it in place.
+ * @param key A key schedule created with `DES_initKey()`.
+ */
+void DES_decipherBlock(
+	const Byte_t *ciphertext, Byte_t *plaintext, const DES_Key_t *key
+);
+
 /**
  * @brief Encrypt a block of plaintext using DES.
  * @param plaintext An 8-byte block.
@@ -24,6 +67,55 @@ Byte_t *DES_encipher(const Byte_t *plaintext, const Byte_t *key);
  */
 Byte_t *DES_decipher(const Byte_t *ciphertext, const Byte_t *key);
 
+/**
+ * @brief A precomputed Triple-DES (EDE) key schedule: the 48 subkeys of its
+ *      three DES operations, in the order they're applied.
+ */
+typedef struct {
+	Byte_t encipherSubkeys[48][8]; // The subkeys in encryption order.
+	Byte_t decipherSubkeys[48][8]; // The subkeys in decryption order.
+} TDES_Key_t;
+
+/**
+ * @brief Generate the Triple-DES key schedule for two or three keys.
+ *      Encryption is done as encryption with `key1`, decryption with `key2`,
+ *      then encryption with `key3`.
+ * @param schedule The key schedule to populate.
+ * @param key1 The first 8-byte key.
+ * @param key2 The second 8-byte key.
+ * @param key3 The third 8-byte key, or `NULL` for two-key Triple-DES (where
+ *      `key1` is used in its place).
+ */
+void TDES_initKey(
+	TDES_Key_t *schedule, const Byte_t *key1, const Byte_t *key2,
+	const Byte_t *key3
+);
+
+/**
+ * @brief Encrypt a block of plaintext with Triple-DES, without allocating any
+ *      memory. The initial and final permutations are done only once, rather
+ *      than around each of the three DES operations.
+ * @param plaintext An 8-byte block.
+ * @param ciphertext The 8-byte buffer to write the encrypted block to. May be
+ *      the same as `plaintext`.
+ * @param key A key schedule created with `TDES_initKey()`.
+ */
+void TDES_encipherBlock(
+	const Byte_t *plaintext, Byte_t *ciphertext, const TDES_Key_t *key
+);
+
+/**
+ * @brief Decrypt a block of ciphertext with Triple-DES, without allocating
+ *      any memory.
+ * @param ciphertext An 8-byte block.
+ * @param plaintext The 8-byte buffer to write the decrypted block to. May be
+ *      the same as `ciphertext`.
+ * @param key A key schedule created with `TDES_initKey()`.
+ */
+void TDES_decipherBlock(
+	const Byte_t *ciphertext, Byte_t *plaintext, const TDES_Key_t *key
+);
+
 /**
  * Static function specifiers are discarded when this module is compiled in a
  * testing environment, exposing the corresponding functions for direct calls
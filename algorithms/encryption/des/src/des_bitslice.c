@@ -0,0 +1,193 @@
+#include <stdbool.h>
+
+#include "des_bitslice.h"
+#include "des_sbox_circuits.h"
+#include "des_tables.h"
+
+/**
+ * The number of `uint64_t` words in a `DES_Slice_t`.
+ */
+#define SLICE_WORDS (DES_SLICE_BITS / 64)
+
+/**
+ * Encrypt or decrypt a batch of bitsliced blocks in place.
+ * @param block The 64 slices of the batch: `block[n]` holds bit `n` of every
+ *      block.
+ * @param subkeys The bitsliced subkeys, in encryption order.
+ * @param decipher Whether to apply the subkeys in reverse order, to decipher
+ *      the batch.
+ */
+static void _process(
+	DES_Slice_t *block, const DES_Slice_t subkeys[][48], bool decipher
+);
+
+/**
+ * Load up to `DES_SLICE_BITS` consecutive 8-byte blocks into 64 slices. Lanes
+ * past `numBlocks` are zeroed.
+ */
+static void _loadSlices(
+	const Byte_t *blocks, size_t numBlocks, DES_Slice_t *slices
+);
+
+/**
+ * The inverse of `_loadSlices()`: write the first `numBlocks` lanes of 64
+ * slices out as consecutive 8-byte blocks.
+ */
+static void _storeSlices(
+	const DES_Slice_t *slices, size_t numBlocks, Byte_t *blocks
+);
+
+/**
+ * Transpose a 64x64 bit matrix in place, where `rows[n]` is row `n` and its
+ * most significant bit is column 0.
+ */
+static void _transpose(uint64_t *rows);
+
+/**
+ * Encrypt or decrypt `numBlocks` blocks, one batch at a time.
+ */
+static void _processBlocks(
+	const Byte_t *input, Byte_t *output, size_t numBlocks,
+	const DES_BitsliceKey_t *key, bool decipher
+);
+
+void DES_initBitsliceKey(DES_BitsliceKey_t *schedule, const DES_Key_t *key){
+	const DES_Slice_t zero = {0};
+	for(int round = 0; round < 16; round++){
+		for(int bit = 0; bit < 48; bit++){
+			uint64_t bitVal =
+				(key->encipherSubkeys[round][bit / 6] >> (5 - bit % 6)) & 1;
+			schedule->subkeys[round][bit] = zero - bitVal;
+		}
+	}
+}
+
+void DES_encipherBitsliced(
+	const Byte_t *plaintext, Byte_t *ciphertext, size_t numBlocks,
+	const DES_BitsliceKey_t *key
+){
+	_processBlocks(plaintext, ciphertext, numBlocks, key, false);
+}
+
+void DES_decipherBitsliced(
+	const Byte_t *ciphertext, Byte_t *plaintext, size_t numBlocks,
+	const DES_BitsliceKey_t *key
+){
+	_processBlocks(ciphertext, plaintext, numBlocks, key, true);
+}
+
+void DES_encipherSlices(DES_Slice_t *block, const DES_Slice_t subkeys[][48]){
+	_process(block, subkeys, false);
+}
+
+static void _processBlocks(
+	const Byte_t *input, Byte_t *output, size_t numBlocks,
+	const DES_BitsliceKey_t *key, bool decipher
+){
+	DES_Slice_t slices[64];
+	for(size_t block = 0; block < numBlocks; block += DES_SLICE_BITS){
+		size_t batchSize = numBlocks - block;
+		if(batchSize > DES_SLICE_BITS){
+			batchSize = DES_SLICE_BITS;
+		}
+
+		_loadSlices(input + 8 * block, batchSize, slices);
+		_process(slices, key->subkeys, decipher);
+		_storeSlices(slices, batchSize, output + 8 * block);
+	}
+}
+
+static void _process(
+	DES_Slice_t *block, const DES_Slice_t subkeys[][48], bool decipher
+){
+	// The initial permutation is just a matter of which slice is read where.
+	DES_Slice_t halves[64];
+	for(int bit = 0; bit < 64; bit++){
+		halves[bit] = block[initialPermutation[bit] - 1];
+	}
+
+	DES_Slice_t *left = halves, *right = halves + 32;
+	for(int round = 0; round < 16; round++){
+		const DES_Slice_t *subkey = subkeys[decipher ? 15 - round : round];
+		DES_Slice_t sBoxInput[48], sBoxOutput[32];
+		for(int bit = 0; bit < 48; bit++){
+			sBoxInput[bit] = right[expansionTable[bit] - 1] ^ subkey[bit];
+		}
+
+		_sBox1(sBoxInput, sBoxOutput);
+		_sBox2(sBoxInput + 6, sBoxOutput + 4);
+		_sBox3(sBoxInput + 12, sBoxOutput + 8);
+		_sBox4(sBoxInput + 18, sBoxOutput + 12);
+		_sBox5(sBoxInput + 24, sBoxOutput + 16);
+		_sBox6(sBoxInput + 30, sBoxOutput + 20);
+		_sBox7(sBoxInput + 36, sBoxOutput + 24);
+		_sBox8(sBoxInput + 42, sBoxOutput + 28);
+
+		for(int bit = 0; bit < 32; bit++){
+			left[bit] ^= sBoxOutput[permutation[bit] - 1];
+		}
+
+		DES_Slice_t *swap = left;
+		left = right;
+		right = swap;
+	}
+
+	// The final permutation, the inverse of the initial one, is applied to the
+	// right half followed by the left half.
+	for(int bit = 0; bit < 64; bit++){
+		block[initialPermutation[bit] - 1] =
+			(bit < 32) ? right[bit] : left[bit - 32];
+	}
+}
+
+static void _loadSlices(
+	const Byte_t *blocks, size_t numBlocks, DES_Slice_t *slices
+){
+	for(int word = 0; word < SLICE_WORDS; word++){
+		uint64_t rows[64] = {0};
+		for(size_t lane = 0; lane < 64 && word * 64 + lane < numBlocks; lane++){
+			const Byte_t *bytes = blocks + 8 * (word * 64 + lane);
+			for(int byte = 0; byte < 8; byte++){
+				rows[lane] = rows[lane] << 8 | bytes[byte];
+			}
+		}
+
+		_transpose(rows);
+		for(int bit = 0; bit < 64; bit++){
+			((uint64_t *)&slices[bit])[word] = rows[bit];
+		}
+	}
+}
+
+static void _storeSlices(
+	const DES_Slice_t *slices, size_t numBlocks, Byte_t *blocks
+){
+	for(int word = 0; word < SLICE_WORDS; word++){
+		uint64_t rows[64];
+		for(int bit = 0; bit < 64; bit++){
+			rows[bit] = ((const uint64_t *)&slices[bit])[word];
+		}
+
+		_transpose(rows);
+		for(size_t lane = 0; lane < 64 && word * 64 + lane < numBlocks; lane++){
+			Byte_t *bytes = blocks + 8 * (word * 64 + lane);
+			for(int byte = 0; byte < 8; byte++){
+				bytes[byte] = rows[lane] >> (56 - 8 * byte);
+			}
+		}
+	}
+}
+
+static void _transpose(uint64_t *rows){
+	// Swap the off-diagonal blocks of each 2x2 grid of `width`-sized blocks,
+	// halving `width` until single bits have been swapped.
+	uint64_t mask = 0x00000000ffffffff;
+	for(int width = 32; width > 0; width >>= 1, mask ^= mask << width){
+		for(int row = 0; row < 64; row = (row + width + 1) & ~width){
+			uint64_t swapped =
+				((rows[row + width] >> width) ^ rows[row]) & mask;
+			rows[row] ^= swapped;
+			rows[row + width] ^= swapped << width;
+		}
+	}
+}
@@ -0,0 +1,88 @@
+/**
+ * @brief A bitsliced implementation of DES, for encrypting and decrypting many
+ *      blocks at once. Bit `n` of every block in a batch is held in a single
+ *      `DES_Slice_t`, one block per bit ("lane") of it, and the S-boxes are
+ *      evaluated as boolean circuits instead of table lookups. Besides being
+ *      faster than `DES_encipherBlock()` for bulk data, this runs in constant
+ *      time: no branch or memory access depends on the key or the data.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "des.h"
+
+/**
+ * The number of blocks processed in parallel. Defaults to 64, using a
+ * `uint64_t` per slice; compile with `-DDES_SLICE_BITS=128` or `256` to use
+ * GCC vector extensions instead, which map onto SSE2/AVX2 registers when
+ * those are enabled (e.g. with `-mavx2`).
+ */
+#ifndef DES_SLICE_BITS
+#define DES_SLICE_BITS 64
+#endif
+
+#if DES_SLICE_BITS == 64
+typedef uint64_t DES_Slice_t;
+#elif DES_SLICE_BITS == 128 || DES_SLICE_BITS == 256
+typedef uint64_t DES_Slice_t __attribute__((vector_size(DES_SLICE_BITS / 8)));
+#else
+#error "DES_SLICE_BITS must be one of 64, 128 or 256."
+#endif
+
+/**
+ * @brief A key schedule for the bitsliced implementation: every subkey bit
+ *      broadcast to all lanes of a slice.
+ */
+typedef struct {
+	DES_Slice_t subkeys[16][48]; // The subkeys in encryption order.
+} DES_BitsliceKey_t;
+
+/**
+ * @brief Generate the bitsliced key schedule for a key.
+ * @param schedule The bitsliced key schedule to populate.
+ * @param key A key schedule created with `DES_initKey()`.
+ */
+void DES_initBitsliceKey(DES_BitsliceKey_t *schedule, const DES_Key_t *key);
+
+/**
+ * @brief Encrypt consecutive blocks of plaintext, `DES_SLICE_BITS` at a time.
+ * @param plaintext `numBlocks` 8-byte blocks.
+ * @param ciphertext The buffer to write the `numBlocks` encrypted blocks to.
+ *      May be the same as `plaintext`, to encrypt it in place.
+ * @param numBlocks The number of blocks to encrypt. Need not be a multiple of
+ *      `DES_SLICE_BITS`, although the last batch costs as much as a full one.
+ * @param key A key schedule created with `DES_initBitsliceKey()`.
+ */
+void DES_encipherBitsliced(
+	const Byte_t *plaintext, Byte_t *ciphertext, size_t numBlocks,
+	const DES_BitsliceKey_t *key
+);
+
+/**
+ * @brief Decrypt consecutive blocks of ciphertext, `DES_SLICE_BITS` at a time.
+ * @param ciphertext `numBlocks` 8-byte blocks.
+ * @param plaintext The buffer to write the `numBlocks` decrypted blocks to.
+ *      May be the same as `ciphertext`, to decrypt it in place.
+ * @param numBlocks The number of blocks to decrypt.
+ * @param key A key schedule created with `DES_initBitsliceKey()`.
+ */
+void DES_decipherBitsliced(
+	const Byte_t *ciphertext, Byte_t *plaintext, size_t numBlocks,
+	const DES_BitsliceKey_t *key
+);
+
+/**
+ * @brief Encrypt a batch of blocks that's already bitsliced, with a separate
+ *      subkey bit per lane, for callers that build their slices directly
+ *      rather than from blocks in memory (e.g. a key search, where every lane
+ *      holds the same plaintext but a different key).
+ * @param block The 64 slices of the batch, which will be encrypted in place:
+ *      `block[n]` holds bit `n` of every block, where bit 0 is the most
+ *      significant bit of the first byte.
+ * @param subkeys The 16 subkeys in encryption order, bit `n` of subkey `r`
+ *      for every lane in `subkeys[r][n]`.
+ */
+void DES_encipherSlices(DES_Slice_t *block, const DES_Slice_t subkeys[][48]);
@@ -0,0 +1,406 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "des_bitslice.h"
+#include "des_keysearch.h"
+
+/**
+ * The number of candidates handed to a thread at a time: large enough that
+ * threads rarely contend for the lock, small enough that resuming from a
+ * checkpoint repeats little work. Must be a multiple of `DES_SLICE_BITS`.
+ */
+#define CHUNK_SIZE ((uint64_t)1 << 20)
+
+/**
+ * The number of low bits of a candidate index that select a lane of a batch:
+ * `log2(DES_SLICE_BITS)`.
+ */
+#if DES_SLICE_BITS == 64
+#define LANE_BITS 6
+#elif DES_SLICE_BITS == 128
+#define LANE_BITS 7
+#else
+#define LANE_BITS 8
+#endif
+
+/**
+ * The number of `uint64_t` words in a `DES_Slice_t`.
+ */
+#define SLICE_WORDS (DES_SLICE_BITS / 64)
+
+/**
+ * The key bits DES ignores: the least significant bit of each byte.
+ */
+#define PARITY_BITS 0x0101010101010101
+
+/**
+ * The state of a search, shared by its threads. Everything below `lock` is
+ * protected by it.
+ */
+typedef struct {
+	DES_KeySearch_t *search;
+
+	// The key bit (numbered from 0, the most significant bit of the first
+	// byte) that each varied bit of a candidate index replaces, lowest first.
+	int maskPositions[56];
+	int numMaskBits;
+
+	// The template for each batch's key slices, with every lane of a slice
+	// broadcasting the base key's bit, except for the varied bits that select
+	// a lane within a batch.
+	DES_Slice_t keySlices[64];
+
+	// The subkey bits (`16 * 48` of them, numbered round by round) that are
+	// copies of each key bit. A key bit is in at most one per round.
+	int subkeyUses[64][16];
+	int numSubkeyUses[64];
+
+	DES_Slice_t plaintext[64];
+	DES_Slice_t ciphertext[64];
+
+	pthread_mutex_t lock;
+	pthread_cond_t finished; // Signalled when a thread finishes.
+	uint64_t nextChunk; // The index the next chunk handed out starts at.
+	uint64_t *chunkStarts; // Each thread's chunk, or `UINT64_MAX` if none.
+	int numThreads;
+	uint64_t numTried;
+	uint64_t found; // The lowest index found to match, or `UINT64_MAX`.
+	bool stop;
+	int numRunning;
+} _Search_t;
+
+/**
+ * A search thread's arguments.
+ */
+typedef struct {
+	_Search_t *search;
+	int index;
+} _Worker_t;
+
+/**
+ * Load 8 bytes as a big-endian integer, so that key bit `n` is bit `63 - n`.
+ */
+static uint64_t _loadKey(const Byte_t *bytes);
+
+/**
+ * Fill in everything in a `_Search_t` that's derived from its `search`.
+ */
+static void _initSearch(_Search_t *state);
+
+/**
+ * The entry point of a search thread: take chunks of candidates from a
+ * `_Worker_t`'s search until there are none left or it's stopped.
+ */
+static void *_searchChunks(void *worker);
+
+/**
+ * Try candidates `first` (inclusive) to `last` (exclusive), `DES_SLICE_BITS`
+ * at a time.
+ * @return The lowest index that matches, or `UINT64_MAX` if none do.
+ */
+static uint64_t _searchChunk(
+	const _Search_t *state, uint64_t first, uint64_t last
+);
+
+/**
+ * The index every candidate before which has been tried. The caller must hold
+ * `state->lock`.
+ */
+static uint64_t _checkpoint(const _Search_t *state);
+
+uint64_t DES_numCandidates(const DES_KeySearch_t *search){
+	return (uint64_t)1 << __builtin_popcountll(
+		_loadKey(search->mask) & ~PARITY_BITS
+	);
+}
+
+void DES_candidateKey(
+	const DES_KeySearch_t *search, uint64_t index, Byte_t *key
+){
+	uint64_t mask = _loadKey(search->mask) & ~PARITY_BITS,
+		bits = _loadKey(search->baseKey) & ~mask;
+	for(uint64_t maskBit = 1; maskBit != 0; maskBit <<= 1){
+		if(mask & maskBit){
+			bits |= (index & 1) ? maskBit : 0;
+			index >>= 1;
+		}
+	}
+
+	for(int byte = 0; byte < 8; byte++){
+		key[byte] = bits >> (56 - 8 * byte);
+	}
+}
+
+bool DES_searchKey(DES_KeySearch_t *search, Byte_t *key){
+	if(search->start >= search->end){
+		return false;
+	}
+
+	int numThreads = (search->numThreads > 0) ? search->numThreads : 1;
+	// The slices may be vectors that need more alignment than `malloc()`
+	// guarantees.
+	_Search_t *state;
+	if(posix_memalign((void **)&state, __alignof__(_Search_t), sizeof(*state))){
+		state = NULL;
+	}
+	_Worker_t *workers = malloc(numThreads * sizeof(_Worker_t));
+	pthread_t *threads = malloc(numThreads * sizeof(pthread_t));
+	uint64_t *chunkStarts = malloc(numThreads * sizeof(uint64_t));
+	if(
+		state == NULL || workers == NULL || threads == NULL ||
+		chunkStarts == NULL
+	){
+		free(state);
+		free(workers);
+		free(threads);
+		free(chunkStarts);
+		return false;
+	}
+
+	state->search = search;
+	_initSearch(state);
+	pthread_mutex_init(&state->lock, NULL);
+	pthread_cond_init(&state->finished, NULL);
+	state->nextChunk = search->start;
+	state->chunkStarts = chunkStarts;
+	state->numTried = 0;
+	state->found = UINT64_MAX;
+	state->stop = false;
+	state->numRunning = 0;
+	for(int thread = 0; thread < numThreads; thread++){
+		workers[thread] = (_Worker_t){state, thread};
+		chunkStarts[thread] = UINT64_MAX;
+	}
+
+	pthread_mutex_lock(&state->lock);
+	for(int thread = 0; thread < numThreads; thread++){
+		if(
+			pthread_create(
+				&threads[thread], NULL, _searchChunks, &workers[thread]
+			) != 0
+		){
+			numThreads = thread;
+			break;
+		}
+		state->numRunning++;
+	}
+	state->numThreads = numThreads;
+
+	while(state->numRunning > 0){
+		struct timespec deadline;
+		clock_gettime(CLOCK_REALTIME, &deadline);
+		deadline.tv_sec++;
+		while(
+			state->numRunning > 0 &&
+			pthread_cond_timedwait(
+				&state->finished, &state->lock, &deadline
+			) == 0
+		);
+
+		if(state->numRunning > 0 && search->progress != NULL){
+			uint64_t checkpoint = _checkpoint(state),
+				numTried = state->numTried;
+			pthread_mutex_unlock(&state->lock);
+			bool proceed = search->progress(
+				checkpoint, numTried, search->context
+			);
+			pthread_mutex_lock(&state->lock);
+			state->stop |= !proceed;
+		}
+	}
+	pthread_mutex_unlock(&state->lock);
+
+	for(int thread = 0; thread < numThreads; thread++){
+		pthread_join(threads[thread], NULL);
+	}
+
+	bool found = state->found != UINT64_MAX;
+	if(found){
+		DES_candidateKey(search, state->found, key);
+		search->start = state->found + 1;
+	}
+	else {
+		search->start = _checkpoint(state);
+	}
+
+	pthread_mutex_destroy(&state->lock);
+	pthread_cond_destroy(&state->finished);
+	free(state);
+	free(workers);
+	free(threads);
+	free(chunkStarts);
+	return found;
+}
+
+static uint64_t _loadKey(const Byte_t *bytes){
+	uint64_t bits = 0;
+	for(int byte = 0; byte < 8; byte++){
+		bits = bits << 8 | bytes[byte];
+	}
+	return bits;
+}
+
+static void _initSearch(_Search_t *state){
+	const DES_KeySearch_t *search = state->search;
+	const DES_Slice_t zero = {0};
+	uint64_t mask = _loadKey(search->mask) & ~PARITY_BITS,
+		baseKey = _loadKey(search->baseKey);
+
+	state->numMaskBits = 0;
+	for(int bit = 63; bit >= 0; bit--){
+		if((mask >> (63 - bit)) & 1){
+			state->maskPositions[state->numMaskBits++] = bit;
+		}
+		state->keySlices[bit] = zero - ((baseKey >> (63 - bit)) & 1);
+	}
+
+	// The lowest varied bits take a different value in each lane.
+	for(
+		int maskBit = 0;
+		maskBit < state->numMaskBits && maskBit < LANE_BITS; maskBit++
+	){
+		DES_Slice_t *slice = &state->keySlices[state->maskPositions[maskBit]];
+		*slice = zero;
+		for(int lane = 0; lane < DES_SLICE_BITS; lane++){
+			if((lane >> maskBit) & 1){
+				((uint64_t *)slice)[lane / 64] |= (uint64_t)1 << (lane % 64);
+			}
+		}
+	}
+
+	// Find where each key bit ends up by generating the key schedule of a key
+	// with only that bit set.
+	for(int bit = 0; bit < 64; bit++){
+		state->numSubkeyUses[bit] = 0;
+		if(bit % 8 == 7){
+			continue;
+		}
+
+		Byte_t key[8] = {0};
+		key[bit / 8] = 0x80 >> (bit % 8);
+		DES_Key_t schedule;
+		DES_initKey(&schedule, key);
+		for(int round = 0; round < 16; round++){
+			for(int subkeyBit = 0; subkeyBit < 48; subkeyBit++){
+				Byte_t group = schedule.encipherSubkeys[round][subkeyBit / 6];
+				if((group >> (5 - subkeyBit % 6)) & 1){
+					state->subkeyUses[bit][state->numSubkeyUses[bit]++] =
+						48 * round + subkeyBit;
+				}
+			}
+		}
+	}
+
+	for(int bit = 0; bit < 64; bit++){
+		state->plaintext[bit] =
+			zero - ((search->plaintext[bit / 8] >> (7 - bit % 8)) & 1);
+		state->ciphertext[bit] =
+			zero - ((search->ciphertext[bit / 8] >> (7 - bit % 8)) & 1);
+	}
+}
+
+static void *_searchChunks(void *workerPtr){
+	_Worker_t *worker = workerPtr;
+	_Search_t *state = worker->search;
+	uint64_t end = state->search->end;
+
+	pthread_mutex_lock(&state->lock);
+	while(
+		!state->stop && state->nextChunk < end &&
+		state->nextChunk < state->found
+	){
+		// Chunks after the first are aligned to `CHUNK_SIZE`.
+		uint64_t first = state->nextChunk,
+			last = (first & ~(CHUNK_SIZE - 1)) + CHUNK_SIZE;
+		if(last > end){
+			last = end;
+		}
+		state->nextChunk = last;
+		state->chunkStarts[worker->index] = first;
+		pthread_mutex_unlock(&state->lock);
+
+		uint64_t match = _searchChunk(state, first, last);
+
+		pthread_mutex_lock(&state->lock);
+		state->chunkStarts[worker->index] = UINT64_MAX;
+		state->numTried += last - first;
+		if(match < state->found){
+			state->found = match;
+		}
+	}
+
+	state->numRunning--;
+	pthread_cond_signal(&state->finished);
+	pthread_mutex_unlock(&state->lock);
+	return NULL;
+}
+
+static uint64_t _searchChunk(
+	const _Search_t *state, uint64_t first, uint64_t last
+){
+	const DES_Slice_t zero = {0};
+	DES_Slice_t keySlices[64], subkeys[16][48], block[64];
+	memcpy(keySlices, state->keySlices, sizeof(keySlices));
+
+	// Set the higher varied bits for the first batch, and the whole key
+	// schedule from them. Subsequent batches only update the bits that change.
+	uint64_t batch = first & ~(uint64_t)(DES_SLICE_BITS - 1);
+	for(int maskBit = LANE_BITS; maskBit < state->numMaskBits; maskBit++){
+		keySlices[state->maskPositions[maskBit]] =
+			zero - ((batch >> maskBit) & 1);
+	}
+	for(int bit = 0; bit < 64; bit++){
+		for(int use = 0; use < state->numSubkeyUses[bit]; use++){
+			int subkeyBit = state->subkeyUses[bit][use];
+			subkeys[subkeyBit / 48][subkeyBit % 48] = keySlices[bit];
+		}
+	}
+
+	for(; batch < last; batch += DES_SLICE_BITS){
+		uint64_t changed = (batch ^ (batch - DES_SLICE_BITS)) >> LANE_BITS;
+		for(int maskBit = LANE_BITS; changed != 0; maskBit++, changed >>= 1){
+			if(!(changed & 1) || maskBit >= state->numMaskBits){
+				continue;
+			}
+
+			int bit = state->maskPositions[maskBit];
+			keySlices[bit] = zero - ((batch >> maskBit) & 1);
+			for(int use = 0; use < state->numSubkeyUses[bit]; use++){
+				int subkeyBit = state->subkeyUses[bit][use];
+				subkeys[subkeyBit / 48][subkeyBit % 48] = keySlices[bit];
+			}
+		}
+
+		memcpy(block, state->plaintext, sizeof(block));
+		DES_encipherSlices(block, (const DES_Slice_t (*)[48])subkeys);
+		DES_Slice_t mismatches = zero;
+		for(int bit = 0; bit < 64; bit++){
+			mismatches |= block[bit] ^ state->ciphertext[bit];
+		}
+
+		for(int word = 0; word < SLICE_WORDS; word++){
+			uint64_t matches = ~((uint64_t *)&mismatches)[word];
+			for(; matches != 0; matches &= matches - 1){
+				uint64_t index = batch + 64 * word + __builtin_ctzll(matches);
+				if(index >= first && index < last){
+					return index;
+				}
+			}
+		}
+	}
+	return UINT64_MAX;
+}
+
+static uint64_t _checkpoint(const _Search_t *state){
+	uint64_t checkpoint = state->nextChunk;
+	for(int thread = 0; thread < state->numThreads; thread++){
+		if(state->chunkStarts[thread] < checkpoint){
+			checkpoint = state->chunkStarts[thread];
+		}
+	}
+	return checkpoint;
+}
@@ -0,0 +1,79 @@
+/**
+ * @brief An exhaustive search for the DES key that encrypts a known plaintext
+ *      block to a known ciphertext block, over a subspace of keys.
+ *
+ * The subspace is a base key and a mask of the key bits to vary; the
+ * candidates are numbered from 0 to `2^n - 1`, where `n` is the number of
+ * mask bits (ignoring parity bits, the least significant bit of each byte,
+ * which DES never reads), and candidate `i` is the base key with the masked
+ * bits replaced by the bits of `i`, the lowest mask bit taking the lowest bit
+ * of `i`. A search covers a range of those indices, so it can be split up, or
+ * stopped at a checkpoint and resumed later.
+ *
+ * Candidates are tried `DES_SLICE_BITS` at a time on the bitsliced
+ * implementation, one key per lane. Since every subkey bit is just a copy of a
+ * key bit, each batch's key schedule is a matter of picking out the slices of
+ * its key bits, only a few of which change from one batch to the next.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "des.h"
+
+/**
+ * @brief A key search: what to search for, over which candidates, and with how
+ *      many threads.
+ */
+typedef struct {
+	Byte_t plaintext[8];
+	Byte_t ciphertext[8];
+	Byte_t baseKey[8]; // The key bits outside `mask`.
+	Byte_t mask[8]; // The key bits to vary.
+
+	// The range of candidate indices to try, `start` inclusive and `end`
+	// exclusive. `end` may be at most `DES_numCandidates(search)`.
+	uint64_t start;
+	uint64_t end;
+
+	int numThreads;
+
+	// If not `NULL`, called about once a second from the calling thread with
+	// a checkpoint (an index which every candidate before has been tried) and
+	// the number of candidates tried so far. Returning `false` stops the
+	// search at the next checkpoint.
+	bool (*progress)(uint64_t checkpoint, uint64_t numTried, void *context);
+	void *context; // Passed to `progress`.
+} DES_KeySearch_t;
+
+/**
+ * @brief The number of candidates in a search's subspace.
+ * @param search A search with `mask` set.
+ * @return `2^n`, where `n` is the number of non-parity bits in `search->mask`.
+ */
+uint64_t DES_numCandidates(const DES_KeySearch_t *search);
+
+/**
+ * @brief Run a key search until it finds a key, tries every candidate, or is
+ *      stopped by its progress callback.
+ * @param search The search. `search->start` will be set to where the search
+ *      should resume from: one past the index of the key found, `end` if none
+ *      was, or the last checkpoint if it was stopped.
+ * @param key The 8-byte buffer to write the key found to, with the parity bits
+ *      of `search->baseKey`. If several candidates match, it's the one with
+ *      the lowest index.
+ * @return Whether a key was found.
+ */
+bool DES_searchKey(DES_KeySearch_t *search, Byte_t *key);
+
+/**
+ * @brief The key at a candidate index of a search's subspace.
+ * @param search A search with `baseKey` and `mask` set.
+ * @param index The index of the candidate.
+ * @param key The 8-byte buffer to write the key to.
+ */
+void DES_candidateKey(
+	const DES_KeySearch_t *search, uint64_t index, Byte_t *key
+);
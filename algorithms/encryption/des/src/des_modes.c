@@ -0,0 +1,489 @@
+#include <pthread.h>
+#include <string.h>
+
+#include "des_bitslice.h"
+#include "des_modes.h"
+
+/**
+ * The minimum number of blocks worth starting a thread for in
+ * `DES_cryptCTRParallel()`: 64KiB.
+ */
+#define MIN_BLOCKS_PER_THREAD (64 * 1024 / 8)
+
+/**
+ * Encrypts or decrypts one 8-byte block with `key`: one of the DES or
+ * Triple-DES block functions, so that the modes can be shared between them.
+ */
+typedef void (*_BlockFunc_t)(
+	const Byte_t *input, Byte_t *output, const void *key
+);
+
+/**
+ * `_BlockFunc_t` wrappers around the block functions in `des.h`.
+ */
+static void _desEncipher(const Byte_t *input, Byte_t *output, const void *key);
+static void _desDecipher(const Byte_t *input, Byte_t *output, const void *key);
+static void _tdesEncipher(const Byte_t *input, Byte_t *output, const void *key);
+static void _tdesDecipher(const Byte_t *input, Byte_t *output, const void *key);
+
+/**
+ * The implementations of the modes, in terms of a `_BlockFunc_t` and its key.
+ * Their other parameters are as documented in `des_modes.h`.
+ */
+static size_t _encipherECB(
+	const Byte_t *plaintext, Byte_t *ciphertext, size_t length,
+	_BlockFunc_t encipher, const void *key
+);
+static bool _decipherECB(
+	const Byte_t *ciphertext, Byte_t *plaintext, size_t length,
+	_BlockFunc_t decipher, const void *key, size_t *plaintextLength
+);
+static size_t _encipherCBC(
+	const Byte_t *plaintext, Byte_t *ciphertext, size_t length,
+	_BlockFunc_t encipher, const void *key, const Byte_t *iv
+);
+static bool _decipherCBC(
+	const Byte_t *ciphertext, Byte_t *plaintext, size_t length,
+	_BlockFunc_t decipher, const void *key, const Byte_t *iv,
+	size_t *plaintextLength
+);
+static void _cryptCTR(
+	const Byte_t *input, Byte_t *output, size_t length,
+	_BlockFunc_t encipher, const void *key, const Byte_t *iv,
+	uint64_t blockOffset
+);
+
+/**
+ * Encrypt/decrypt the whole blocks of a buffer in CBC mode, without any
+ * padding. `chain` holds the previous ciphertext block (initially the IV), and
+ * is updated to the last one.
+ */
+static void _encipherCBCBlocks(
+	const Byte_t *plaintext, Byte_t *ciphertext, size_t length,
+	_BlockFunc_t encipher, const void *key, Byte_t *chain
+);
+static void _decipherCBCBlocks(
+	const Byte_t *ciphertext, Byte_t *plaintext, size_t length,
+	_BlockFunc_t decipher, const void *key, Byte_t *chain
+);
+
+/**
+ * Encrypt or decrypt the whole batches of `DES_SLICE_BITS` blocks at the start
+ * of a buffer with the bitsliced implementation, which is much faster than
+ * going a block at a time once the key schedule has been bitsliced.
+ * @return The number of bytes processed: `length` rounded down to a multiple
+ *      of `8 * DES_SLICE_BITS`.
+ */
+static size_t _cryptBatches(
+	const Byte_t *input, Byte_t *output, size_t length, const DES_Key_t *key,
+	bool decipher
+);
+
+/**
+ * Return the counter of the first block of a CTR buffer: `iv`, read as a
+ * big-endian number, plus `blockOffset`.
+ */
+static uint64_t _initialCounter(const Byte_t *iv, uint64_t blockOffset);
+
+/**
+ * Write `counter` to the 8-byte `block`, most significant byte first.
+ */
+static void _counterBlock(uint64_t counter, Byte_t *block);
+
+/**
+ * A contiguous range of blocks processed by one thread of
+ * `DES_cryptCTRParallel()`, with the arguments of its `DES_cryptCTR()` call.
+ */
+typedef struct {
+	pthread_t thread;
+	const Byte_t *input;
+	Byte_t *output;
+	size_t length;
+	const DES_Key_t *key;
+	const Byte_t *iv;
+	uint64_t blockOffset;
+} _CTRRange_t;
+
+/**
+ * The entry point of a `DES_cryptCTRParallel()` thread. Takes a `_CTRRange_t`.
+ */
+static void *_cryptCTRRange(void *range);
+
+/**
+ * Write the final, padded block of a plaintext to `block`.
+ * @param tail The bytes of the plaintext after its last whole block.
+ * @param tailLength The number of bytes in `tail`; less than 8.
+ */
+static void _padBlock(const Byte_t *tail, size_t tailLength, Byte_t *block);
+
+/**
+ * Check the padding of a decrypted final block. Every padding byte is checked
+ * regardless of the result, so the time taken doesn't reveal where the
+ * padding went wrong.
+ * @return The number of padding bytes, or 0 if the padding is invalid.
+ */
+static size_t _checkPadding(const Byte_t *block);
+
+/**
+ * XOR the 8-byte `block` into `target`.
+ */
+static void _xorBlock(Byte_t *target, const Byte_t *block);
+
+size_t DES_paddedLength(size_t length){
+	return (length / 8 + 1) * 8;
+}
+
+size_t DES_encipherECB(
+	const Byte_t *plaintext, Byte_t *ciphertext, size_t length,
+	const DES_Key_t *key
+){
+	size_t offset = _cryptBatches(plaintext, ciphertext, length, key, false);
+	return offset + _encipherECB(
+		plaintext + offset, ciphertext + offset, length - offset,
+		_desEncipher, key
+	);
+}
+
+bool DES_decipherECB(
+	const Byte_t *ciphertext, Byte_t *plaintext, size_t length,
+	const DES_Key_t *key, size_t *plaintextLength
+){
+	if(length == 0 || length % 8 != 0){
+		return false;
+	}
+
+	// Leave the last block to `_decipherECB()`, which checks its padding.
+	size_t offset = _cryptBatches(ciphertext, plaintext, length - 8, key, true);
+	bool valid = _decipherECB(
+		ciphertext + offset, plaintext + offset, length - offset,
+		_desDecipher, key, plaintextLength
+	);
+	*plaintextLength += offset;
+	return valid;
+}
+
+size_t DES_encipherCBC(
+	const Byte_t *plaintext, Byte_t *ciphertext, size_t length,
+	const DES_Key_t *key, const Byte_t *iv
+){
+	return _encipherCBC(plaintext, ciphertext, length, _desEncipher, key, iv);
+}
+
+bool DES_decipherCBC(
+	const Byte_t *ciphertext, Byte_t *plaintext, size_t length,
+	const DES_Key_t *key, const Byte_t *iv, size_t *plaintextLength
+){
+	return _decipherCBC(
+		ciphertext, plaintext, length, _desDecipher, key, iv, plaintextLength
+	);
+}
+
+void DES_encipherCBCBlocks(
+	const Byte_t *plaintext, Byte_t *ciphertext, size_t length,
+	const DES_Key_t *key, Byte_t *iv
+){
+	_encipherCBCBlocks(plaintext, ciphertext, length, _desEncipher, key, iv);
+}
+
+void DES_decipherCBCBlocks(
+	const Byte_t *ciphertext, Byte_t *plaintext, size_t length,
+	const DES_Key_t *key, Byte_t *iv
+){
+	_decipherCBCBlocks(ciphertext, plaintext, length, _desDecipher, key, iv);
+}
+
+void DES_cryptCTR(
+	const Byte_t *input, Byte_t *output, size_t length, const DES_Key_t *key,
+	const Byte_t *iv, uint64_t blockOffset
+){
+	size_t offset = 0;
+	if(length >= 8 * DES_SLICE_BITS){
+		DES_BitsliceKey_t bitsliceKey;
+		DES_initBitsliceKey(&bitsliceKey, key);
+
+		Byte_t keystream[8 * DES_SLICE_BITS];
+		uint64_t counter = _initialCounter(iv, blockOffset);
+		size_t numBatches = length / sizeof(keystream);
+		for(size_t batch = 0; batch < numBatches; batch++){
+			for(int block = 0; block < DES_SLICE_BITS; block++, counter++){
+				_counterBlock(counter, keystream + 8 * block);
+			}
+			DES_encipherBitsliced(
+				keystream, keystream, DES_SLICE_BITS, &bitsliceKey
+			);
+
+			for(size_t byte = 0; byte < sizeof(keystream); byte++){
+				output[offset + byte] = input[offset + byte] ^ keystream[byte];
+			}
+			offset += sizeof(keystream);
+		}
+	}
+
+	_cryptCTR(
+		input + offset, output + offset, length - offset, _desEncipher, key,
+		iv, blockOffset + offset / 8
+	);
+}
+
+void DES_cryptCTRParallel(
+	const Byte_t *input, Byte_t *output, size_t length, const DES_Key_t *key,
+	const Byte_t *iv, uint64_t blockOffset, int numThreads
+){
+	size_t numBlocks = (length + 7) / 8;
+	size_t maxThreads = numBlocks / MIN_BLOCKS_PER_THREAD;
+	if(numThreads > 1 && (size_t)numThreads > maxThreads){
+		numThreads = maxThreads;
+	}
+
+	if(numThreads <= 1){
+		DES_cryptCTR(input, output, length, key, iv, blockOffset);
+		return;
+	}
+
+	// Every range but the last is a whole number of blocks. The last one is
+	// processed by the calling thread, as is any range whose thread couldn't
+	// be started.
+	_CTRRange_t ranges[numThreads];
+	bool started[numThreads];
+	for(int range = 0; range < numThreads; range++){
+		size_t firstBlock = numBlocks * range / numThreads,
+			endBlock = numBlocks * (range + 1) / numThreads;
+		ranges[range] = (_CTRRange_t){
+			.input = input + firstBlock * 8,
+			.output = output + firstBlock * 8,
+			.length = (range < numThreads - 1) ?
+				(endBlock - firstBlock) * 8 : length - firstBlock * 8,
+			.key = key,
+			.iv = iv,
+			.blockOffset = blockOffset + firstBlock
+		};
+
+		started[range] = range < numThreads - 1 && pthread_create(
+			&ranges[range].thread, NULL, _cryptCTRRange, &ranges[range]
+		) == 0;
+		if(!started[range]){
+			_cryptCTRRange(&ranges[range]);
+		}
+	}
+
+	for(int range = 0; range < numThreads - 1; range++){
+		if(started[range]){
+			pthread_join(ranges[range].thread, NULL);
+		}
+	}
+}
+
+size_t TDES_encipherCBC(
+	const Byte_t *plaintext, Byte_t *ciphertext, size_t length,
+	const TDES_Key_t *key, const Byte_t *iv
+){
+	return _encipherCBC(plaintext, ciphertext, length, _tdesEncipher, key, iv);
+}
+
+bool TDES_decipherCBC(
+	const Byte_t *ciphertext, Byte_t *plaintext, size_t length,
+	const TDES_Key_t *key, const Byte_t *iv, size_t *plaintextLength
+){
+	return _decipherCBC(
+		ciphertext, plaintext, length, _tdesDecipher, key, iv, plaintextLength
+	);
+}
+
+void TDES_cryptCTR(
+	const Byte_t *input, Byte_t *output, size_t length, const TDES_Key_t *key,
+	const Byte_t *iv, uint64_t blockOffset
+){
+	_cryptCTR(input, output, length, _tdesEncipher, key, iv, blockOffset);
+}
+
+static void _desEncipher(const Byte_t *input, Byte_t *output, const void *key){
+	DES_encipherBlock(input, output, key);
+}
+
+static void _desDecipher(const Byte_t *input, Byte_t *output, const void *key){
+	DES_decipherBlock(input, output, key);
+}
+
+static void _tdesEncipher(const Byte_t *input, Byte_t *output, const void *key){
+	TDES_encipherBlock(input, output, key);
+}
+
+static void _tdesDecipher(const Byte_t *input, Byte_t *output, const void *key){
+	TDES_decipherBlock(input, output, key);
+}
+
+static size_t _encipherECB(
+	const Byte_t *plaintext, Byte_t *ciphertext, size_t length,
+	_BlockFunc_t encipher, const void *key
+){
+	size_t offset;
+	for(offset = 0; offset + 8 <= length; offset += 8){
+		encipher(plaintext + offset, ciphertext + offset, key);
+	}
+
+	Byte_t lastBlock[8];
+	_padBlock(plaintext + offset, length - offset, lastBlock);
+	encipher(lastBlock, ciphertext + offset, key);
+	return offset + 8;
+}
+
+static bool _decipherECB(
+	const Byte_t *ciphertext, Byte_t *plaintext, size_t length,
+	_BlockFunc_t decipher, const void *key, size_t *plaintextLength
+){
+	if(length == 0 || length % 8 != 0){
+		return false;
+	}
+
+	for(size_t offset = 0; offset < length; offset += 8){
+		decipher(ciphertext + offset, plaintext + offset, key);
+	}
+
+	size_t padding = _checkPadding(plaintext + length - 8);
+	*plaintextLength = length - padding;
+	return padding != 0;
+}
+
+static size_t _encipherCBC(
+	const Byte_t *plaintext, Byte_t *ciphertext, size_t length,
+	_BlockFunc_t encipher, const void *key, const Byte_t *iv
+){
+	Byte_t chain[8], block[8];
+	memcpy(chain, iv, 8);
+	size_t offset = length / 8 * 8;
+	_encipherCBCBlocks(plaintext, ciphertext, offset, encipher, key, chain);
+
+	_padBlock(plaintext + offset, length - offset, block);
+	_xorBlock(block, chain);
+	encipher(block, ciphertext + offset, key);
+	return offset + 8;
+}
+
+static bool _decipherCBC(
+	const Byte_t *ciphertext, Byte_t *plaintext, size_t length,
+	_BlockFunc_t decipher, const void *key, const Byte_t *iv,
+	size_t *plaintextLength
+){
+	if(length == 0 || length % 8 != 0){
+		return false;
+	}
+
+	Byte_t chain[8];
+	memcpy(chain, iv, 8);
+	_decipherCBCBlocks(ciphertext, plaintext, length, decipher, key, chain);
+
+	size_t padding = _checkPadding(plaintext + length - 8);
+	*plaintextLength = length - padding;
+	return padding != 0;
+}
+
+static void _encipherCBCBlocks(
+	const Byte_t *plaintext, Byte_t *ciphertext, size_t length,
+	_BlockFunc_t encipher, const void *key, Byte_t *chain
+){
+	Byte_t block[8];
+	for(size_t offset = 0; offset + 8 <= length; offset += 8){
+		memcpy(block, plaintext + offset, 8);
+		_xorBlock(block, chain);
+		encipher(block, ciphertext + offset, key);
+		memcpy(chain, ciphertext + offset, 8);
+	}
+}
+
+static void _decipherCBCBlocks(
+	const Byte_t *ciphertext, Byte_t *plaintext, size_t length,
+	_BlockFunc_t decipher, const void *key, Byte_t *chain
+){
+	// Each ciphertext block is needed to decrypt the next one, so keep a copy
+	// in case it's overwritten by decrypting in place.
+	Byte_t current[8];
+	for(size_t offset = 0; offset + 8 <= length; offset += 8){
+		memcpy(current, ciphertext + offset, 8);
+		decipher(current, plaintext + offset, key);
+		_xorBlock(plaintext + offset, chain);
+		memcpy(chain, current, 8);
+	}
+}
+
+static void _cryptCTR(
+	const Byte_t *input, Byte_t *output, size_t length,
+	_BlockFunc_t encipher, const void *key, const Byte_t *iv,
+	uint64_t blockOffset
+){
+	uint64_t counter = _initialCounter(iv, blockOffset);
+	Byte_t keystream[8];
+	for(size_t offset = 0; offset < length; offset += 8, counter++){
+		_counterBlock(counter, keystream);
+		encipher(keystream, keystream, key);
+
+		size_t blockLength = (length - offset < 8) ? length - offset : 8;
+		for(size_t byte = 0; byte < blockLength; byte++){
+			output[offset + byte] = input[offset + byte] ^ keystream[byte];
+		}
+	}
+}
+
+static size_t _cryptBatches(
+	const Byte_t *input, Byte_t *output, size_t length, const DES_Key_t *key,
+	bool decipher
+){
+	size_t numBlocks = length / (8 * DES_SLICE_BITS) * DES_SLICE_BITS;
+	if(numBlocks == 0){
+		return 0;
+	}
+
+	DES_BitsliceKey_t bitsliceKey;
+	DES_initBitsliceKey(&bitsliceKey, key);
+	if(decipher){
+		DES_decipherBitsliced(input, output, numBlocks, &bitsliceKey);
+	}
+	else {
+		DES_encipherBitsliced(input, output, numBlocks, &bitsliceKey);
+	}
+	return numBlocks * 8;
+}
+
+static uint64_t _initialCounter(const Byte_t *iv, uint64_t blockOffset){
+	uint64_t counter = blockOffset;
+	for(int byte = 0; byte < 8; byte++){
+		counter += (uint64_t)iv[byte] << (56 - 8 * byte);
+	}
+	return counter;
+}
+
+static void _counterBlock(uint64_t counter, Byte_t *block){
+	for(int byte = 0; byte < 8; byte++){
+		block[byte] = counter >> (56 - 8 * byte);
+	}
+}
+
+static void *_cryptCTRRange(void *range){
+	_CTRRange_t *ctrRange = range;
+	DES_cryptCTR(
+		ctrRange->input, ctrRange->output, ctrRange->length, ctrRange->key,
+		ctrRange->iv, ctrRange->blockOffset
+	);
+	return NULL;
+}
+
+static void _padBlock(const Byte_t *tail, size_t tailLength, Byte_t *block){
+	memcpy(block, tail, tailLength);
+	memset(block + tailLength, (int)(8 - tailLength), 8 - tailLength);
+}
+
+static size_t _checkPadding(const Byte_t *block){
+	Byte_t padding = block[7];
+	int invalid = (padding == 0) | (padding > 8);
+	for(int byte = 0; byte < 8; byte++){
+		// Only the last `padding` bytes need to match it.
+		int isPadding = byte >= 8 - padding;
+		invalid |= isPadding & (block[byte] != padding);
+	}
+	return invalid ? 0 : padding;
+}
+
+static void _xorBlock(Byte_t *target, const Byte_t *block){
+	for(int byte = 0; byte < 8; byte++){
+		target[byte] ^= block[byte];
+	}
+}
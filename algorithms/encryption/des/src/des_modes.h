@@ -0,0 +1,196 @@
+/**
+ * @brief Block cipher modes of operation for DES and Triple-DES, for
+ *      encrypting and decrypting buffers of any length with a precomputed key
+ *      schedule.
+ *
+ * ECB and CBC pad the plaintext to a whole number of blocks with PKCS#7: 1 to
+ * 8 bytes are always added, each holding the number of bytes added. CTR needs
+ * no padding, and encrypts and decrypts with the same operation.
+ *
+ * Every function may be called with the same buffer as input and output.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "des.h"
+
+/**
+ * @brief The length of the ciphertext `DES_encipherECB()`/`DES_encipherCBC()`
+ *      produce for a plaintext.
+ * @param length The length of the plaintext, in bytes.
+ * @return `length` rounded up to the next multiple of 8 (adding a whole
+ *      block if it already is one).
+ */
+size_t DES_paddedLength(size_t length);
+
+/**
+ * @brief Encrypt a buffer in ECB mode, padding it with PKCS#7.
+ * @param plaintext The buffer to encrypt.
+ * @param ciphertext The buffer to write the ciphertext to. Must be at least
+ *      `DES_paddedLength(length)` bytes long.
+ * @param length The length of `plaintext`, in bytes.
+ * @param key A key schedule created with `DES_initKey()`.
+ * @return The length of the ciphertext: `DES_paddedLength(length)`.
+ */
+size_t DES_encipherECB(
+	const Byte_t *plaintext, Byte_t *ciphertext, size_t length,
+	const DES_Key_t *key
+);
+
+/**
+ * @brief Decrypt a buffer encrypted with `DES_encipherECB()`, and strip its
+ *      padding.
+ * @param ciphertext The buffer to decrypt.
+ * @param plaintext The buffer to write the plaintext to. Must be at least
+ *      `length` bytes long.
+ * @param length The length of `ciphertext`, in bytes.
+ * @param key A key schedule created with `DES_initKey()`.
+ * @param plaintextLength Will be set to the length of the plaintext, if
+ *      successful.
+ * @return `false` if `length` isn't a positive multiple of 8 or the padding is
+ *      invalid, which usually means the wrong key was used; `true` otherwise.
+ */
+bool DES_decipherECB(
+	const Byte_t *ciphertext, Byte_t *plaintext, size_t length,
+	const DES_Key_t *key, size_t *plaintextLength
+);
+
+/**
+ * @brief Encrypt a buffer in CBC mode, padding it with PKCS#7.
+ * @param plaintext The buffer to encrypt.
+ * @param ciphertext The buffer to write the ciphertext to. Must be at least
+ *      `DES_paddedLength(length)` bytes long.
+ * @param length The length of `plaintext`, in bytes.
+ * @param key A key schedule created with `DES_initKey()`.
+ * @param iv The 8-byte initialization vector, which should be unpredictable
+ *      and never reused with the same key.
+ * @return The length of the ciphertext: `DES_paddedLength(length)`.
+ */
+size_t DES_encipherCBC(
+	const Byte_t *plaintext, Byte_t *ciphertext, size_t length,
+	const DES_Key_t *key, const Byte_t *iv
+);
+
+/**
+ * @brief Decrypt a buffer encrypted with `DES_encipherCBC()`, and strip its
+ *      padding.
+ * @param ciphertext The buffer to decrypt.
+ * @param plaintext The buffer to write the plaintext to. Must be at least
+ *      `length` bytes long.
+ * @param length The length of `ciphertext`, in bytes.
+ * @param key A key schedule created with `DES_initKey()`.
+ * @param iv The 8-byte initialization vector it was encrypted with.
+ * @param plaintextLength Will be set to the length of the plaintext, if
+ *      successful.
+ * @return `false` if `length` isn't a positive multiple of 8 or the padding is
+ *      invalid; `true` otherwise.
+ */
+bool DES_decipherCBC(
+	const Byte_t *ciphertext, Byte_t *plaintext, size_t length,
+	const DES_Key_t *key, const Byte_t *iv, size_t *plaintextLength
+);
+
+/**
+ * @brief Encrypt whole blocks in CBC mode, without padding, so that a stream
+ *      can be encrypted in pieces: every piece but the last with this function,
+ *      and the last with `DES_encipherCBC()`, passing each the same `iv`.
+ * @param plaintext The buffer to encrypt.
+ * @param ciphertext The buffer to write the ciphertext to, `length` bytes long.
+ * @param length The length of `plaintext`, in bytes. Must be a multiple of 8.
+ * @param key A key schedule created with `DES_initKey()`.
+ * @param iv The 8-byte initialization vector, or the last ciphertext block of
+ *      the preceding piece. Will be set to the last ciphertext block of this
+ *      piece.
+ */
+void DES_encipherCBCBlocks(
+	const Byte_t *plaintext, Byte_t *ciphertext, size_t length,
+	const DES_Key_t *key, Byte_t *iv
+);
+
+/**
+ * @brief The inverse of `DES_encipherCBCBlocks()`: decrypt whole blocks in CBC
+ *      mode, without removing any padding. The last piece of a stream should
+ *      be decrypted with `DES_decipherCBC()` instead.
+ * @param ciphertext The buffer to decrypt.
+ * @param plaintext The buffer to write the plaintext to, `length` bytes long.
+ * @param length The length of `ciphertext`, in bytes. Must be a multiple of 8.
+ * @param key A key schedule created with `DES_initKey()`.
+ * @param iv The 8-byte initialization vector, or the last ciphertext block of
+ *      the preceding piece. Will be set to the last ciphertext block of this
+ *      piece.
+ */
+void DES_decipherCBCBlocks(
+	const Byte_t *ciphertext, Byte_t *plaintext, size_t length,
+	const DES_Key_t *key, Byte_t *iv
+);
+
+/**
+ * @brief Encrypt or decrypt a buffer in CTR mode: XOR it with the encryption
+ *      of successive counter blocks. The counter block for block `n` of the
+ *      stream is `iv`, read as a big-endian 64-bit integer, plus `n`.
+ * @param input The buffer to encrypt or decrypt.
+ * @param output The buffer to write the result to, `length` bytes long.
+ * @param length The length of `input`, in bytes.
+ * @param key A key schedule created with `DES_initKey()`.
+ * @param iv The 8-byte initial counter block, which must never be reused with
+ *      the same key.
+ * @param blockOffset The index of the block `input` starts at in the stream.
+ *      Since blocks are independent of each other, a stream can be processed
+ *      in pieces (e.g. by several threads), as long as every piece but the last
+ *      is a multiple of 8 bytes long.
+ */
+void DES_cryptCTR(
+	const Byte_t *input, Byte_t *output, size_t length, const DES_Key_t *key,
+	const Byte_t *iv, uint64_t blockOffset
+);
+
+/**
+ * @brief Encrypt or decrypt a buffer in CTR mode like `DES_cryptCTR()`, but
+ *      split into contiguous ranges of blocks processed by several threads.
+ *      The result is identical to `DES_cryptCTR()`'s.
+ * @param input The buffer to encrypt or decrypt.
+ * @param output The buffer to write the result to, `length` bytes long.
+ * @param length The length of `input`, in bytes.
+ * @param key A key schedule created with `DES_initKey()`.
+ * @param iv The 8-byte initial counter block.
+ * @param blockOffset The index of the block `input` starts at in the stream.
+ * @param numThreads The maximum number of threads to use, including the
+ *      calling one. Fewer are used for small buffers, where starting a thread
+ *      costs more than it saves.
+ */
+void DES_cryptCTRParallel(
+	const Byte_t *input, Byte_t *output, size_t length, const DES_Key_t *key,
+	const Byte_t *iv, uint64_t blockOffset, int numThreads
+);
+
+/**
+ * @brief Encrypt a buffer with Triple-DES in CBC mode, padding it with PKCS#7.
+ *      Parameters are as for `DES_encipherCBC()`, but with a key schedule
+ *      created with `TDES_initKey()`.
+ */
+size_t TDES_encipherCBC(
+	const Byte_t *plaintext, Byte_t *ciphertext, size_t length,
+	const TDES_Key_t *key, const Byte_t *iv
+);
+
+/**
+ * @brief Decrypt a buffer encrypted with `TDES_encipherCBC()`, and strip its
+ *      padding. Parameters and return value are as for `DES_decipherCBC()`.
+ */
+bool TDES_decipherCBC(
+	const Byte_t *ciphertext, Byte_t *plaintext, size_t length,
+	const TDES_Key_t *key, const Byte_t *iv, size_t *plaintextLength
+);
+
+/**
+ * @brief Encrypt or decrypt a buffer with Triple-DES in CTR mode. Parameters
+ *      are as for `DES_cryptCTR()`.
+ */
+void TDES_cryptCTR(
+	const Byte_t *input, Byte_t *output, size_t length, const TDES_Key_t *key,
+	const Byte_t *iv, uint64_t blockOffset
+);
@@ -0,0 +1,883 @@
+/*
+ * @brief The DES S-boxes as boolean circuits, for the bitsliced
+ * implementation in `des_bitslice.c`. Generated by
+ * `tools/gen_sbox_circuits.py`; don't edit by hand.
+*/
+
+#pragma once
+
+#include "des_bitslice.h"
+
+/**
+ * S-box 1: 113 gates. `in` holds its 6 input bits and `out` receives its
+ * 4 output bits, first bits first.
+ */
+static inline void _sBox1(const DES_Slice_t *in, DES_Slice_t *out){
+	DES_Slice_t t0 = ~in[1] ^ in[4];
+	DES_Slice_t t1 = ~in[1] & in[2];
+	DES_Slice_t t2 = t0 ^ t1;
+	DES_Slice_t t3 = in[4] & in[2];
+	DES_Slice_t t4 = t0 ^ t3;
+	DES_Slice_t t5 = t2 ^ t4;
+	DES_Slice_t t6 = t5 & in[3];
+	DES_Slice_t t7 = t2 ^ t6;
+	DES_Slice_t t8 = ~in[4] & in[2];
+	DES_Slice_t t9 = in[1] ^ t8;
+	DES_Slice_t t10 = ~in[1] | ~in[4];
+	DES_Slice_t t11 = ~in[1] & in[4];
+	DES_Slice_t t12 = t10 ^ t8;
+	DES_Slice_t t13 = t9 ^ t12;
+	DES_Slice_t t14 = t13 & in[3];
+	DES_Slice_t t15 = t9 ^ t14;
+	DES_Slice_t t16 = t7 ^ t15;
+	DES_Slice_t t17 = t16 & in[0];
+	DES_Slice_t t18 = t7 ^ t17;
+	DES_Slice_t t19 = in[1] ^ in[4];
+	DES_Slice_t t20 = t19 ^ t1;
+	DES_Slice_t t21 = t20 ^ t9;
+	DES_Slice_t t22 = t21 & in[3];
+	DES_Slice_t t23 = t20 ^ t22;
+	DES_Slice_t t24 = t13 ^ t19;
+	DES_Slice_t t25 = t24 & in[2];
+	DES_Slice_t t26 = t13 ^ t25;
+	DES_Slice_t t27 = in[1] & in[4];
+	DES_Slice_t t28 = t0 ^ t27;
+	DES_Slice_t t29 = t28 & in[2];
+	DES_Slice_t t30 = t0 ^ t29;
+	DES_Slice_t t31 = t26 ^ t30;
+	DES_Slice_t t32 = t31 & in[3];
+	DES_Slice_t t33 = t26 ^ t32;
+	DES_Slice_t t34 = t23 ^ t33;
+	DES_Slice_t t35 = t34 & in[0];
+	DES_Slice_t t36 = t23 ^ t35;
+	DES_Slice_t t37 = t18 ^ t36;
+	DES_Slice_t t38 = t37 & in[5];
+	DES_Slice_t t39 = t18 ^ t38;
+	DES_Slice_t t40 = ~in[1] ^ t8;
+	DES_Slice_t t41 = t24 ^ t8;
+	DES_Slice_t t42 = t40 ^ t41;
+	DES_Slice_t t43 = t42 & in[3];
+	DES_Slice_t t44 = t40 ^ t43;
+	DES_Slice_t t45 = t42 & in[2];
+	DES_Slice_t t46 = t24 ^ t45;
+	DES_Slice_t t47 = in[1] & ~in[4];
+	DES_Slice_t t48 = t0 ^ t25;
+	DES_Slice_t t49 = t46 ^ t48;
+	DES_Slice_t t50 = t49 & in[3];
+	DES_Slice_t t51 = t46 ^ t50;
+	DES_Slice_t t52 = t44 ^ t51;
+	DES_Slice_t t53 = t52 & in[0];
+	DES_Slice_t t54 = t44 ^ t53;
+	DES_Slice_t t55 = in[4] ^ t1;
+	DES_Slice_t t56 = t19 & in[2];
+	DES_Slice_t t57 = t10 ^ t56;
+	DES_Slice_t t58 = t41 & in[3];
+	DES_Slice_t t59 = t55 ^ t58;
+	DES_Slice_t t60 = t57 ^ in[3];
+	DES_Slice_t t61 = t59 ^ t60;
+	DES_Slice_t t62 = t61 & in[0];
+	DES_Slice_t t63 = t59 ^ t62;
+	DES_Slice_t t64 = t54 ^ t63;
+	DES_Slice_t t65 = t64 & in[5];
+	DES_Slice_t t66 = t54 ^ t65;
+	DES_Slice_t t67 = t2 & in[3];
+	DES_Slice_t t68 = t46 ^ t67;
+	DES_Slice_t t69 = t47 ^ t3;
+	DES_Slice_t t70 = t24 & in[3];
+	DES_Slice_t t71 = t69 ^ t70;
+	DES_Slice_t t72 = t68 ^ t71;
+	DES_Slice_t t73 = t72 & in[0];
+	DES_Slice_t t74 = t68 ^ t73;
+	DES_Slice_t t75 = t42 ^ t25;
+	DES_Slice_t t76 = t10 & in[3];
+	DES_Slice_t t77 = t75 ^ t76;
+	DES_Slice_t t78 = t12 & in[3];
+	DES_Slice_t t79 = t48 ^ t78;
+	DES_Slice_t t80 = t77 ^ t79;
+	DES_Slice_t t81 = t80 & in[0];
+	DES_Slice_t t82 = t77 ^ t81;
+	DES_Slice_t t83 = t74 ^ t82;
+	DES_Slice_t t84 = t83 & in[5];
+	DES_Slice_t t85 = t74 ^ t84;
+	DES_Slice_t t86 = t69 ^ t76;
+	DES_Slice_t t87 = in[1] ^ t3;
+	DES_Slice_t t88 = t20 ^ t87;
+	DES_Slice_t t89 = t88 & in[3];
+	DES_Slice_t t90 = t20 ^ t89;
+	DES_Slice_t t91 = t86 ^ t90;
+	DES_Slice_t t92 = t91 & in[0];
+	DES_Slice_t t93 = t86 ^ t92;
+	DES_Slice_t t94 = t11 ^ t45;
+	DES_Slice_t t95 = t94 ^ t14;
+	DES_Slice_t t96 = t24 ^ in[2];
+	DES_Slice_t t97 = t0 & in[3];
+	DES_Slice_t t98 = t96 ^ t97;
+	DES_Slice_t t99 = t95 ^ t98;
+	DES_Slice_t t100 = t99 & in[0];
+	DES_Slice_t t101 = t95 ^ t100;
+	DES_Slice_t t102 = t93 ^ t101;
+	DES_Slice_t t103 = t102 & in[5];
+	DES_Slice_t t104 = t93 ^ t103;
+	out[0] = t39;
+	out[1] = t66;
+	out[2] = t85;
+	out[3] = t104;
+}
+
+/**
+ * S-box 2: 108 gates. `in` holds its 6 input bits and `out` receives its
+ * 4 output bits, first bits first.
+ */
+static inline void _sBox2(const DES_Slice_t *in, DES_Slice_t *out){
+	DES_Slice_t t0 = ~in[2] ^ in[4];
+	DES_Slice_t t1 = t0 ^ in[5];
+	DES_Slice_t t2 = in[4] & in[3];
+	DES_Slice_t t3 = t1 ^ t2;
+	DES_Slice_t t4 = in[2] ^ in[4];
+	DES_Slice_t t5 = ~in[2] | in[4];
+	DES_Slice_t t6 = t4 ^ t5;
+	DES_Slice_t t7 = t6 & in[5];
+	DES_Slice_t t8 = t4 ^ t7;
+	DES_Slice_t t9 = ~in[2] & ~in[4];
+	DES_Slice_t t10 = t4 ^ t9;
+	DES_Slice_t t11 = t10 & in[5];
+	DES_Slice_t t12 = t4 ^ t11;
+	DES_Slice_t t13 = t8 ^ t12;
+	DES_Slice_t t14 = t13 & in[3];
+	DES_Slice_t t15 = t8 ^ t14;
+	DES_Slice_t t16 = t3 ^ t15;
+	DES_Slice_t t17 = t16 & in[0];
+	DES_Slice_t t18 = t3 ^ t17;
+	DES_Slice_t t19 = in[2] & in[5];
+	DES_Slice_t t20 = ~in[4] ^ t19;
+	DES_Slice_t t21 = t20 ^ in[3];
+	DES_Slice_t t22 = t12 ^ in[3];
+	DES_Slice_t t23 = t21 ^ t22;
+	DES_Slice_t t24 = t23 & in[0];
+	DES_Slice_t t25 = t21 ^ t24;
+	DES_Slice_t t26 = t18 ^ t25;
+	DES_Slice_t t27 = t26 & in[1];
+	DES_Slice_t t28 = t18 ^ t27;
+	DES_Slice_t t29 = ~in[2] & in[5];
+	DES_Slice_t t30 = ~in[4] ^ t29;
+	DES_Slice_t t31 = t9 & in[5];
+	DES_Slice_t t32 = in[4] ^ t31;
+	DES_Slice_t t33 = t30 ^ t32;
+	DES_Slice_t t34 = t33 & in[3];
+	DES_Slice_t t35 = t30 ^ t34;
+	DES_Slice_t t36 = t35 ^ in[0];
+	DES_Slice_t t37 = t4 ^ t29;
+	DES_Slice_t t38 = in[2] & in[4];
+	DES_Slice_t t39 = t7 & in[3];
+	DES_Slice_t t40 = t37 ^ t39;
+	DES_Slice_t t41 = t5 & in[5];
+	DES_Slice_t t42 = t9 ^ t41;
+	DES_Slice_t t43 = t5 ^ t19;
+	DES_Slice_t t44 = t42 ^ t43;
+	DES_Slice_t t45 = t44 & in[3];
+	DES_Slice_t t46 = t42 ^ t45;
+	DES_Slice_t t47 = t40 ^ t46;
+	DES_Slice_t t48 = t47 & in[0];
+	DES_Slice_t t49 = t40 ^ t48;
+	DES_Slice_t t50 = t36 ^ t49;
+	DES_Slice_t t51 = t50 & in[1];
+	DES_Slice_t t52 = t36 ^ t51;
+	DES_Slice_t t53 = t43 & in[3];
+	DES_Slice_t t54 = t6 ^ t53;
+	DES_Slice_t t55 = t4 ^ t13;
+	DES_Slice_t t56 = ~in[4] & in[3];
+	DES_Slice_t t57 = t55 ^ t56;
+	DES_Slice_t t58 = t54 ^ t57;
+	DES_Slice_t t59 = t58 & in[0];
+	DES_Slice_t t60 = t54 ^ t59;
+	DES_Slice_t t61 = ~in[2] & in[4];
+	DES_Slice_t t62 = in[2] & ~in[4];
+	DES_Slice_t t63 = t4 & in[5];
+	DES_Slice_t t64 = t61 ^ t63;
+	DES_Slice_t t65 = t64 ^ t1;
+	DES_Slice_t t66 = t65 & in[3];
+	DES_Slice_t t67 = t64 ^ t66;
+	DES_Slice_t t68 = t38 ^ t41;
+	DES_Slice_t t69 = t4 & in[3];
+	DES_Slice_t t70 = t68 ^ t69;
+	DES_Slice_t t71 = t67 ^ t70;
+	DES_Slice_t t72 = t71 & in[0];
+	DES_Slice_t t73 = t67 ^ t72;
+	DES_Slice_t t74 = t60 ^ t73;
+	DES_Slice_t t75 = t74 & in[1];
+	DES_Slice_t t76 = t60 ^ t75;
+	DES_Slice_t t77 = t62 ^ t63;
+	DES_Slice_t t78 = t43 ^ t77;
+	DES_Slice_t t79 = t78 & in[3];
+	DES_Slice_t t80 = t43 ^ t79;
+	DES_Slice_t t81 = t7 ^ in[3];
+	DES_Slice_t t82 = t80 ^ t81;
+	DES_Slice_t t83 = t82 & in[0];
+	DES_Slice_t t84 = t80 ^ t83;
+	DES_Slice_t t85 = t23 ^ t56;
+	DES_Slice_t t86 = t62 & in[5];
+	DES_Slice_t t87 = t6 ^ t86;
+	DES_Slice_t t88 = t38 ^ t31;
+	DES_Slice_t t89 = t87 ^ t88;
+	DES_Slice_t t90 = t89 & in[3];
+	DES_Slice_t t91 = t87 ^ t90;
+	DES_Slice_t t92 = t85 ^ t91;
+	DES_Slice_t t93 = t92 & in[0];
+	DES_Slice_t t94 = t85 ^ t93;
+	DES_Slice_t t95 = t84 ^ t94;
+	DES_Slice_t t96 = t95 & in[1];
+	DES_Slice_t t97 = t84 ^ t96;
+	out[0] = t28;
+	out[1] = t52;
+	out[2] = t76;
+	out[3] = t97;
+}
+
+/**
+ * S-box 3: 110 gates. `in` holds its 6 input bits and `out` receives its
+ * 4 output bits, first bits first.
+ */
+static inline void _sBox3(const DES_Slice_t *in, DES_Slice_t *out){
+	DES_Slice_t t0 = ~in[4] ^ in[1];
+	DES_Slice_t t1 = ~in[4] | in[5];
+	DES_Slice_t t2 = t1 & in[1];
+	DES_Slice_t t3 = t0 ^ t2;
+	DES_Slice_t t4 = t3 & in[2];
+	DES_Slice_t t5 = t0 ^ t4;
+	DES_Slice_t t6 = in[4] | ~in[5];
+	DES_Slice_t t7 = ~in[4] ^ in[5];
+	DES_Slice_t t8 = t6 ^ t7;
+	DES_Slice_t t9 = t8 & in[1];
+	DES_Slice_t t10 = t6 ^ t9;
+	DES_Slice_t t11 = t7 ^ in[1];
+	DES_Slice_t t12 = t10 ^ t11;
+	DES_Slice_t t13 = t12 & in[2];
+	DES_Slice_t t14 = t10 ^ t13;
+	DES_Slice_t t15 = t5 ^ t14;
+	DES_Slice_t t16 = t15 & in[3];
+	DES_Slice_t t17 = t5 ^ t16;
+	DES_Slice_t t18 = in[4] ^ in[5];
+	DES_Slice_t t19 = t7 ^ t13;
+	DES_Slice_t t20 = t19 ^ in[3];
+	DES_Slice_t t21 = t17 ^ t20;
+	DES_Slice_t t22 = t21 & in[0];
+	DES_Slice_t t23 = t17 ^ t22;
+	DES_Slice_t t24 = in[5] ^ t8;
+	DES_Slice_t t25 = t24 & in[1];
+	DES_Slice_t t26 = in[5] ^ t25;
+	DES_Slice_t t27 = t26 ^ t11;
+	DES_Slice_t t28 = t27 & in[2];
+	DES_Slice_t t29 = t26 ^ t28;
+	DES_Slice_t t30 = ~in[4] | ~in[5];
+	DES_Slice_t t31 = ~in[5] & in[1];
+	DES_Slice_t t32 = t30 ^ t31;
+	DES_Slice_t t33 = t12 ^ t32;
+	DES_Slice_t t34 = t33 & in[2];
+	DES_Slice_t t35 = t12 ^ t34;
+	DES_Slice_t t36 = t29 ^ t35;
+	DES_Slice_t t37 = t36 & in[3];
+	DES_Slice_t t38 = t29 ^ t37;
+	DES_Slice_t t39 = ~in[5] ^ in[1];
+	DES_Slice_t t40 = ~in[4] & in[2];
+	DES_Slice_t t41 = t39 ^ t40;
+	DES_Slice_t t42 = ~in[4] ^ t31;
+	DES_Slice_t t43 = in[4] & in[5];
+	DES_Slice_t t44 = t1 & in[2];
+	DES_Slice_t t45 = t42 ^ t44;
+	DES_Slice_t t46 = t41 ^ t45;
+	DES_Slice_t t47 = t46 & in[3];
+	DES_Slice_t t48 = t41 ^ t47;
+	DES_Slice_t t49 = t38 ^ t48;
+	DES_Slice_t t50 = t49 & in[0];
+	DES_Slice_t t51 = t38 ^ t50;
+	DES_Slice_t t52 = t7 ^ t2;
+	DES_Slice_t t53 = t30 ^ t25;
+	DES_Slice_t t54 = t52 ^ t53;
+	DES_Slice_t t55 = t54 & in[2];
+	DES_Slice_t t56 = t52 ^ t55;
+	DES_Slice_t t57 = t43 & in[1];
+	DES_Slice_t t58 = t8 ^ t57;
+	DES_Slice_t t59 = t58 ^ in[2];
+	DES_Slice_t t60 = t56 ^ t59;
+	DES_Slice_t t61 = t60 & in[3];
+	DES_Slice_t t62 = t56 ^ t61;
+	DES_Slice_t t63 = in[4] ^ t31;
+	DES_Slice_t t64 = t63 ^ t18;
+	DES_Slice_t t65 = t64 & in[2];
+	DES_Slice_t t66 = t63 ^ t65;
+	DES_Slice_t t67 = t7 ^ t25;
+	DES_Slice_t t68 = t2 ^ t67;
+	DES_Slice_t t69 = t68 & in[2];
+	DES_Slice_t t70 = t2 ^ t69;
+	DES_Slice_t t71 = t66 ^ t70;
+	DES_Slice_t t72 = t71 & in[3];
+	DES_Slice_t t73 = t66 ^ t72;
+	DES_Slice_t t74 = t62 ^ t73;
+	DES_Slice_t t75 = t74 & in[0];
+	DES_Slice_t t76 = t62 ^ t75;
+	DES_Slice_t t77 = in[5] ^ in[1];
+	DES_Slice_t t78 = in[4] & in[2];
+	DES_Slice_t t79 = t77 ^ t78;
+	DES_Slice_t t80 = ~in[4] & in[3];
+	DES_Slice_t t81 = t79 ^ t80;
+	DES_Slice_t t82 = t30 & in[1];
+	DES_Slice_t t83 = in[4] ^ t82;
+	DES_Slice_t t84 = t33 ^ t83;
+	DES_Slice_t t85 = t84 & in[2];
+	DES_Slice_t t86 = t33 ^ t85;
+	DES_Slice_t t87 = t18 ^ t25;
+	DES_Slice_t t88 = t6 & in[1];
+	DES_Slice_t t89 = t7 ^ t88;
+	DES_Slice_t t90 = t87 ^ t89;
+	DES_Slice_t t91 = t90 & in[2];
+	DES_Slice_t t92 = t87 ^ t91;
+	DES_Slice_t t93 = t86 ^ t92;
+	DES_Slice_t t94 = t93 & in[3];
+	DES_Slice_t t95 = t86 ^ t94;
+	DES_Slice_t t96 = t81 ^ t95;
+	DES_Slice_t t97 = t96 & in[0];
+	DES_Slice_t t98 = t81 ^ t97;
+	out[0] = t23;
+	out[1] = t51;
+	out[2] = t76;
+	out[3] = t98;
+}
+
+/**
+ * S-box 4: 83 gates. `in` holds its 6 input bits and `out` receives its
+ * 4 output bits, first bits first.
+ */
+static inline void _sBox4(const DES_Slice_t *in, DES_Slice_t *out){
+	DES_Slice_t t0 = ~in[2] & in[4];
+	DES_Slice_t t1 = t0 ^ in[0];
+	DES_Slice_t t2 = in[2] | ~in[4];
+	DES_Slice_t t3 = ~in[2] ^ in[4];
+	DES_Slice_t t4 = t2 ^ t3;
+	DES_Slice_t t5 = t4 & in[0];
+	DES_Slice_t t6 = t2 ^ t5;
+	DES_Slice_t t7 = t1 ^ t6;
+	DES_Slice_t t8 = t7 & in[3];
+	DES_Slice_t t9 = t1 ^ t8;
+	DES_Slice_t t10 = t2 & in[0];
+	DES_Slice_t t11 = in[2] ^ t10;
+	DES_Slice_t t12 = t3 ^ in[0];
+	DES_Slice_t t13 = t11 ^ t12;
+	DES_Slice_t t14 = t13 & in[3];
+	DES_Slice_t t15 = t11 ^ t14;
+	DES_Slice_t t16 = t9 ^ t15;
+	DES_Slice_t t17 = t16 & in[1];
+	DES_Slice_t t18 = t9 ^ t17;
+	DES_Slice_t t19 = ~in[2] | in[4];
+	DES_Slice_t t20 = in[2] ^ in[4];
+	DES_Slice_t t21 = t19 ^ t10;
+	DES_Slice_t t22 = in[4] & in[3];
+	DES_Slice_t t23 = t21 ^ t22;
+	DES_Slice_t t24 = in[2] & in[4];
+	DES_Slice_t t25 = t24 ^ t10;
+	DES_Slice_t t26 = in[2] | in[4];
+	DES_Slice_t t27 = t26 ^ t5;
+	DES_Slice_t t28 = t25 ^ t27;
+	DES_Slice_t t29 = t28 & in[3];
+	DES_Slice_t t30 = t25 ^ t29;
+	DES_Slice_t t31 = t23 ^ t30;
+	DES_Slice_t t32 = t31 & in[1];
+	DES_Slice_t t33 = t23 ^ t32;
+	DES_Slice_t t34 = t18 ^ t33;
+	DES_Slice_t t35 = t34 & in[5];
+	DES_Slice_t t36 = t18 ^ t35;
+	DES_Slice_t t37 = t2 ^ in[0];
+	DES_Slice_t t38 = t37 ^ t8;
+	DES_Slice_t t39 = t20 ^ in[0];
+	DES_Slice_t t40 = t38 ^ t17;
+	DES_Slice_t t41 = t33 ^ t40;
+	DES_Slice_t t42 = t41 & in[5];
+	DES_Slice_t t43 = t33 ^ t42;
+	DES_Slice_t t44 = t0 & in[0];
+	DES_Slice_t t45 = t3 ^ t44;
+	DES_Slice_t t46 = t19 ^ in[0];
+	DES_Slice_t t47 = t45 ^ t46;
+	DES_Slice_t t48 = t47 & in[3];
+	DES_Slice_t t49 = t45 ^ t48;
+	DES_Slice_t t50 = t19 & in[0];
+	DES_Slice_t t51 = t27 & in[3];
+	DES_Slice_t t52 = t39 ^ t51;
+	DES_Slice_t t53 = t49 ^ t52;
+	DES_Slice_t t54 = t53 & in[1];
+	DES_Slice_t t55 = t49 ^ t54;
+	DES_Slice_t t56 = in[2] ^ t50;
+	DES_Slice_t t57 = ~in[4] & in[3];
+	DES_Slice_t t58 = t56 ^ t57;
+	DES_Slice_t t59 = in[4] ^ t44;
+	DES_Slice_t t60 = ~in[4] ^ t50;
+	DES_Slice_t t61 = t59 ^ t60;
+	DES_Slice_t t62 = t61 & in[3];
+	DES_Slice_t t63 = t59 ^ t62;
+	DES_Slice_t t64 = t58 ^ t63;
+	DES_Slice_t t65 = t64 & in[1];
+	DES_Slice_t t66 = t58 ^ t65;
+	DES_Slice_t t67 = t55 ^ t66;
+	DES_Slice_t t68 = t67 & in[5];
+	DES_Slice_t t69 = t55 ^ t68;
+	DES_Slice_t t70 = ~in[2] ^ t50;
+	DES_Slice_t t71 = t70 ^ t57;
+	DES_Slice_t t72 = t71 ^ t65;
+	DES_Slice_t t73 = t72 ^ t55;
+	DES_Slice_t t74 = t73 & in[5];
+	DES_Slice_t t75 = t72 ^ t74;
+	out[0] = t36;
+	out[1] = t43;
+	out[2] = t69;
+	out[3] = t75;
+}
+
+/**
+ * S-box 5: 118 gates. `in` holds its 6 input bits and `out` receives its
+ * 4 output bits, first bits first.
+ */
+static inline void _sBox5(const DES_Slice_t *in, DES_Slice_t *out){
+	DES_Slice_t t0 = ~in[2] & in[5];
+	DES_Slice_t t1 = in[2] ^ in[5];
+	DES_Slice_t t2 = t0 ^ t1;
+	DES_Slice_t t3 = t2 & in[0];
+	DES_Slice_t t4 = t0 ^ t3;
+	DES_Slice_t t5 = in[2] ^ t0;
+	DES_Slice_t t6 = t5 & in[0];
+	DES_Slice_t t7 = in[2] ^ t6;
+	DES_Slice_t t8 = t4 ^ t7;
+	DES_Slice_t t9 = t8 & in[3];
+	DES_Slice_t t10 = t4 ^ t9;
+	DES_Slice_t t11 = ~in[2] | ~in[5];
+	DES_Slice_t t12 = t11 ^ t5;
+	DES_Slice_t t13 = t12 & in[0];
+	DES_Slice_t t14 = t11 ^ t13;
+	DES_Slice_t t15 = t0 ^ in[0];
+	DES_Slice_t t16 = t14 ^ t15;
+	DES_Slice_t t17 = t16 & in[3];
+	DES_Slice_t t18 = t14 ^ t17;
+	DES_Slice_t t19 = t10 ^ t18;
+	DES_Slice_t t20 = t19 & in[4];
+	DES_Slice_t t21 = t10 ^ t20;
+	DES_Slice_t t22 = in[2] & in[0];
+	DES_Slice_t t23 = ~in[5] ^ t22;
+	DES_Slice_t t24 = t5 ^ in[0];
+	DES_Slice_t t25 = t23 ^ t24;
+	DES_Slice_t t26 = t25 & in[3];
+	DES_Slice_t t27 = t23 ^ t26;
+	DES_Slice_t t28 = in[2] & in[5];
+	DES_Slice_t t29 = t28 ^ ~in[2];
+	DES_Slice_t t30 = t29 & in[0];
+	DES_Slice_t t31 = t28 ^ t30;
+	DES_Slice_t t32 = t11 ^ t1;
+	DES_Slice_t t33 = t32 & in[0];
+	DES_Slice_t t34 = t11 ^ t33;
+	DES_Slice_t t35 = t31 ^ t34;
+	DES_Slice_t t36 = t35 & in[3];
+	DES_Slice_t t37 = t31 ^ t36;
+	DES_Slice_t t38 = t27 ^ t37;
+	DES_Slice_t t39 = t38 & in[4];
+	DES_Slice_t t40 = t27 ^ t39;
+	DES_Slice_t t41 = t21 ^ t40;
+	DES_Slice_t t42 = t41 & in[1];
+	DES_Slice_t t43 = t21 ^ t42;
+	DES_Slice_t t44 = t11 & in[3];
+	DES_Slice_t t45 = t24 ^ t44;
+	DES_Slice_t t46 = ~in[5] & in[0];
+	DES_Slice_t t47 = t12 ^ t46;
+	DES_Slice_t t48 = t1 ^ t22;
+	DES_Slice_t t49 = t47 ^ t48;
+	DES_Slice_t t50 = t49 & in[3];
+	DES_Slice_t t51 = t47 ^ t50;
+	DES_Slice_t t52 = t45 ^ t51;
+	DES_Slice_t t53 = t52 & in[4];
+	DES_Slice_t t54 = t45 ^ t53;
+	DES_Slice_t t55 = t1 ^ t33;
+	DES_Slice_t t56 = t6 & in[3];
+	DES_Slice_t t57 = t55 ^ t56;
+	DES_Slice_t t58 = t32 ^ t30;
+	DES_Slice_t t59 = t12 ^ t22;
+	DES_Slice_t t60 = t58 ^ t59;
+	DES_Slice_t t61 = t60 & in[3];
+	DES_Slice_t t62 = t57 ^ t53;
+	DES_Slice_t t63 = t54 ^ t62;
+	DES_Slice_t t64 = t63 & in[1];
+	DES_Slice_t t65 = t54 ^ t64;
+	DES_Slice_t t66 = t58 & in[3];
+	DES_Slice_t t67 = t34 ^ t66;
+	DES_Slice_t t68 = t11 & in[0];
+	DES_Slice_t t69 = t5 ^ t68;
+	DES_Slice_t t70 = in[5] & in[3];
+	DES_Slice_t t71 = t69 ^ t70;
+	DES_Slice_t t72 = t67 ^ t71;
+	DES_Slice_t t73 = t72 & in[4];
+	DES_Slice_t t74 = t67 ^ t73;
+	DES_Slice_t t75 = t60 ^ in[3];
+	DES_Slice_t t76 = t1 & in[0];
+	DES_Slice_t t77 = t29 ^ t68;
+	DES_Slice_t t78 = t76 ^ t77;
+	DES_Slice_t t79 = t78 & in[3];
+	DES_Slice_t t80 = t76 ^ t79;
+	DES_Slice_t t81 = t75 ^ t80;
+	DES_Slice_t t82 = t81 & in[4];
+	DES_Slice_t t83 = t75 ^ t82;
+	DES_Slice_t t84 = t74 ^ t83;
+	DES_Slice_t t85 = t84 & in[1];
+	DES_Slice_t t86 = t74 ^ t85;
+	DES_Slice_t t87 = t2 ^ t6;
+	DES_Slice_t t88 = t87 ^ t61;
+	DES_Slice_t t89 = in[5] ^ t6;
+	DES_Slice_t t90 = t0 & in[0];
+	DES_Slice_t t91 = t12 ^ t90;
+	DES_Slice_t t92 = t89 ^ t91;
+	DES_Slice_t t93 = t92 & in[3];
+	DES_Slice_t t94 = t89 ^ t93;
+	DES_Slice_t t95 = t88 ^ t94;
+	DES_Slice_t t96 = t95 & in[4];
+	DES_Slice_t t97 = t88 ^ t96;
+	DES_Slice_t t98 = ~in[2] ^ t30;
+	DES_Slice_t t99 = t24 ^ t98;
+	DES_Slice_t t100 = t99 & in[3];
+	DES_Slice_t t101 = t24 ^ t100;
+	DES_Slice_t t102 = t12 ^ t6;
+	DES_Slice_t t103 = in[2] & in[3];
+	DES_Slice_t t104 = t102 ^ t103;
+	DES_Slice_t t105 = t101 ^ t104;
+	DES_Slice_t t106 = t105 & in[4];
+	DES_Slice_t t107 = t101 ^ t106;
+	DES_Slice_t t108 = t97 ^ t107;
+	DES_Slice_t t109 = t108 & in[1];
+	DES_Slice_t t110 = t97 ^ t109;
+	out[0] = t43;
+	out[1] = t65;
+	out[2] = t86;
+	out[3] = t110;
+}
+
+/**
+ * S-box 6: 112 gates. `in` holds its 6 input bits and `out` receives its
+ * 4 output bits, first bits first.
+ */
+static inline void _sBox6(const DES_Slice_t *in, DES_Slice_t *out){
+	DES_Slice_t t0 = ~in[4] | in[5];
+	DES_Slice_t t1 = t0 ^ in[1];
+	DES_Slice_t t2 = ~in[4] ^ in[5];
+	DES_Slice_t t3 = t1 ^ t2;
+	DES_Slice_t t4 = t3 & in[2];
+	DES_Slice_t t5 = t1 ^ t4;
+	DES_Slice_t t6 = ~in[5] ^ in[1];
+	DES_Slice_t t7 = in[4] ^ in[5];
+	DES_Slice_t t8 = in[4] & ~in[5];
+	DES_Slice_t t9 = t7 ^ t8;
+	DES_Slice_t t10 = t9 & in[1];
+	DES_Slice_t t11 = t7 ^ t10;
+	DES_Slice_t t12 = t6 ^ t11;
+	DES_Slice_t t13 = t12 & in[2];
+	DES_Slice_t t14 = t6 ^ t13;
+	DES_Slice_t t15 = t5 ^ t14;
+	DES_Slice_t t16 = t15 & in[0];
+	DES_Slice_t t17 = t5 ^ t16;
+	DES_Slice_t t18 = in[5] & in[1];
+	DES_Slice_t t19 = t7 ^ t18;
+	DES_Slice_t t20 = t6 ^ t19;
+	DES_Slice_t t21 = t20 & in[2];
+	DES_Slice_t t22 = t6 ^ t21;
+	DES_Slice_t t23 = t2 ^ t8;
+	DES_Slice_t t24 = t23 & in[1];
+	DES_Slice_t t25 = t2 ^ t24;
+	DES_Slice_t t26 = t25 ^ t0;
+	DES_Slice_t t27 = t26 & in[2];
+	DES_Slice_t t28 = t25 ^ t27;
+	DES_Slice_t t29 = t22 ^ t28;
+	DES_Slice_t t30 = t29 & in[0];
+	DES_Slice_t t31 = t22 ^ t30;
+	DES_Slice_t t32 = t17 ^ t31;
+	DES_Slice_t t33 = t32 & in[3];
+	DES_Slice_t t34 = t17 ^ t33;
+	DES_Slice_t t35 = t2 ^ in[1];
+	DES_Slice_t t36 = ~in[4] & in[2];
+	DES_Slice_t t37 = t35 ^ t36;
+	DES_Slice_t t38 = t7 ^ in[1];
+	DES_Slice_t t39 = in[4] & in[5];
+	DES_Slice_t t40 = t39 ^ t7;
+	DES_Slice_t t41 = t40 & in[1];
+	DES_Slice_t t42 = t39 ^ t41;
+	DES_Slice_t t43 = t38 ^ t42;
+	DES_Slice_t t44 = t43 & in[2];
+	DES_Slice_t t45 = t38 ^ t44;
+	DES_Slice_t t46 = t37 ^ t45;
+	DES_Slice_t t47 = t46 & in[0];
+	DES_Slice_t t48 = t37 ^ t47;
+	DES_Slice_t t49 = t39 & in[1];
+	DES_Slice_t t50 = t7 ^ t49;
+	DES_Slice_t t51 = t50 ^ in[2];
+	DES_Slice_t t52 = t8 & in[1];
+	DES_Slice_t t53 = t23 ^ t52;
+	DES_Slice_t t54 = ~in[4] ^ in[1];
+	DES_Slice_t t55 = t53 ^ t54;
+	DES_Slice_t t56 = t55 & in[2];
+	DES_Slice_t t57 = t53 ^ t56;
+	DES_Slice_t t58 = t51 ^ t57;
+	DES_Slice_t t59 = t58 & in[0];
+	DES_Slice_t t60 = t51 ^ t59;
+	DES_Slice_t t61 = t48 ^ t60;
+	DES_Slice_t t62 = t61 & in[3];
+	DES_Slice_t t63 = t48 ^ t62;
+	DES_Slice_t t64 = in[5] ^ t49;
+	DES_Slice_t t65 = t0 & in[1];
+	DES_Slice_t t66 = t7 ^ t65;
+	DES_Slice_t t67 = t64 ^ t66;
+	DES_Slice_t t68 = t67 & in[2];
+	DES_Slice_t t69 = t64 ^ t68;
+	DES_Slice_t t70 = in[4] ^ t0;
+	DES_Slice_t t71 = t70 & in[1];
+	DES_Slice_t t72 = in[4] ^ t71;
+	DES_Slice_t t73 = t53 & in[2];
+	DES_Slice_t t74 = t72 ^ t73;
+	DES_Slice_t t75 = t69 ^ t74;
+	DES_Slice_t t76 = t75 & in[0];
+	DES_Slice_t t77 = t69 ^ t76;
+	DES_Slice_t t78 = t53 ^ t68;
+	DES_Slice_t t79 = t54 ^ t73;
+	DES_Slice_t t80 = t78 ^ t79;
+	DES_Slice_t t81 = t80 & in[0];
+	DES_Slice_t t82 = t78 ^ t81;
+	DES_Slice_t t83 = t77 ^ t82;
+	DES_Slice_t t84 = t83 & in[3];
+	DES_Slice_t t85 = t77 ^ t84;
+	DES_Slice_t t86 = ~in[1] & in[2];
+	DES_Slice_t t87 = in[4] ^ t86;
+	DES_Slice_t t88 = t2 ^ t18;
+	DES_Slice_t t89 = t88 ^ t21;
+	DES_Slice_t t90 = t87 ^ t89;
+	DES_Slice_t t91 = t90 & in[0];
+	DES_Slice_t t92 = t87 ^ t91;
+	DES_Slice_t t93 = t8 ^ t71;
+	DES_Slice_t t94 = in[5] ^ t24;
+	DES_Slice_t t95 = t93 ^ t94;
+	DES_Slice_t t96 = t95 & in[2];
+	DES_Slice_t t97 = t93 ^ t96;
+	DES_Slice_t t98 = t6 ^ t36;
+	DES_Slice_t t99 = t97 ^ t98;
+	DES_Slice_t t100 = t99 & in[0];
+	DES_Slice_t t101 = t97 ^ t100;
+	DES_Slice_t t102 = t92 ^ t101;
+	DES_Slice_t t103 = t102 & in[3];
+	DES_Slice_t t104 = t92 ^ t103;
+	out[0] = t34;
+	out[1] = t63;
+	out[2] = t85;
+	out[3] = t104;
+}
+
+/**
+ * S-box 7: 107 gates. `in` holds its 6 input bits and `out` receives its
+ * 4 output bits, first bits first.
+ */
+static inline void _sBox7(const DES_Slice_t *in, DES_Slice_t *out){
+	DES_Slice_t t0 = in[1] ^ in[4];
+	DES_Slice_t t1 = in[1] & in[3];
+	DES_Slice_t t2 = in[4] ^ t1;
+	DES_Slice_t t3 = ~in[1] ^ in[4];
+	DES_Slice_t t4 = in[4] & in[3];
+	DES_Slice_t t5 = t3 ^ t4;
+	DES_Slice_t t6 = t2 ^ t5;
+	DES_Slice_t t7 = t6 & in[2];
+	DES_Slice_t t8 = t2 ^ t7;
+	DES_Slice_t t9 = ~in[1] | in[4];
+	DES_Slice_t t10 = in[1] ^ t9;
+	DES_Slice_t t11 = t10 & in[3];
+	DES_Slice_t t12 = in[1] ^ t11;
+	DES_Slice_t t13 = ~in[1] & ~in[4];
+	DES_Slice_t t14 = t13 ^ t11;
+	DES_Slice_t t15 = t12 ^ t14;
+	DES_Slice_t t16 = t15 & in[2];
+	DES_Slice_t t17 = t12 ^ t16;
+	DES_Slice_t t18 = t8 ^ t17;
+	DES_Slice_t t19 = t18 & in[0];
+	DES_Slice_t t20 = t8 ^ t19;
+	DES_Slice_t t21 = ~in[4] ^ t1;
+	DES_Slice_t t22 = t21 ^ in[2];
+	DES_Slice_t t23 = t15 & in[3];
+	DES_Slice_t t24 = t0 ^ t23;
+	DES_Slice_t t25 = in[1] & ~in[4];
+	DES_Slice_t t26 = t25 ^ t23;
+	DES_Slice_t t27 = t24 ^ t26;
+	DES_Slice_t t28 = t27 & in[2];
+	DES_Slice_t t29 = t24 ^ t28;
+	DES_Slice_t t30 = t22 ^ t29;
+	DES_Slice_t t31 = t30 & in[0];
+	DES_Slice_t t32 = t22 ^ t31;
+	DES_Slice_t t33 = t20 ^ t32;
+	DES_Slice_t t34 = t33 & in[5];
+	DES_Slice_t t35 = t20 ^ t34;
+	DES_Slice_t t36 = ~in[1] & in[3];
+	DES_Slice_t t37 = t3 ^ t36;
+	DES_Slice_t t38 = in[1] & in[2];
+	DES_Slice_t t39 = t37 ^ t38;
+	DES_Slice_t t40 = t39 ^ t8;
+	DES_Slice_t t41 = t40 & in[0];
+	DES_Slice_t t42 = t39 ^ t41;
+	DES_Slice_t t43 = in[1] | in[4];
+	DES_Slice_t t44 = t9 & in[3];
+	DES_Slice_t t45 = ~in[4] ^ t44;
+	DES_Slice_t t46 = t13 & in[3];
+	DES_Slice_t t47 = t3 ^ t46;
+	DES_Slice_t t48 = t45 ^ t47;
+	DES_Slice_t t49 = t48 & in[2];
+	DES_Slice_t t50 = t45 ^ t49;
+	DES_Slice_t t51 = t0 ^ t1;
+	DES_Slice_t t52 = t3 ^ t51;
+	DES_Slice_t t53 = t52 & in[2];
+	DES_Slice_t t54 = t3 ^ t53;
+	DES_Slice_t t55 = t50 ^ t54;
+	DES_Slice_t t56 = t55 & in[0];
+	DES_Slice_t t57 = t50 ^ t56;
+	DES_Slice_t t58 = t42 ^ t57;
+	DES_Slice_t t59 = t58 & in[5];
+	DES_Slice_t t60 = t42 ^ t59;
+	DES_Slice_t t61 = t24 ^ in[2];
+	DES_Slice_t t62 = t3 & in[3];
+	DES_Slice_t t63 = in[1] ^ t62;
+	DES_Slice_t t64 = t43 & in[2];
+	DES_Slice_t t65 = t63 ^ t64;
+	DES_Slice_t t66 = t61 ^ t65;
+	DES_Slice_t t67 = t66 & in[0];
+	DES_Slice_t t68 = t61 ^ t67;
+	DES_Slice_t t69 = in[1] ^ in[3];
+	DES_Slice_t t70 = t62 & in[2];
+	DES_Slice_t t71 = t69 ^ t70;
+	DES_Slice_t t72 = ~in[1] ^ t44;
+	DES_Slice_t t73 = t72 ^ in[2];
+	DES_Slice_t t74 = t71 ^ t73;
+	DES_Slice_t t75 = t74 & in[0];
+	DES_Slice_t t76 = t71 ^ t75;
+	DES_Slice_t t77 = t68 ^ t76;
+	DES_Slice_t t78 = t77 & in[5];
+	DES_Slice_t t79 = t68 ^ t78;
+	DES_Slice_t t80 = t0 ^ t4;
+	DES_Slice_t t81 = ~in[4] ^ in[3];
+	DES_Slice_t t82 = t80 ^ t81;
+	DES_Slice_t t83 = t82 & in[2];
+	DES_Slice_t t84 = t80 ^ t83;
+	DES_Slice_t t85 = t84 ^ in[0];
+	DES_Slice_t t86 = t43 & in[3];
+	DES_Slice_t t87 = t3 ^ t86;
+	DES_Slice_t t88 = t87 ^ t83;
+	DES_Slice_t t89 = t43 ^ t11;
+	DES_Slice_t t90 = t89 ^ in[2];
+	DES_Slice_t t91 = t88 ^ t90;
+	DES_Slice_t t92 = t91 & in[0];
+	DES_Slice_t t93 = t88 ^ t92;
+	DES_Slice_t t94 = t85 ^ t93;
+	DES_Slice_t t95 = t94 & in[5];
+	DES_Slice_t t96 = t85 ^ t95;
+	out[0] = t35;
+	out[1] = t60;
+	out[2] = t79;
+	out[3] = t96;
+}
+
+/**
+ * S-box 8: 104 gates. `in` holds its 6 input bits and `out` receives its
+ * 4 output bits, first bits first.
+ */
+static inline void _sBox8(const DES_Slice_t *in, DES_Slice_t *out){
+	DES_Slice_t t0 = in[1] | ~in[4];
+	DES_Slice_t t1 = ~in[1] ^ in[4];
+	DES_Slice_t t2 = t0 ^ t1;
+	DES_Slice_t t3 = t2 & in[3];
+	DES_Slice_t t4 = t0 ^ t3;
+	DES_Slice_t t5 = ~in[1] & in[4];
+	DES_Slice_t t6 = t5 ^ ~in[4];
+	DES_Slice_t t7 = t6 & in[3];
+	DES_Slice_t t8 = t5 ^ t7;
+	DES_Slice_t t9 = t4 ^ t8;
+	DES_Slice_t t10 = t9 & in[2];
+	DES_Slice_t t11 = t4 ^ t10;
+	DES_Slice_t t12 = t5 ^ in[1];
+	DES_Slice_t t13 = t12 & in[3];
+	DES_Slice_t t14 = t5 ^ t13;
+	DES_Slice_t t15 = ~in[4] & in[2];
+	DES_Slice_t t16 = t14 ^ t15;
+	DES_Slice_t t17 = t11 ^ t16;
+	DES_Slice_t t18 = t17 & in[0];
+	DES_Slice_t t19 = t11 ^ t18;
+	DES_Slice_t t20 = in[1] ^ in[4];
+	DES_Slice_t t21 = ~in[1] | in[4];
+	DES_Slice_t t22 = t0 & in[3];
+	DES_Slice_t t23 = t20 ^ t22;
+	DES_Slice_t t24 = t23 ^ in[2];
+	DES_Slice_t t25 = t1 & in[3];
+	DES_Slice_t t26 = in[1] ^ t25;
+	DES_Slice_t t27 = t12 & in[2];
+	DES_Slice_t t28 = t26 ^ t27;
+	DES_Slice_t t29 = t24 ^ t28;
+	DES_Slice_t t30 = t29 & in[0];
+	DES_Slice_t t31 = t24 ^ t30;
+	DES_Slice_t t32 = t19 ^ t31;
+	DES_Slice_t t33 = t32 & in[5];
+	DES_Slice_t t34 = t19 ^ t33;
+	DES_Slice_t t35 = ~in[1] & ~in[4];
+	DES_Slice_t t36 = t21 & in[3];
+	DES_Slice_t t37 = t35 ^ t36;
+	DES_Slice_t t38 = t20 & in[2];
+	DES_Slice_t t39 = t37 ^ t38;
+	DES_Slice_t t40 = t1 ^ t10;
+	DES_Slice_t t41 = t39 ^ t40;
+	DES_Slice_t t42 = t41 & in[0];
+	DES_Slice_t t43 = t39 ^ t42;
+	DES_Slice_t t44 = t12 ^ t36;
+	DES_Slice_t t45 = t44 ^ t38;
+	DES_Slice_t t46 = in[1] ^ in[3];
+	DES_Slice_t t47 = t46 ^ t15;
+	DES_Slice_t t48 = t45 ^ t47;
+	DES_Slice_t t49 = t48 & in[0];
+	DES_Slice_t t50 = t45 ^ t49;
+	DES_Slice_t t51 = t43 ^ t50;
+	DES_Slice_t t52 = t51 & in[5];
+	DES_Slice_t t53 = t43 ^ t52;
+	DES_Slice_t t54 = in[4] & in[3];
+	DES_Slice_t t55 = t20 ^ t54;
+	DES_Slice_t t56 = t55 ^ t15;
+	DES_Slice_t t57 = t21 ^ in[3];
+	DES_Slice_t t58 = t6 & in[2];
+	DES_Slice_t t59 = t57 ^ t58;
+	DES_Slice_t t60 = t56 ^ t59;
+	DES_Slice_t t61 = t60 & in[0];
+	DES_Slice_t t62 = t56 ^ t61;
+	DES_Slice_t t63 = t5 & in[3];
+	DES_Slice_t t64 = t21 ^ t63;
+	DES_Slice_t t65 = t14 ^ t64;
+	DES_Slice_t t66 = t65 & in[2];
+	DES_Slice_t t67 = t14 ^ t66;
+	DES_Slice_t t68 = t20 & in[3];
+	DES_Slice_t t69 = ~in[4] ^ t68;
+	DES_Slice_t t70 = t69 ^ t55;
+	DES_Slice_t t71 = t70 & in[2];
+	DES_Slice_t t72 = t69 ^ t71;
+	DES_Slice_t t73 = t67 ^ t72;
+	DES_Slice_t t74 = t73 & in[0];
+	DES_Slice_t t75 = t67 ^ t74;
+	DES_Slice_t t76 = t62 ^ t75;
+	DES_Slice_t t77 = t76 & in[5];
+	DES_Slice_t t78 = t62 ^ t77;
+	DES_Slice_t t79 = t1 ^ t22;
+	DES_Slice_t t80 = t79 ^ in[2];
+	DES_Slice_t t81 = t80 ^ t30;
+	DES_Slice_t t82 = t64 ^ t8;
+	DES_Slice_t t83 = t82 & in[2];
+	DES_Slice_t t84 = t64 ^ t83;
+	DES_Slice_t t85 = in[1] ^ t68;
+	DES_Slice_t t86 = t20 ^ t85;
+	DES_Slice_t t87 = t86 & in[2];
+	DES_Slice_t t88 = t20 ^ t87;
+	DES_Slice_t t89 = t84 ^ t88;
+	DES_Slice_t t90 = t89 & in[0];
+	DES_Slice_t t91 = t84 ^ t90;
+	DES_Slice_t t92 = t81 ^ t91;
+	DES_Slice_t t93 = t92 & in[5];
+	DES_Slice_t t94 = t81 ^ t93;
+	out[0] = t34;
+	out[1] = t53;
+	out[2] = t78;
+	out[3] = t94;
+}
@@ -6,9 +6,13 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <tap.h>
 
 #include "src/des.h"
+#include "src/des_bitslice.h"
+#include "src/des_keysearch.h"
+#include "src/des_modes.h"
 
 /**
  * @brief Define a unit-test for a function. Saves on boilerplate code.
@@ -72,6 +76,434 @@ DEF_UNIT_TEST(
 	ok(matches, "Plaintext matches expected.");
 )
 
+/**
+ * Test `DES_encipherBlock()` and `DES_decipherBlock()` with a reused key
+ * schedule.
+ */
+DEF_UNIT_TEST(
+	DES_initKey,
+	const Byte_t key[] = {0xa0, 0x84, 0xe4, 0xf8, 0x9a, 0xb9, 0xcd, 0x1e},
+		plaintext[] = {0xb1, 0x43, 0x17, 0x68, 0x4f, 0xc5, 0x3b, 0xd0},
+		expected[] = {0x87, 0x8C, 0x14, 0xCF, 0xCC, 0xD1, 0xFF, 0x8C};
+	DES_Key_t schedule;
+	DES_initKey(&schedule, key);
+
+	for(int round = 0; round < 2; round++){
+		Byte_t ciphertext[8], plaintext2[8];
+		DES_encipherBlock(plaintext, ciphertext, &schedule);
+		ok(
+			memcmp(ciphertext, expected, 8) == 0,
+			"Ciphertext %d matches expected.", round
+		);
+
+		DES_decipherBlock(ciphertext, plaintext2, &schedule);
+		ok(
+			memcmp(plaintext2, plaintext, 8) == 0,
+			"Plaintext %d matches expected.", round
+		);
+	}
+
+	Byte_t block[8];
+	memcpy(block, plaintext, 8);
+	DES_encipherBlock(block, block, &schedule);
+	ok(memcmp(block, expected, 8) == 0, "In-place encryption works.");
+	DES_decipherBlock(block, block, &schedule);
+	ok(memcmp(block, plaintext, 8) == 0, "In-place decryption works.");
+)
+
+/**
+ * Test `DES_encipherBitsliced()` and `DES_decipherBitsliced()` against
+ * `DES_encipherBlock()`, over a few full batches and a partial one.
+ */
+DEF_UNIT_TEST(
+	DES_encipherBitsliced,
+	const Byte_t key[] = {0xa0, 0x84, 0xe4, 0xf8, 0x9a, 0xb9, 0xcd, 0x1e};
+	DES_Key_t schedule;
+	DES_BitsliceKey_t bitsliceSchedule;
+	DES_initKey(&schedule, key);
+	DES_initBitsliceKey(&bitsliceSchedule, &schedule);
+
+	enum {NUM_BLOCKS = 2 * DES_SLICE_BITS + 5};
+	static Byte_t plaintext[NUM_BLOCKS * 8], expected[NUM_BLOCKS * 8],
+		blocks[NUM_BLOCKS * 8];
+	for(int byte = 0; byte < NUM_BLOCKS * 8; byte++){
+		plaintext[byte] = byte * 31 + 7;
+	}
+
+	for(int block = 0; block < NUM_BLOCKS; block++){
+		DES_encipherBlock(
+			plaintext + block * 8, expected + block * 8, &schedule
+		);
+	}
+
+	DES_encipherBitsliced(plaintext, blocks, NUM_BLOCKS, &bitsliceSchedule);
+	ok(
+		memcmp(blocks, expected, sizeof(blocks)) == 0,
+		"Ciphertext matches DES_encipherBlock()."
+	);
+
+	DES_decipherBitsliced(blocks, blocks, NUM_BLOCKS, &bitsliceSchedule);
+	ok(
+		memcmp(blocks, plaintext, sizeof(blocks)) == 0,
+		"In-place decryption restores the plaintext."
+	);
+)
+
+/**
+ * Test `DES_encipherECB()`, `DES_encipherCBC()` and their inverses, using the
+ * example from FIPS 81 (which the padding block is appended to).
+ */
+DEF_UNIT_TEST(
+	DES_encipherCBC,
+	const Byte_t key[] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef},
+		iv[] = {0x12, 0x34, 0x56, 0x78, 0x90, 0xab, 0xcd, 0xef},
+		plaintext[] = "Now is the time for all ",
+		expectedECB[] = {
+			0x3f, 0xa4, 0x0e, 0x8a, 0x98, 0x4d, 0x48, 0x15,
+			0x6a, 0x27, 0x17, 0x87, 0xab, 0x88, 0x83, 0xf9,
+			0x89, 0x3d, 0x51, 0xec, 0x4b, 0x56, 0x3b, 0x53
+		},
+		expectedCBC[] = {
+			0xe5, 0xc7, 0xcd, 0xde, 0x87, 0x2b, 0xf2, 0x7c,
+			0x43, 0xe9, 0x34, 0x00, 0x8c, 0x38, 0x9c, 0x0f,
+			0x68, 0x37, 0x88, 0x49, 0x9a, 0x7c, 0x05, 0xf6
+		};
+	DES_Key_t schedule;
+	DES_initKey(&schedule, key);
+
+	Byte_t buffer[32];
+	size_t length = DES_encipherECB(plaintext, buffer, 24, &schedule), length2;
+	ok(
+		length == 32 && memcmp(buffer, expectedECB, 24) == 0,
+		"ECB ciphertext matches expected."
+	);
+	ok(
+		DES_decipherECB(buffer, buffer, length, &schedule, &length2) &&
+			length2 == 24 && memcmp(buffer, plaintext, 24) == 0,
+		"ECB plaintext matches expected."
+	);
+
+	length = DES_encipherCBC(plaintext, buffer, 24, &schedule, iv);
+	ok(
+		length == 32 && memcmp(buffer, expectedCBC, 24) == 0,
+		"CBC ciphertext matches expected."
+	);
+	ok(
+		DES_decipherCBC(buffer, buffer, length, &schedule, iv, &length2) &&
+			length2 == 24 && memcmp(buffer, plaintext, 24) == 0,
+		"CBC plaintext matches expected."
+	);
+
+	length = DES_encipherCBC(plaintext, buffer, 13, &schedule, iv);
+	ok(
+		length == 16 &&
+			DES_decipherCBC(buffer, buffer, length, &schedule, iv, &length2) &&
+			length2 == 13 && memcmp(buffer, plaintext, 13) == 0,
+		"CBC with a partial block round-trips."
+	);
+
+	Byte_t pieces[32], chain[8];
+	memcpy(chain, iv, 8);
+	DES_encipherCBCBlocks(plaintext, pieces, 16, &schedule, chain);
+	length = 16 + DES_encipherCBC(
+		plaintext + 16, pieces + 16, 8, &schedule, chain
+	);
+	DES_encipherCBC(plaintext, buffer, 24, &schedule, iv);
+	ok(
+		length == 32 && memcmp(pieces, buffer, 32) == 0,
+		"CBC in pieces matches CBC at once."
+	);
+
+	memcpy(chain, iv, 8);
+	DES_decipherCBCBlocks(pieces, pieces, 8, &schedule, chain);
+	ok(
+		DES_decipherCBC(
+			pieces + 8, pieces + 8, 24, &schedule, chain, &length2
+		) && length2 == 16 && memcmp(pieces, plaintext, 24) == 0,
+		"CBC decryption in pieces matches expected."
+	);
+
+	length = DES_encipherCBC(plaintext, buffer, 13, &schedule, iv);
+	buffer[15] ^= 0x01;
+	ok(
+		!DES_decipherCBC(buffer, buffer, length, &schedule, iv, &length2),
+		"Invalid padding is rejected."
+	);
+	ok(
+		!DES_decipherECB(buffer, buffer, 12, &schedule, &length2),
+		"Partial ciphertext blocks are rejected."
+	);
+)
+
+/**
+ * Test `DES_encipherECB()`, `DES_decipherECB()` and `DES_cryptCTR()` on
+ * buffers long enough for several bitsliced batches, against
+ * `DES_encipherBlock()` a block at a time.
+ */
+DEF_UNIT_TEST(
+	DES_encipherECB,
+	const Byte_t key[] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef},
+		iv[] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x80};
+	DES_Key_t schedule;
+	DES_initKey(&schedule, key);
+
+	size_t length = 3 * 8 * DES_SLICE_BITS + 13,
+		paddedLength = DES_paddedLength(length), plaintextLength;
+	Byte_t *plaintext = malloc(paddedLength), *expected = malloc(paddedLength),
+		*buffer = malloc(paddedLength);
+	for(size_t byte = 0; byte < length; byte++){
+		plaintext[byte] = byte * 13;
+	}
+
+	// Pad a copy of the plaintext by hand.
+	memcpy(expected, plaintext, length);
+	memset(expected + length, paddedLength - length, paddedLength - length);
+	for(size_t offset = 0; offset < paddedLength; offset += 8){
+		DES_encipherBlock(expected + offset, expected + offset, &schedule);
+	}
+	ok(
+		DES_encipherECB(plaintext, buffer, length, &schedule) ==
+			paddedLength && memcmp(buffer, expected, paddedLength) == 0,
+		"ECB ciphertext matches a block at a time."
+	);
+	ok(
+		DES_decipherECB(
+			buffer, buffer, paddedLength, &schedule, &plaintextLength
+		) && plaintextLength == length &&
+			memcmp(buffer, plaintext, length) == 0,
+		"ECB decryption in place restores the plaintext."
+	);
+
+	uint64_t counter = 0;
+	for(int byte = 0; byte < 8; byte++){
+		counter = counter << 8 | iv[byte];
+	}
+	for(size_t offset = 0; offset < length; offset += 8, counter++){
+		Byte_t keystream[8];
+		for(int byte = 0; byte < 8; byte++){
+			keystream[byte] = counter >> (56 - 8 * byte);
+		}
+		DES_encipherBlock(keystream, keystream, &schedule);
+		for(size_t byte = 0; byte < 8 && offset + byte < length; byte++){
+			expected[offset + byte] =
+				plaintext[offset + byte] ^ keystream[byte];
+		}
+	}
+
+	// Split off a few blocks, so that the batches start at an odd counter.
+	DES_cryptCTR(plaintext, buffer, 40, &schedule, iv, 0);
+	DES_cryptCTR(plaintext + 40, buffer + 40, length - 40, &schedule, iv, 5);
+	ok(
+		memcmp(buffer, expected, length) == 0,
+		"CTR output matches a block at a time, across the counter wrapping."
+	);
+
+	free(plaintext);
+	free(expected);
+	free(buffer);
+)
+
+/**
+ * Test `DES_cryptCTR()`.
+ */
+DEF_UNIT_TEST(
+	DES_cryptCTR,
+	const Byte_t key[] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef},
+		iv[] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe};
+	DES_Key_t schedule;
+	DES_initKey(&schedule, key);
+
+	Byte_t plaintext[37], whole[37], pieces[37];
+	for(int byte = 0; byte < 37; byte++){
+		plaintext[byte] = byte;
+	}
+
+	DES_cryptCTR(plaintext, whole, 37, &schedule, iv, 0);
+	Byte_t counter[8] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+	DES_encipherBlock(counter, counter, &schedule);
+	ok(
+		(whole[8] ^ counter[0]) == 8,
+		"Second block is XOR'd with the encrypted, incremented counter."
+	);
+
+	DES_cryptCTR(plaintext, pieces, 16, &schedule, iv, 0);
+	DES_cryptCTR(plaintext + 16, pieces + 16, 21, &schedule, iv, 2);
+	ok(
+		memcmp(whole, pieces, 37) == 0,
+		"Processing in pieces matches processing at once."
+	);
+
+	DES_cryptCTR(whole, whole, 37, &schedule, iv, 0);
+	ok(memcmp(whole, plaintext, 37) == 0, "Decryption restores the plaintext.");
+)
+
+/**
+ * Test `DES_cryptCTRParallel()` against `DES_cryptCTR()`, on a buffer big
+ * enough to be split between threads.
+ */
+DEF_UNIT_TEST(
+	DES_cryptCTRParallel,
+	const Byte_t key[] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef},
+		iv[] = {0x12, 0x34, 0x56, 0x78, 0x90, 0xab, 0xcd, 0xef};
+	DES_Key_t schedule;
+	DES_initKey(&schedule, key);
+
+	size_t length = 1024 * 1024 + 5;
+	Byte_t *plaintext = malloc(length), *expected = malloc(length),
+		*buffer = malloc(length);
+	for(size_t byte = 0; byte < length; byte++){
+		plaintext[byte] = byte * 7;
+	}
+
+	DES_cryptCTR(plaintext, expected, length, &schedule, iv, 3);
+	DES_cryptCTRParallel(plaintext, buffer, length, &schedule, iv, 3, 4);
+	ok(
+		memcmp(buffer, expected, length) == 0,
+		"Result matches DES_cryptCTR()."
+	);
+
+	DES_cryptCTRParallel(buffer, buffer, length, &schedule, iv, 3, 4);
+	ok(
+		memcmp(buffer, plaintext, length) == 0,
+		"In-place decryption restores the plaintext."
+	);
+	free(plaintext);
+	free(expected);
+	free(buffer);
+)
+
+/**
+ * Test `TDES_encipherBlock()` and `TDES_decipherBlock()` with three keys (the
+ * example from NIST SP 800-67) and two keys.
+ */
+DEF_UNIT_TEST(
+	TDES_encipherBlock,
+	const Byte_t key1[] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef},
+		key2[] = {0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef, 0x01},
+		key3[] = {0x45, 0x67, 0x89, 0xab, 0xcd, 0xef, 0x01, 0x23},
+		plaintext[] = "The qufck brown fox jump",
+		expected3Key[] = {
+			0xa8, 0x26, 0xfd, 0x8c, 0xe5, 0x3b, 0x85, 0x5f,
+			0xcc, 0xe2, 0x1c, 0x81, 0x12, 0x25, 0x6f, 0xe6,
+			0x68, 0xd5, 0xc0, 0x5d, 0xd9, 0xb6, 0xb9, 0x00
+		},
+		expected2Key[] = {
+			0xc4, 0x48, 0x62, 0xf7, 0x0c, 0xf2, 0xfb, 0xdc,
+			0x90, 0x77, 0xd0, 0x90, 0x9f, 0xa9, 0x1b, 0x88,
+			0x4c, 0xab, 0xd6, 0x1f, 0xc5, 0x8e, 0x0c, 0xbb
+		};
+	TDES_Key_t schedule;
+	Byte_t blocks[24];
+
+	TDES_initKey(&schedule, key1, key2, key3);
+	for(int block = 0; block < 24; block += 8){
+		TDES_encipherBlock(plaintext + block, blocks + block, &schedule);
+	}
+	ok(
+		memcmp(blocks, expected3Key, 24) == 0,
+		"Three-key ciphertext matches expected."
+	);
+
+	for(int block = 0; block < 24; block += 8){
+		TDES_decipherBlock(blocks + block, blocks + block, &schedule);
+	}
+	ok(
+		memcmp(blocks, plaintext, 24) == 0,
+		"Three-key plaintext matches expected."
+	);
+
+	TDES_initKey(&schedule, key1, key2, NULL);
+	for(int block = 0; block < 24; block += 8){
+		TDES_encipherBlock(plaintext + block, blocks + block, &schedule);
+	}
+	ok(
+		memcmp(blocks, expected2Key, 24) == 0,
+		"Two-key ciphertext matches expected."
+	);
+
+	// With one key repeated, Triple-DES is equivalent to DES.
+	DES_Key_t desSchedule;
+	Byte_t expectedDES[8];
+	DES_initKey(&desSchedule, key1);
+	DES_encipherBlock(plaintext, expectedDES, &desSchedule);
+	TDES_initKey(&schedule, key1, key1, key1);
+	TDES_encipherBlock(plaintext, blocks, &schedule);
+	ok(
+		memcmp(blocks, expectedDES, 8) == 0,
+		"Single-key ciphertext matches DES."
+	);
+)
+
+/**
+ * Test `TDES_encipherCBC()` and `TDES_cryptCTR()`.
+ */
+DEF_UNIT_TEST(
+	TDES_encipherCBC,
+	const Byte_t key1[] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef},
+		key2[] = {0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef, 0x01},
+		key3[] = {0x45, 0x67, 0x89, 0xab, 0xcd, 0xef, 0x01, 0x23},
+		iv[] = {0x12, 0x34, 0x56, 0x78, 0x90, 0xab, 0xcd, 0xef},
+		plaintext[] = "The qufck brown fox jump",
+		expected[] = {
+			0x38, 0x41, 0x3d, 0x4b, 0xa2, 0x32, 0x5c, 0xf1,
+			0x14, 0x1f, 0x70, 0x74, 0x71, 0xac, 0x2c, 0xed,
+			0x57, 0xdb, 0x53, 0x0f, 0x01, 0x23, 0xb5, 0xac
+		};
+	TDES_Key_t schedule;
+	TDES_initKey(&schedule, key1, key2, key3);
+
+	Byte_t buffer[32];
+	size_t length = TDES_encipherCBC(plaintext, buffer, 24, &schedule, iv),
+		length2;
+	ok(
+		length == 32 && memcmp(buffer, expected, 24) == 0,
+		"CBC ciphertext matches expected."
+	);
+	ok(
+		TDES_decipherCBC(buffer, buffer, length, &schedule, iv, &length2) &&
+			length2 == 24 && memcmp(buffer, plaintext, 24) == 0,
+		"CBC plaintext matches expected."
+	);
+
+	TDES_cryptCTR(plaintext, buffer, 21, &schedule, iv, 0);
+	TDES_cryptCTR(buffer, buffer, 21, &schedule, iv, 0);
+	ok(memcmp(buffer, plaintext, 21) == 0, "CTR round-trips.");
+)
+
+/**
+ * Test `DES_searchKey()`, over 19 scattered key bits.
+ */
+DEF_UNIT_TEST(
+	DES_searchKey,
+	const Byte_t key[] = {0x13, 0x34, 0x57, 0x79, 0x9b, 0xbc, 0xdf, 0xf1};
+	DES_KeySearch_t search = {
+		.plaintext = {0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef},
+		.ciphertext = {0x85, 0xe8, 0x13, 0x54, 0x0f, 0x0a, 0xb4, 0x05},
+		.mask = {0x0e, 0x00, 0xfe, 0x00, 0x00, 0x3e, 0x00, 0xf0},
+		.start = 3,
+		.numThreads = 2
+	};
+	for(int byte = 0; byte < 8; byte++){
+		search.baseKey[byte] = key[byte] & ~search.mask[byte];
+	}
+	search.end = DES_numCandidates(&search);
+	ok(search.end == (uint64_t)1 << 19, "Counts the candidates.");
+
+	Byte_t found[8], candidate[8];
+	bool isFound = DES_searchKey(&search, found);
+	ok(isFound && memcmp(found, key, 8) == 0, "Finds the key.");
+	uint64_t index = search.start - 1;
+	DES_candidateKey(&search, index, candidate);
+	ok(memcmp(candidate, key, 8) == 0, "Resumes after the key found.");
+	isFound = DES_searchKey(&search, found);
+	ok(!isFound && search.start == search.end, "Resuming finds no other key.");
+
+	search.start = 0;
+	search.end = index;
+	isFound = DES_searchKey(&search, found);
+	ok(!isFound && search.start == index, "Misses the key outside the range.");
+)
+
 /**
  * Test `_generateSubkeys()`.
  */
@@ -110,6 +542,25 @@ DEF_UNIT_TEST(
 	}
 )
 
+/**
+ * Test `_expansionPermutation()`, using the first two rounds of the
+ * `_generateSubkeys()` test key's well-known worked example.
+ */
+DEF_UNIT_TEST(
+	_expansionPermutation,
+	const Byte_t subkey1[] = {0x1b, 0x2, 0xef, 0xfc, 0x70, 0x72},
+		subkey2[] = {0x79, 0xae, 0xd9, 0xdb, 0xc9, 0xe5},
+		expected1[] = {0xef, 0x4a, 0x65, 0x44},
+		expected2[] = {0xcc, 0x01, 0x77, 0x09};
+	Byte_t left[] = {0xcc, 0x00, 0xcc, 0xff},
+		right[] = {0xf0, 0xaa, 0xf0, 0xaa};
+
+	_expansionPermutation(left, right, subkey1);
+	ok(memcmp(left, expected1, 4) == 0, "Round 1 matches expected.");
+	_expansionPermutation(right, left, subkey2);
+	ok(memcmp(right, expected2, 4) == 0, "Round 2 matches expected.");
+)
+
 /**
  * Test `_rotLeft()`.
  */
@@ -145,9 +596,19 @@ DEF_UNIT_TEST(
 int main(){
 	note("Begin unit tests.");
 	EXEC_UNIT_TEST(_generateSubkeys);
+	EXEC_UNIT_TEST(_expansionPermutation);
 	EXEC_UNIT_TEST(_rotLeft);
 	EXEC_UNIT_TEST(DES_encipher);
 	EXEC_UNIT_TEST(DES_decipher);
+	EXEC_UNIT_TEST(DES_initKey);
+	EXEC_UNIT_TEST(DES_encipherBitsliced);
+	EXEC_UNIT_TEST(DES_encipherCBC);
+	EXEC_UNIT_TEST(DES_encipherECB);
+	EXEC_UNIT_TEST(DES_cryptCTR);
+	EXEC_UNIT_TEST(DES_cryptCTRParallel);
+	EXEC_UNIT_TEST(TDES_encipherBlock);
+	EXEC_UNIT_TEST(TDES_encipherCBC);
+	EXEC_UNIT_TEST(DES_searchKey);
 	done_testing();
 	return EXIT_SUCCESS;
 }
@@ -0,0 +1,348 @@
+/**
+ * Measure the throughput of the DES implementations, from the key schedules
+ * to the modes of operation, across buffer sizes from 64 bytes up to 1GiB:
+ *
+ *     des_bench [-m MAX_BYTES] [-t THREADS] [FILTER]
+ *
+ * Results are printed as CSV, one row per benchmark and buffer size, so that
+ * runs from different builds can be diffed or plotted. `MAX_BYTES` (which may
+ * end in `K`, `M` or `G`) caps the buffer size, and `FILTER` limits the run to
+ * benchmarks whose name contains it.
+ *
+ * Cycles are read from the time-stamp counter on x86, which ticks at the
+ * processor's nominal frequency rather than its actual one; the columns are
+ * left empty on other architectures.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAS_CYCLE_COUNTER
+#endif
+
+#include "src/des_bitslice.h"
+#include "src/des_modes.h"
+
+/**
+ * Each measurement is repeated, doubling the number of calls, until it takes
+ * at least this long.
+ */
+#define MIN_SECONDS 0.1
+
+/**
+ * Everything a benchmark needs besides its buffer.
+ */
+typedef struct {
+	Byte_t keyBytes[24];
+	Byte_t iv[8];
+	DES_Key_t key;
+	TDES_Key_t tripleKey;
+	DES_BitsliceKey_t bitsliceKey;
+	int numThreads;
+} _Context_t;
+
+/**
+ * A benchmark: one call of `run` processes `length` bytes of `buffer` in
+ * place, which has 8 bytes of room after it for padding. Key schedules ignore
+ * the buffer, and are only run once rather than once per buffer size.
+ */
+typedef struct {
+	const char *name;
+	void (*run)(Byte_t *buffer, size_t length, _Context_t *context);
+	bool isKeySchedule;
+} _Benchmark_t;
+
+static void _benchInitKey(Byte_t *buffer, size_t length, _Context_t *context);
+
+static void _benchInitTripleKey(
+	Byte_t *buffer, size_t length, _Context_t *context
+);
+
+static void _benchInitBitsliceKey(
+	Byte_t *buffer, size_t length, _Context_t *context
+);
+
+static void _benchBlocks(Byte_t *buffer, size_t length, _Context_t *context);
+
+static void _benchTripleBlocks(
+	Byte_t *buffer, size_t length, _Context_t *context
+);
+
+static void _benchBitsliced(
+	Byte_t *buffer, size_t length, _Context_t *context
+);
+
+static void _benchECB(Byte_t *buffer, size_t length, _Context_t *context);
+
+static void _benchCBC(Byte_t *buffer, size_t length, _Context_t *context);
+
+static void _benchCTR(Byte_t *buffer, size_t length, _Context_t *context);
+
+static void _benchCTRParallel(
+	Byte_t *buffer, size_t length, _Context_t *context
+);
+
+static void _benchTripleCBC(
+	Byte_t *buffer, size_t length, _Context_t *context
+);
+
+static const _Benchmark_t benchmarks[] = {
+	{"DES_initKey", _benchInitKey, true},
+	{"TDES_initKey", _benchInitTripleKey, true},
+	{"DES_initBitsliceKey", _benchInitBitsliceKey, true},
+	{"DES_encipherBlock", _benchBlocks, false},
+	{"TDES_encipherBlock", _benchTripleBlocks, false},
+	{"DES_encipherBitsliced", _benchBitsliced, false},
+	{"DES_encipherECB", _benchECB, false},
+	{"DES_encipherCBC", _benchCBC, false},
+	{"DES_cryptCTR", _benchCTR, false},
+	{"DES_cryptCTRParallel", _benchCTRParallel, false},
+	{"TDES_encipherCBC", _benchTripleCBC, false}
+};
+
+/**
+ * Call `benchmark` on `length` bytes of `buffer` repeatedly, until it has run
+ * for at least `MIN_SECONDS`, and print the result as a CSV row.
+ */
+static void _measure(
+	const _Benchmark_t *benchmark, Byte_t *buffer, size_t length,
+	_Context_t *context
+);
+
+/**
+ * Read the cycle counter, or return 0 where there isn't one.
+ */
+static uint64_t _cycles(void);
+
+/**
+ * Return a monotonic time, in seconds.
+ */
+static double _seconds(void);
+
+/**
+ * Parse a size such as `4096`, `64K` or `1G`. Return 0 if it's malformed.
+ */
+static size_t _parseSize(const char *size);
+
+int main(int argc, char **argv){
+	const char *usage = "Usage: des_bench [-m MAX_BYTES] [-t THREADS] "
+		"[FILTER]\n";
+	size_t maxLength = (size_t)1 << 30;
+	_Context_t context = {.numThreads = sysconf(_SC_NPROCESSORS_ONLN)};
+	int option;
+	while((option = getopt(argc, argv, "m:t:")) != -1){
+		if(option == 'm' && (maxLength = _parseSize(optarg)) >= 64){
+			continue;
+		}
+		else if(option != 't' || (context.numThreads = atoi(optarg)) <= 0){
+			fputs(usage, stderr);
+			return 1;
+		}
+	}
+
+	if(argc - optind > 1){
+		fputs(usage, stderr);
+		return 1;
+	}
+	const char *filter = (optind < argc) ? argv[optind] : "";
+
+	// Touch every page up front, so that page faults aren't measured.
+	Byte_t *buffer = malloc(maxLength + 8);
+	if(buffer == NULL){
+		fprintf(stderr, "Failed to allocate %zu bytes.\n", maxLength + 8);
+		return 1;
+	}
+	for(size_t byte = 0; byte < maxLength + 8; byte++){
+		buffer[byte] = byte * 0x9e + 0x37;
+	}
+
+	memcpy(context.keyBytes, buffer, 24);
+	memcpy(context.iv, buffer + 24, 8);
+	DES_initKey(&context.key, context.keyBytes);
+	TDES_initKey(
+		&context.tripleKey, context.keyBytes, context.keyBytes + 8,
+		context.keyBytes + 16
+	);
+	DES_initBitsliceKey(&context.bitsliceKey, &context.key);
+
+	puts(
+		"benchmark,bytes,calls,ns_per_call,cycles_per_call,cycles_per_byte,"
+		"mb_per_s"
+	);
+	int numBenchmarks = sizeof(benchmarks) / sizeof(benchmarks[0]);
+	for(int index = 0; index < numBenchmarks; index++){
+		const _Benchmark_t *benchmark = &benchmarks[index];
+		if(strstr(benchmark->name, filter) == NULL){
+			continue;
+		}
+
+		if(benchmark->isKeySchedule){
+			_measure(benchmark, buffer, 0, &context);
+			continue;
+		}
+
+		for(size_t length = 64; length <= maxLength; length *= 16){
+			_measure(benchmark, buffer, length, &context);
+		}
+	}
+
+	free(buffer);
+	return EXIT_SUCCESS;
+}
+
+static void _benchInitKey(Byte_t *buffer, size_t length, _Context_t *context){
+	(void)buffer;
+	(void)length;
+	DES_initKey(&context->key, context->keyBytes);
+}
+
+static void _benchInitTripleKey(
+	Byte_t *buffer, size_t length, _Context_t *context
+){
+	(void)buffer;
+	(void)length;
+	TDES_initKey(
+		&context->tripleKey, context->keyBytes, context->keyBytes + 8,
+		context->keyBytes + 16
+	);
+}
+
+static void _benchInitBitsliceKey(
+	Byte_t *buffer, size_t length, _Context_t *context
+){
+	(void)buffer;
+	(void)length;
+	DES_initBitsliceKey(&context->bitsliceKey, &context->key);
+}
+
+static void _benchBlocks(Byte_t *buffer, size_t length, _Context_t *context){
+	for(size_t block = 0; block < length; block += 8){
+		DES_encipherBlock(buffer + block, buffer + block, &context->key);
+	}
+}
+
+static void _benchTripleBlocks(
+	Byte_t *buffer, size_t length, _Context_t *context
+){
+	for(size_t block = 0; block < length; block += 8){
+		TDES_encipherBlock(buffer + block, buffer + block, &context->tripleKey);
+	}
+}
+
+static void _benchBitsliced(
+	Byte_t *buffer, size_t length, _Context_t *context
+){
+	DES_encipherBitsliced(buffer, buffer, length / 8, &context->bitsliceKey);
+}
+
+static void _benchECB(Byte_t *buffer, size_t length, _Context_t *context){
+	DES_encipherECB(buffer, buffer, length, &context->key);
+}
+
+static void _benchCBC(Byte_t *buffer, size_t length, _Context_t *context){
+	DES_encipherCBC(buffer, buffer, length, &context->key, context->iv);
+}
+
+static void _benchCTR(Byte_t *buffer, size_t length, _Context_t *context){
+	DES_cryptCTR(buffer, buffer, length, &context->key, context->iv, 0);
+}
+
+static void _benchCTRParallel(
+	Byte_t *buffer, size_t length, _Context_t *context
+){
+	DES_cryptCTRParallel(
+		buffer, buffer, length, &context->key, context->iv, 0,
+		context->numThreads
+	);
+}
+
+static void _benchTripleCBC(
+	Byte_t *buffer, size_t length, _Context_t *context
+){
+	TDES_encipherCBC(buffer, buffer, length, &context->tripleKey, context->iv);
+}
+
+static void _measure(
+	const _Benchmark_t *benchmark, Byte_t *buffer, size_t length,
+	_Context_t *context
+){
+	uint64_t numCalls = 1, cycles;
+	double elapsed;
+	while(true){
+		double start = _seconds();
+		uint64_t startCycles = _cycles();
+		for(uint64_t call = 0; call < numCalls; call++){
+			benchmark->run(buffer, length, context);
+		}
+		cycles = _cycles() - startCycles;
+		elapsed = _seconds() - start;
+
+		if(elapsed >= MIN_SECONDS){
+			break;
+		}
+		numCalls *= 2;
+	}
+
+	double nsPerCall = elapsed * 1e9 / numCalls;
+	printf(
+		"%s,%zu,%llu,%.1f,", benchmark->name, length,
+		(unsigned long long)numCalls, nsPerCall
+	);
+#ifdef HAS_CYCLE_COUNTER
+	printf("%.1f,", (double)cycles / numCalls);
+	if(length > 0){
+		printf("%.2f", (double)cycles / numCalls / length);
+	}
+#else
+	(void)cycles;
+	printf(",");
+#endif
+	if(length > 0){
+		printf(",%.2f\n", length / (nsPerCall / 1e9) / 1e6);
+	}
+	else {
+		printf(",\n");
+	}
+	fflush(stdout);
+}
+
+static uint64_t _cycles(void){
+#ifdef HAS_CYCLE_COUNTER
+	return __rdtsc();
+#else
+	return 0;
+#endif
+}
+
+static double _seconds(void){
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static size_t _parseSize(const char *size){
+	char *end;
+	unsigned long long value = strtoull(size, &end, 10);
+	if(end == size){
+		return 0;
+	}
+
+	const char *suffixes = "KMG";
+	if(*end != '\0'){
+		const char *suffix = strchr(suffixes, *end);
+		if(suffix == NULL || end[1] != '\0'){
+			return 0;
+		}
+		value <<= 10 * (suffix - suffixes + 1);
+	}
+	return value;
+}
@@ -0,0 +1,455 @@
+/**
+ * Encrypt or decrypt a file or stream with DES, in CTR or CBC mode:
+ *
+ *     des_crypt [-d] [-m ctr|cbc] [-t THREADS] KEY IV [INPUT [OUTPUT]]
+ *
+ * `KEY` and `IV` are 16 hexadecimal digits each. `INPUT` and `OUTPUT` default
+ * to (or, given as `-`, mean) standard input and output. The default mode is
+ * CTR, where encryption and decryption are the same operation; `-d` decrypts
+ * in CBC mode, which pads the plaintext with PKCS#7. CTR mode uses up to
+ * `THREADS` threads, all available cores by default.
+ *
+ * Streams are read by a separate thread into one of two buffers while the
+ * other is being processed, so that reading never holds up the cipher. CTR
+ * mode between regular files memory-maps both instead, which also allows
+ * `INPUT` and `OUTPUT` to be the same file, to encrypt it in place.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "src/des_modes.h"
+
+/**
+ * The size of each of the two stream buffers: big enough for
+ * `DES_cryptCTRParallel()` to split between many threads. Must be a multiple
+ * of 8.
+ */
+#define CHUNK_SIZE (4 * 1024 * 1024)
+
+/**
+ * What to do with the input.
+ */
+typedef struct {
+	bool cbc; // Use CBC mode rather than CTR mode.
+	bool decipher; // Decrypt rather than encrypt, in CBC mode.
+	int numThreads;
+	DES_Key_t key;
+	Byte_t iv[8];
+} _Options_t;
+
+/**
+ * The two buffers shared by the main thread and the reader thread, each of
+ * which is alternately filled by the reader and emptied by the main thread.
+ * Either thread waits on `changed` for the other.
+ */
+typedef struct {
+	int fd;
+	pthread_mutex_t lock;
+	pthread_cond_t changed;
+
+	// Each buffer is preceded by 8 bytes of room for the ciphertext block held
+	// back from the previous chunk when decrypting in CBC mode, and followed by
+	// 8 bytes of room for the padding when encrypting.
+	Byte_t *buffers[2];
+	size_t lengths[2];
+	bool full[2]; // Whether `buffers[n]` holds a chunk to be processed.
+	bool last[2]; // Whether `buffers[n]` holds the final chunk.
+	int error; // The `errno` of a failed read, or 0.
+	bool stop; // Set by the main thread to stop the reader early.
+} _Reader_t;
+
+/**
+ * Map the contents of `inputFd` into memory, and `outputFd` to a file of the
+ * same size (which may be the same file), then encrypt one into the other in
+ * CTR mode. Return `false`, having printed an error, on failure.
+ */
+static bool _cryptMapped(
+	int inputFd, int outputFd, bool inPlace, const _Options_t *options
+);
+
+/**
+ * Encrypt or decrypt everything read from `inputFd` into `outputFd`, a chunk
+ * at a time, while a reader thread reads the next chunk. Return `false`,
+ * having printed an error, on failure.
+ */
+static bool _cryptStream(int inputFd, int outputFd, _Options_t *options);
+
+/**
+ * Encrypt or decrypt one chunk of a stream in place. Return the length of the
+ * result, or -1 if the last chunk of a CBC ciphertext is invalid.
+ * @param chunkPtr The chunk, with 8 bytes of room before and after it. Will be
+ *      set to the start of the result, 8 bytes earlier if a held block was
+ *      prepended to it.
+ * @param heldBlock When decrypting in CBC mode, the last ciphertext block of
+ *      the previous chunk, which is only decrypted along with the next chunk
+ *      since the final block has to be decrypted by `DES_decipherCBC()`. Will
+ *      be set to the last block of this chunk.
+ * @param blockOffset In CTR mode, the index of the chunk's first block in the
+ *      stream. Will be advanced past the chunk.
+ */
+static ssize_t _cryptChunk(
+	Byte_t **chunkPtr, size_t length, bool last, _Options_t *options,
+	Byte_t *heldBlock, bool *hasHeldBlock, uint64_t *blockOffset
+);
+
+/**
+ * The reader thread: fill each buffer of a `_Reader_t` in turn, until the end
+ * of the input, an error, or the main thread stops it.
+ */
+static void *_readChunks(void *reader);
+
+/**
+ * Read from `fd` until `length` bytes have been read or the end of the file is
+ * reached. Return the number of bytes read, or -1 on failure.
+ */
+static ssize_t _readFully(int fd, Byte_t *buffer, size_t length);
+
+/**
+ * Write all `length` bytes of `buffer` to `fd`. Return `false` on failure.
+ */
+static bool _writeFully(int fd, const Byte_t *buffer, size_t length);
+
+int main(int argc, char **argv){
+	const char *usage = "Usage: des_crypt [-d] [-m ctr|cbc] [-t THREADS] "
+		"KEY IV [INPUT [OUTPUT]]\n";
+	_Options_t options = {.numThreads = sysconf(_SC_NPROCESSORS_ONLN)};
+	int option;
+	while((option = getopt(argc, argv, "dm:t:")) != -1){
+		if(option == 'd'){
+			options.decipher = true;
+		}
+		else if(option == 'm' && strcmp(optarg, "ctr") == 0){
+			options.cbc = false;
+		}
+		else if(option == 'm' && strcmp(optarg, "cbc") == 0){
+			options.cbc = true;
+		}
+		else if(option != 't' || (options.numThreads = atoi(optarg)) <= 0){
+			fputs(usage, stderr);
+			return 1;
+		}
+	}
+
+	int numPaths = argc - optind - 2;
+	if(numPaths < 0 || numPaths > 2){
+		fputs(usage, stderr);
+		return 1;
+	}
+
+	Byte_t key[8];
+	if(
+		!BitOps_parseHexString(argv[optind], key, 8) ||
+		!BitOps_parseHexString(argv[optind + 1], options.iv, 8)
+	){
+		fputs("The key and IV must be 16 hexadecimal digits each.\n", stderr);
+		return 1;
+	}
+	DES_initKey(&options.key, key);
+
+	const char *inputPath = (numPaths > 0) ? argv[optind + 2] : "-";
+	const char *outputPath = (numPaths > 1) ? argv[optind + 3] : "-";
+	int inputFd = STDIN_FILENO, outputFd = STDOUT_FILENO;
+	if(
+		strcmp(inputPath, "-") != 0 &&
+		(inputFd = open(inputPath, O_RDONLY)) == -1
+	){
+		fprintf(
+			stderr, "Failed to open `%s`: %s.\n", inputPath, strerror(errno)
+		);
+		return 1;
+	}
+
+	// The output isn't truncated when it's opened, in case it's the input.
+	if(
+		strcmp(outputPath, "-") != 0 &&
+		(outputFd = open(outputPath, O_RDWR | O_CREAT, 0644)) == -1
+	){
+		fprintf(
+			stderr, "Failed to open `%s`: %s.\n", outputPath, strerror(errno)
+		);
+		return 1;
+	}
+
+	bool success = false;
+	struct stat inputStat, outputStat;
+	if(fstat(inputFd, &inputStat) == -1 || fstat(outputFd, &outputStat) == -1){
+		fprintf(stderr, "Failed to stat files: %s.\n", strerror(errno));
+		goto cleanup;
+	}
+
+	// Standard input and output may well be the same terminal, which is fine.
+	bool inPlace = S_ISREG(inputStat.st_mode) &&
+		inputStat.st_dev == outputStat.st_dev &&
+		inputStat.st_ino == outputStat.st_ino;
+
+	// A shared mapping of the output needs it opened for reading as well as
+	// writing, which `> FILE` isn't, and both mappings start at the beginning
+	// of their files, so inherited files that have been read or written from
+	// are streamed from where they are instead.
+	bool canMap = !options.cbc && S_ISREG(inputStat.st_mode) &&
+		S_ISREG(outputStat.st_mode) &&
+		(fcntl(outputFd, F_GETFL) & O_ACCMODE) == O_RDWR &&
+		lseek(inputFd, 0, SEEK_CUR) == 0 && lseek(outputFd, 0, SEEK_CUR) == 0;
+	if(canMap){
+		success = _cryptMapped(inputFd, outputFd, inPlace, &options);
+	}
+	else if(inPlace){
+		fputs(
+			"Only CTR mode can encrypt a file in place, from its start and "
+			"opened for reading and writing.\n", stderr
+		);
+	}
+	else if(S_ISREG(outputStat.st_mode) && ftruncate(outputFd, 0) == -1){
+		fprintf(
+			stderr, "Failed to truncate `%s`: %s.\n", outputPath,
+			strerror(errno)
+		);
+	}
+	else {
+		success = _cryptStream(inputFd, outputFd, &options);
+	}
+
+cleanup:
+	close(inputFd);
+	close(outputFd);
+	return success ? EXIT_SUCCESS : 1;
+}
+
+static bool _cryptMapped(
+	int inputFd, int outputFd, bool inPlace, const _Options_t *options
+){
+	struct stat inputStat;
+	if(fstat(inputFd, &inputStat) == -1){
+		fprintf(stderr, "Failed to stat the input: %s.\n", strerror(errno));
+		return false;
+	}
+
+	size_t length = inputStat.st_size;
+	if(!inPlace && ftruncate(outputFd, length) == -1){
+		fprintf(stderr, "Failed to resize the output: %s.\n", strerror(errno));
+		return false;
+	}
+
+	if(length == 0){
+		return true;
+	}
+
+	Byte_t *output = mmap(
+		NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, outputFd, 0
+	);
+	Byte_t *input = inPlace ? output :
+		mmap(NULL, length, PROT_READ, MAP_PRIVATE, inputFd, 0);
+	bool success = false;
+	if(output == MAP_FAILED || input == MAP_FAILED){
+		fprintf(stderr, "Failed to map files: %s.\n", strerror(errno));
+	}
+	else {
+		posix_madvise(input, length, POSIX_MADV_SEQUENTIAL);
+		DES_cryptCTRParallel(
+			input, output, length, &options->key, options->iv, 0,
+			options->numThreads
+		);
+		success = true;
+	}
+
+	if(output != MAP_FAILED){
+		munmap(output, length);
+	}
+	if(!inPlace && input != MAP_FAILED){
+		munmap(input, length);
+	}
+	return success;
+}
+
+static bool _cryptStream(int inputFd, int outputFd, _Options_t *options){
+	Byte_t *memory = malloc(2 * (CHUNK_SIZE + 16));
+	if(memory == NULL){
+		fputs("Failed to allocate buffers.\n", stderr);
+		return false;
+	}
+
+	_Reader_t reader = {
+		.fd = inputFd,
+		.buffers = {memory + 8, memory + CHUNK_SIZE + 24}
+	};
+	pthread_mutex_init(&reader.lock, NULL);
+	pthread_cond_init(&reader.changed, NULL);
+	pthread_t thread;
+	if(pthread_create(&thread, NULL, _readChunks, &reader) != 0){
+		fputs("Failed to start the reader thread.\n", stderr);
+		free(memory);
+		return false;
+	}
+
+	Byte_t heldBlock[8];
+	bool hasHeldBlock = false, success = true;
+	uint64_t blockOffset = 0;
+	for(int buffer = 0;; buffer ^= 1){
+		pthread_mutex_lock(&reader.lock);
+		while(!reader.full[buffer]){
+			pthread_cond_wait(&reader.changed, &reader.lock);
+		}
+		pthread_mutex_unlock(&reader.lock);
+
+		bool last = reader.last[buffer];
+		if(last && reader.error != 0){
+			fprintf(stderr, "Failed to read: %s.\n", strerror(reader.error));
+			success = false;
+			break;
+		}
+
+		Byte_t *chunk = reader.buffers[buffer];
+		ssize_t length = _cryptChunk(
+			&chunk, reader.lengths[buffer], last, options, heldBlock,
+			&hasHeldBlock, &blockOffset
+		);
+		if(length == -1){
+			fputs("Invalid ciphertext, or the wrong key or IV.\n", stderr);
+			success = false;
+			break;
+		}
+		if(!_writeFully(outputFd, chunk, length)){
+			fprintf(stderr, "Failed to write: %s.\n", strerror(errno));
+			success = false;
+			break;
+		}
+		if(last){
+			break;
+		}
+
+		pthread_mutex_lock(&reader.lock);
+		reader.full[buffer] = false;
+		pthread_cond_signal(&reader.changed);
+		pthread_mutex_unlock(&reader.lock);
+	}
+
+	pthread_mutex_lock(&reader.lock);
+	reader.stop = true;
+	pthread_cond_signal(&reader.changed);
+	pthread_mutex_unlock(&reader.lock);
+
+	pthread_join(thread, NULL);
+	pthread_mutex_destroy(&reader.lock);
+	pthread_cond_destroy(&reader.changed);
+	free(memory);
+	return success;
+}
+
+static ssize_t _cryptChunk(
+	Byte_t **chunkPtr, size_t length, bool last, _Options_t *options,
+	Byte_t *heldBlock, bool *hasHeldBlock, uint64_t *blockOffset
+){
+	Byte_t *chunk = *chunkPtr;
+	if(!options->cbc){
+		DES_cryptCTRParallel(
+			chunk, chunk, length, &options->key, options->iv, *blockOffset,
+			options->numThreads
+		);
+		*blockOffset += length / 8;
+		return length;
+	}
+
+	if(!options->decipher){
+		if(last){
+			return DES_encipherCBC(
+				chunk, chunk, length, &options->key, options->iv
+			);
+		}
+
+		DES_encipherCBCBlocks(chunk, chunk, length, &options->key, options->iv);
+		return length;
+	}
+
+	if(*hasHeldBlock){
+		chunk = *chunkPtr -= 8;
+		length += 8;
+		memcpy(chunk, heldBlock, 8);
+	}
+
+	if(last){
+		bool valid = DES_decipherCBC(
+			chunk, chunk, length, &options->key, options->iv, &length
+		);
+		return valid ? (ssize_t)length : -1;
+	}
+
+	// A full chunk is a whole number of blocks, so the last one can be held.
+	length -= 8;
+	memcpy(heldBlock, chunk + length, 8);
+	*hasHeldBlock = true;
+	DES_decipherCBCBlocks(chunk, chunk, length, &options->key, options->iv);
+	return length;
+}
+
+static void *_readChunks(void *readerPtr){
+	_Reader_t *reader = readerPtr;
+	for(int buffer = 0;; buffer ^= 1){
+		pthread_mutex_lock(&reader->lock);
+		while(reader->full[buffer] && !reader->stop){
+			pthread_cond_wait(&reader->changed, &reader->lock);
+		}
+		bool stop = reader->stop;
+		pthread_mutex_unlock(&reader->lock);
+		if(stop){
+			return NULL;
+		}
+
+		ssize_t length = _readFully(
+			reader->fd, reader->buffers[buffer], CHUNK_SIZE
+		);
+		bool last = length < CHUNK_SIZE;
+
+		pthread_mutex_lock(&reader->lock);
+		reader->lengths[buffer] = (length == -1) ? 0 : length;
+		reader->last[buffer] = last;
+		reader->error = (length == -1) ? errno : 0;
+		reader->full[buffer] = true;
+		pthread_cond_signal(&reader->changed);
+		pthread_mutex_unlock(&reader->lock);
+		if(last){
+			return NULL;
+		}
+	}
+}
+
+static ssize_t _readFully(int fd, Byte_t *buffer, size_t length){
+	size_t total = 0;
+	while(total < length){
+		ssize_t bytesRead = read(fd, buffer + total, length - total);
+		if(bytesRead == 0){
+			break;
+		}
+		else if(bytesRead > 0){
+			total += bytesRead;
+		}
+		else if(errno != EINTR){
+			return -1;
+		}
+	}
+	return total;
+}
+
+static bool _writeFully(int fd, const Byte_t *buffer, size_t length){
+	size_t total = 0;
+	while(total < length){
+		ssize_t bytesWritten = write(fd, buffer + total, length - total);
+		if(bytesWritten >= 0){
+			total += bytesWritten;
+		}
+		else if(errno != EINTR){
+			return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,230 @@
+/**
+ * Search for the DES key that encrypts a known plaintext block to a known
+ * ciphertext block, over a subspace of keys:
+ *
+ *     des_keysearch [-t THREADS] [-r FIRST:LAST] [-c CHECKPOINT]
+ *         PLAINTEXT CIPHERTEXT BASE_KEY MASK
+ *
+ * All four arguments are 16 hexadecimal digits. The candidates are `BASE_KEY`
+ * with the bits set in `MASK` varied, numbered as described in
+ * `src/des_keysearch.h`; `-r` limits the search to candidates `FIRST` to
+ * `LAST - 1`. The rate of the search is reported every second.
+ *
+ * With `-c`, the search's progress is saved to the file `CHECKPOINT` every
+ * second and when it's interrupted, and resumed from it when it exists. Since
+ * a search that finds a key saves the index after it, rerunning it looks for
+ * any further key.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "src/des_keysearch.h"
+
+/**
+ * Where and how far a search has got, for the progress callback.
+ */
+typedef struct {
+	const DES_KeySearch_t *search;
+	const char *checkpointPath;
+	struct timespec startTime;
+} _Progress_t;
+
+/**
+ * Set by `SIGINT` or `SIGTERM`, to stop the search at the next checkpoint.
+ */
+static volatile sig_atomic_t interrupted = 0;
+
+/**
+ * The search's progress callback: print the rate of the search, and save a
+ * checkpoint if there's a checkpoint file. Takes a `_Progress_t`.
+ */
+static bool _reportProgress(
+	uint64_t checkpoint, uint64_t numTried, void *progress
+);
+
+/**
+ * Print how far a search has got and how fast it's going, over the last line.
+ */
+static void _printRate(
+	const _Progress_t *progress, uint64_t checkpoint, uint64_t numTried
+);
+
+/**
+ * Save the range a search has left to `path`, atomically, so that an
+ * interrupted write never leaves a corrupt checkpoint. Return `false`, having
+ * printed an error, on failure.
+ */
+static bool _saveCheckpoint(const char *path, uint64_t start, uint64_t end);
+
+/**
+ * The handler for `SIGINT` and `SIGTERM`.
+ */
+static void _interrupt(int signal);
+
+int main(int argc, char **argv){
+	const char *usage = "Usage: des_keysearch [-t THREADS] [-r FIRST:LAST] "
+		"[-c CHECKPOINT] PLAINTEXT CIPHERTEXT BASE_KEY MASK\n";
+	DES_KeySearch_t search = {.numThreads = sysconf(_SC_NPROCESSORS_ONLN)};
+	_Progress_t progress = {.search = &search};
+	unsigned long long first = 0, last = 0;
+	bool hasRange = false;
+	int option;
+	while((option = getopt(argc, argv, "t:r:c:")) != -1){
+		if(option == 'c'){
+			progress.checkpointPath = optarg;
+		}
+		else if(
+			option == 'r' &&
+			sscanf(optarg, "%llu:%llu", &first, &last) == 2 && first < last
+		){
+			hasRange = true;
+		}
+		else if(option != 't' || (search.numThreads = atoi(optarg)) <= 0){
+			fputs(usage, stderr);
+			return 1;
+		}
+	}
+
+	if(argc - optind != 4){
+		fputs(usage, stderr);
+		return 1;
+	}
+
+	if(
+		!BitOps_parseHexString(argv[optind], search.plaintext, 8) ||
+		!BitOps_parseHexString(argv[optind + 1], search.ciphertext, 8) ||
+		!BitOps_parseHexString(argv[optind + 2], search.baseKey, 8) ||
+		!BitOps_parseHexString(argv[optind + 3], search.mask, 8)
+	){
+		fputs("Every argument must be 16 hexadecimal digits.\n", stderr);
+		return 1;
+	}
+
+	uint64_t numCandidates = DES_numCandidates(&search);
+	search.start = hasRange ? first : 0;
+	search.end = hasRange ? last : numCandidates;
+	if(search.end > numCandidates){
+		fprintf(
+			stderr, "The mask only covers %llu keys.\n",
+			(unsigned long long)numCandidates
+		);
+		return 1;
+	}
+
+	FILE *checkpoint = (progress.checkpointPath != NULL) ?
+		fopen(progress.checkpointPath, "r") : NULL;
+	if(checkpoint != NULL){
+		bool isValid = fscanf(checkpoint, "%llu %llu", &first, &last) == 2 &&
+			first <= last && last <= numCandidates;
+		fclose(checkpoint);
+		if(!isValid){
+			fprintf(
+				stderr, "`%s` isn't a valid checkpoint.\n",
+				progress.checkpointPath
+			);
+			return 1;
+		}
+
+		search.start = first;
+		search.end = last;
+		fprintf(stderr, "Resuming from key %llu.\n", first);
+	}
+
+	struct sigaction action = {.sa_handler = _interrupt};
+	sigaction(SIGINT, &action, NULL);
+	sigaction(SIGTERM, &action, NULL);
+
+	search.progress = _reportProgress;
+	search.context = &progress;
+	clock_gettime(CLOCK_MONOTONIC, &progress.startTime);
+	uint64_t start = search.start;
+	Byte_t key[8];
+	bool found = DES_searchKey(&search, key);
+	_printRate(&progress, search.start, search.start - start);
+	fputc('\n', stderr);
+
+	if(
+		progress.checkpointPath != NULL &&
+		!_saveCheckpoint(progress.checkpointPath, search.start, search.end)
+	){
+		return 1;
+	}
+
+	if(found){
+		for(int byte = 0; byte < 8; byte++){
+			printf("%02x", key[byte]);
+		}
+		putchar('\n');
+		return EXIT_SUCCESS;
+	}
+
+	fputs(
+		(search.start < search.end) ? "Interrupted.\n" : "No key found.\n",
+		stderr
+	);
+	return (search.start < search.end) ? 2 : 1;
+}
+
+static bool _reportProgress(
+	uint64_t checkpoint, uint64_t numTried, void *progressPtr
+){
+	_Progress_t *progress = progressPtr;
+	_printRate(progress, checkpoint, numTried);
+	if(
+		progress->checkpointPath != NULL &&
+		!_saveCheckpoint(
+			progress->checkpointPath, checkpoint, progress->search->end
+		)
+	){
+		return false;
+	}
+	return !interrupted;
+}
+
+static void _printRate(
+	const _Progress_t *progress, uint64_t checkpoint, uint64_t numTried
+){
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	double elapsed = (now.tv_sec - progress->startTime.tv_sec) +
+		(now.tv_nsec - progress->startTime.tv_nsec) / 1e9;
+	fprintf(
+		stderr, "\rTried up to key %llu of %llu, at %.2f million keys/s.",
+		(unsigned long long)checkpoint,
+		(unsigned long long)progress->search->end,
+		(elapsed > 0) ? numTried / elapsed / 1e6 : 0
+	);
+}
+
+static bool _saveCheckpoint(const char *path, uint64_t start, uint64_t end){
+	char tempPath[4096];
+	snprintf(tempPath, sizeof(tempPath), "%s.tmp", path);
+	FILE *file = fopen(tempPath, "w");
+	bool success = file != NULL && fprintf(
+		file, "%llu %llu\n", (unsigned long long)start,
+		(unsigned long long)end
+	) > 0;
+	success = (file != NULL && fclose(file) == 0) && success &&
+		rename(tempPath, path) == 0;
+	if(!success){
+		fprintf(
+			stderr, "\nFailed to save a checkpoint to `%s`: %s.\n", path,
+			strerror(errno)
+		);
+	}
+	return success;
+}
+
+static void _interrupt(int signal){
+	(void)signal;
+	interrupted = 1;
+}
@@ -0,0 +1,203 @@
+#!/usr/bin/env python3
+"""
+Generate `src/des_sbox_circuits.h`: the eight DES S-boxes as straight-line
+boolean circuits over bitsliced operands, for `des_bitslice.c`.
+
+Each output bit of an S-box is built as a tree of multiplexers, one level per
+input bit, and identical subfunctions are shared between the four outputs.
+Every order of the six inputs is tried, and the one needing the fewest gates
+is kept.
+
+Usage: python3 tools/gen_sbox_circuits.py > src/des_sbox_circuits.h
+"""
+
+import itertools
+import re
+
+S_BOXES = [
+	[
+		[14, 4, 13, 1, 2, 15, 11, 8, 3, 10, 6, 12, 5, 9, 0, 7],
+		[0, 15, 7, 4, 14, 2, 13, 1, 10, 6, 12, 11, 9, 5, 3, 8],
+		[4, 1, 14, 8, 13, 6, 2, 11, 15, 12, 9, 7, 3, 10, 5, 0],
+		[15, 12, 8, 2, 4, 9, 1, 7, 5, 11, 3, 14, 10, 0, 6, 13]
+	],
+	[
+		[15, 1, 8, 14, 6, 11, 3, 4, 9, 7, 2, 13, 12, 0, 5, 10],
+		[3, 13, 4, 7, 15, 2, 8, 14, 12, 0, 1, 10, 6, 9, 11, 5],
+		[0, 14, 7, 11, 10, 4, 13, 1, 5, 8, 12, 6, 9, 3, 2, 15],
+		[13, 8, 10, 1, 3, 15, 4, 2, 11, 6, 7, 12, 0, 5, 14, 9]
+	],
+	[
+		[10, 0, 9, 14, 6, 3, 15, 5, 1, 13, 12, 7, 11, 4, 2, 8],
+		[13, 7, 0, 9, 3, 4, 6, 10, 2, 8, 5, 14, 12, 11, 15, 1],
+		[13, 6, 4, 9, 8, 15, 3, 0, 11, 1, 2, 12, 5, 10, 14, 7],
+		[1, 10, 13, 0, 6, 9, 8, 7, 4, 15, 14, 3, 11, 5, 2, 12]
+	],
+	[
+		[7, 13, 14, 3, 0, 6, 9, 10, 1, 2, 8, 5, 11, 12, 4, 15],
+		[13, 8, 11, 5, 6, 15, 0, 3, 4, 7, 2, 12, 1, 10, 14, 9],
+		[10, 6, 9, 0, 12, 11, 7, 13, 15, 1, 3, 14, 5, 2, 8, 4],
+		[3, 15, 0, 6, 10, 1, 13, 8, 9, 4, 5, 11, 12, 7, 2, 14]
+	],
+	[
+		[2, 12, 4, 1, 7, 10, 11, 6, 8, 5, 3, 15, 13, 0, 14, 9],
+		[14, 11, 2, 12, 4, 7, 13, 1, 5, 0, 15, 10, 3, 9, 8, 6],
+		[4, 2, 1, 11, 10, 13, 7, 8, 15, 9, 12, 5, 6, 3, 0, 14],
+		[11, 8, 12, 7, 1, 14, 2, 13, 6, 15, 0, 9, 10, 4, 5, 3]
+	],
+	[
+		[12, 1, 10, 15, 9, 2, 6, 8, 0, 13, 3, 4, 14, 7, 5, 11],
+		[10, 15, 4, 2, 7, 12, 9, 5, 6, 1, 13, 14, 0, 11, 3, 8],
+		[9, 14, 15, 5, 2, 8, 12, 3, 7, 0, 4, 10, 1, 13, 11, 6],
+		[4, 3, 2, 12, 9, 5, 15, 10, 11, 14, 1, 7, 6, 0, 8, 13]
+	],
+	[
+		[4, 11, 2, 14, 15, 0, 8, 13, 3, 12, 9, 7, 5, 10, 6, 1],
+		[13, 0, 11, 7, 4, 9, 1, 10, 14, 3, 5, 12, 2, 15, 8, 6],
+		[1, 4, 11, 13, 12, 3, 7, 14, 10, 15, 6, 8, 0, 5, 9, 2],
+		[6, 11, 13, 8, 1, 4, 10, 7, 9, 5, 0, 15, 14, 2, 3, 12]
+	],
+	[
+		[13, 2, 8, 4, 6, 15, 11, 1, 10, 9, 3, 14, 5, 0, 12, 7],
+		[1, 15, 13, 8, 10, 3, 7, 4, 12, 5, 6, 11, 0, 14, 9, 2],
+		[7, 11, 4, 1, 9, 12, 14, 2, 0, 6, 10, 13, 15, 3, 5, 8],
+		[2, 1, 14, 7, 4, 10, 8, 13, 15, 12, 9, 0, 3, 5, 6, 11]
+	]
+]
+
+# Functions of the six inputs are represented by their 64-entry truth tables,
+# packed into integers: bit `x` holds the function's value for the input `x`,
+# whose most significant bit is the S-box's first input bit.
+ALL = (1 << 64) - 1
+INPUTS = [
+	sum(1 << x for x in range(64) if (x >> (5 - bit)) & 1) for bit in range(6)
+]
+
+
+def outputTables(box):
+	tables = [0] * 4
+	for x in range(64):
+		row = ((x >> 4) & 2) | (x & 1)
+		col = (x >> 1) & 15
+		value = S_BOXES[box][row][col]
+		for bit in range(4):
+			if (value >> (3 - bit)) & 1:
+				tables[bit] |= 1 << x
+	return tables
+
+
+def cofactor(table, var, value):
+	"""`table` with input `var` fixed to `value`, as a function of all six."""
+	mask = INPUTS[var]
+	shift = 1 << (5 - var)
+	half = table & mask if value else table & ~mask & ALL
+	return half | (half >> shift) if value else half | (half << shift)
+
+
+class Circuit:
+	def __init__(self):
+		self.gates = []  # (truth table, C expression)
+		self.names = {0: "zero", ALL: "~zero"}
+		for var in range(6):
+			self.names[INPUTS[var]] = "in[%d]" % var
+			self.names[~INPUTS[var] & ALL] = "~in[%d]" % var
+
+	def prune(self, outputs):
+		"""
+		Drop the gates that no output depends on, and renumber the rest.
+		Return the names of `outputs` after renumbering.
+		"""
+		live = set(outputs)
+		for name, expr in reversed(self.gates):
+			if name in live:
+				live.update(re.findall(r"t\d+", expr))
+
+		renames = {}
+		gates = []
+		for name, expr in self.gates:
+			if name in live:
+				renames[name] = "t%d" % len(gates)
+				gates.append((renames[name], re.sub(
+					r"t\d+", lambda match: renames[match.group(0)], expr)))
+		self.gates = gates
+		return [renames.get(name, name) for name in outputs]
+
+	def cost(self):
+		return sum(expr.count("&") + expr.count("|") + expr.count("^") +
+			expr.count("~") for _, expr in self.gates)
+
+	def add(self, table, expr):
+		if table not in self.names:
+			name = "t%d" % len(self.gates)
+			self.gates.append((name, expr))
+			self.names[table] = name
+		return self.names[table]
+
+	def build(self, table, order):
+		if table in self.names:
+			return self.names[table]
+
+		var = next(v for v in reversed(order) if
+			cofactor(table, v, 0) != cofactor(table, v, 1))
+		low, high = cofactor(table, var, 0), cofactor(table, var, 1)
+		sel = "in[%d]" % var
+		if low == ~high & ALL:
+			return self.add(table, "%s ^ %s" % (self.build(low, order), sel))
+		if low == 0:
+			return self.add(table, "%s & %s" % (self.build(high, order), sel))
+		if high == 0:
+			return self.add(table, "%s & ~%s" % (self.build(low, order), sel))
+		if low == ALL:
+			return self.add(table, "%s | ~%s" % (self.build(high, order), sel))
+		if high == ALL:
+			return self.add(table, "%s | %s" % (self.build(low, order), sel))
+
+		lowName, highName = self.build(low, order), self.build(high, order)
+		diff = self.add(low ^ high, "%s ^ %s" % (lowName, highName))
+		masked = self.add(
+			(low ^ high) & INPUTS[var], "%s & %s" % (diff, sel))
+		return self.add(table, "%s ^ %s" % (lowName, masked))
+
+
+def bestCircuit(box):
+	tables = outputTables(box)
+	best = None
+	for order in itertools.permutations(range(6)):
+		circuit = Circuit()
+		outputs = circuit.prune(
+			[circuit.build(table, order) for table in tables])
+		if best is None or circuit.cost() < best[0].cost():
+			best = (circuit, outputs)
+	return best
+
+
+def main():
+	print("/*")
+	print(" * @brief The DES S-boxes as boolean circuits, for the bitsliced")
+	print(" * implementation in `des_bitslice.c`. Generated by")
+	print(" * `tools/gen_sbox_circuits.py`; don't edit by hand.")
+	print("*/")
+	print()
+	print("#pragma once")
+	print()
+	print('#include "des_bitslice.h"')
+	for box in range(8):
+		circuit, outputs = bestCircuit(box)
+		print()
+		print("/**")
+		print(" * S-box %d: %d gates. `in` holds its 6 input bits and `out` "
+			"receives its" % (box + 1, circuit.cost()))
+		print(" * 4 output bits, first bits first.")
+		print(" */")
+		print("static inline void _sBox%d(const DES_Slice_t *in, "
+			"DES_Slice_t *out){" % (box + 1))
+		lines = ["\tDES_Slice_t %s = %s;" % gate for gate in circuit.gates]
+		lines += ["\tout[%d] = %s;" % output for output in enumerate(outputs)]
+		if any("zero" in line for line in lines):
+			lines.insert(0, "\tconst DES_Slice_t zero = {0};")
+		print("\n".join(lines))
+		print("}")
+
+
+if __name__ == "__main__":
+	main()
@@ -5,6 +5,7 @@
 
 #include <stdio.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <sys/time.h>
 
 #include "sieve_of_eratosthenes.h"
@@ -28,12 +29,116 @@ static void test_findNthPrimeNumber(void){
 	bool allPass = true;
 	for(int ind = 0; ind < numPrimes; ind++){
 		int primeNumber = ind + 1;
-		int actual = findNthPrimeNumber(primeNumber);
+		uint64_t actual = findNthPrimeNumber(primeNumber);
 		int expected = primes[ind];
+		if(actual != (uint64_t)expected){
+			fprintf(
+				stderr, "prime %d: actual %llu != expected %d.\n",
+				primeNumber, (unsigned long long)actual, expected
+			);
+			allPass = false;
+		}
+	}
+
+	if(allPass){
+		puts("All passed!");
+	}
+	else {
+		fputs("ERROR: One or more tests failed!\n", stderr);
+	}
+}
+
+/**
+ * Test `findNthPrimeNumber` against known large primes, beyond what fits on
+ * the stack or in 32 bits.
+ */
+static void test_findNthPrimeNumberLarge(void){
+	puts("Testing findNthPrimeNumber() against large primes.");
+	const int numPrimes = 6;
+	const uint64_t ns[] = {7022, 8581, 1e6, 1e8, 1e9, 1e10};
+	const uint64_t primes[] = {
+		70919, 88589, 15485863, 2038074743, 22801763489, 252097800623
+	};
+
+	bool allPass = true;
+	for(int ind = 0; ind < numPrimes; ind++){
+		uint64_t actual = findNthPrimeNumber(ns[ind]);
+		if(actual != primes[ind]){
+			fprintf(
+				stderr, "prime %llu: actual %llu != expected %llu.\n",
+				(unsigned long long)ns[ind], (unsigned long long)actual,
+				(unsigned long long)primes[ind]
+			);
+			allPass = false;
+		}
+	}
+
+	if(allPass){
+		puts("All passed!");
+	}
+	else {
+		fputs("ERROR: One or more tests failed!\n", stderr);
+	}
+}
+
+/**
+ * Test `countPrimesUpTo` against the number of primes up to powers of 10, and
+ * either side of a prime.
+ */
+static void test_countPrimesUpTo(void){
+	puts("Testing countPrimesUpTo() against known prime counts.");
+	const int numTests = 15;
+	const uint64_t xs[] = {
+		0, 1, 2, 10, 100, 1000, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+		2038074742, 2038074743
+	};
+	const uint64_t counts[] = {
+		0, 0, 1, 4, 25, 168, 1229, 9592, 78498, 664579, 5761455, 50847534,
+		455052511, 99999999, 100000000
+	};
+
+	bool allPass = true;
+	for(int test = 0; test < numTests; test++){
+		uint64_t actual = countPrimesUpTo(xs[test]);
+		if(actual != counts[test]){
+			fprintf(
+				stderr, "pi(%llu): actual %llu != expected %llu.\n",
+				(unsigned long long)xs[test], (unsigned long long)actual,
+				(unsigned long long)counts[test]
+			);
+			allPass = false;
+		}
+	}
+
+	if(allPass){
+		puts("All passed!");
+	}
+	else {
+		fputs("ERROR: One or more tests failed!\n", stderr);
+	}
+}
+
+/**
+ * Test `findNthPrimeNumberParallel` against `findNthPrimeNumber`, with more
+ * threads than cores and with more threads than blocks.
+ */
+static void test_findNthPrimeNumberParallel(void){
+	puts("Testing findNthPrimeNumberParallel() against findNthPrimeNumber().");
+	const int numTests = 5;
+	const uint64_t ns[] = {1, 1000, 2000000, 10000000, 100000000};
+	const int numThreads[] = {4, 4, 4, 64, 3};
+
+	bool allPass = true;
+	for(int test = 0; test < numTests; test++){
+		uint64_t actual = findNthPrimeNumberParallel(
+			ns[test], numThreads[test]
+		);
+		uint64_t expected = findNthPrimeNumber(ns[test]);
 		if(actual != expected){
 			fprintf(
-				stderr, "prime %d: actual %d != expected %d.\n",
-				primeNumber, actual, expected
+				stderr, "prime %llu: actual %llu != expected %llu.\n",
+				(unsigned long long)ns[test], (unsigned long long)actual,
+				(unsigned long long)expected
 			);
 			allPass = false;
 		}
@@ -47,6 +152,115 @@ static void test_findNthPrimeNumber(void){
 	}
 }
 
+/**
+ * A `findPrimesInRange()` callback that counts primes into `counts[0]`, and
+ * stops at `counts[1]` of them.
+ */
+static bool countPrime(uint64_t prime, void *counts){
+	(void)prime;
+	uint64_t *count = counts;
+	return ++count[0] < count[1];
+}
+
+/**
+ * Test `PrimeIter_next` and `PrimeIter_skipTo` against `findNthPrimeNumber`
+ * and `countPrimesUpTo`, and `findPrimesInRange` against `countPrimesUpTo`.
+ */
+static void test_PrimeIter(void){
+	puts(
+		"Testing PrimeIter_next(), PrimeIter_skipTo() and findPrimesInRange()."
+	);
+	bool allPass = true;
+	PrimeIter_t iter;
+	PrimeIter_init(&iter);
+
+	// Walk across many segments, checking primes at powers of 10 along the
+	// way.
+	uint64_t prime = 0, count = 0, nextCheck = 1;
+	while(count < 10000000){
+		prime = PrimeIter_next(&iter);
+		if(++count == nextCheck){
+			if(prime != findNthPrimeNumber(count)){
+				fprintf(
+					stderr, "prime %llu: iterated to %llu.\n",
+					(unsigned long long)count, (unsigned long long)prime
+				);
+				allPass = false;
+			}
+			nextCheck *= 10;
+		}
+	}
+
+	// Skipping backwards and forwards, onto primes and between them.
+	const int numSkips = 9;
+	const uint64_t skips[] = {
+		0, 2, 3, 4, 6, 7, 2038074743, 2038074744, 100000000000
+	};
+	for(int skip = 0; skip < numSkips; skip++){
+		PrimeIter_skipTo(&iter, skips[skip]);
+		prime = PrimeIter_next(&iter);
+		uint64_t numBefore = (skips[skip] > 0) ?
+			countPrimesUpTo(skips[skip] - 1) : 0;
+		if(
+			prime < skips[skip] || countPrimesUpTo(prime) != numBefore + 1 ||
+			PrimeIter_next(&iter) <= prime
+		){
+			fprintf(
+				stderr, "skip to %llu: next is %llu.\n",
+				(unsigned long long)skips[skip], (unsigned long long)prime
+			);
+			allPass = false;
+		}
+	}
+
+	// Near 2^64, up to the largest prime below it, after which the iterator
+	// ends.
+	PrimeIter_skipTo(&iter, 18446744073709551000u);
+	uint64_t first = PrimeIter_next(&iter), last = first;
+	while((prime = PrimeIter_next(&iter)) > last){
+		last = prime;
+	}
+	PrimeIter_skipTo(&iter, UINT64_MAX);
+	if(
+		first != 18446744073709551113u || last != LARGEST_64_BIT_PRIME ||
+		prime != 0 || PrimeIter_next(&iter) != 0
+	){
+		fprintf(
+			stderr, "near 2^64: iterated from %llu to %llu.\n",
+			(unsigned long long)first, (unsigned long long)last
+		);
+		allPass = false;
+	}
+	PrimeIter_free(&iter);
+
+	// A range across several segments, one cut short by the callback, and
+	// empty ones, including one past the largest 64-bit prime.
+	uint64_t full[] = {0, UINT64_MAX}, cut[] = {0, 1000}, empty[] = {0, 1};
+	uint64_t pastMax[] = {0, UINT64_MAX};
+	findPrimesInRange(1000000000, 1010000000, countPrime, full);
+	findPrimesInRange(1000000000, 1010000000, countPrime, cut);
+	findPrimesInRange(1000, 1008, countPrime, empty);
+	bool pastMaxFound = findPrimesInRange(
+		LARGEST_64_BIT_PRIME + 1, UINT64_MAX, countPrime, pastMax
+	);
+	uint64_t expected = countPrimesUpTo(1010000000) -
+		countPrimesUpTo(999999999);
+	if(
+		full[0] != expected || cut[0] != 1000 || empty[0] != 0 ||
+		!pastMaxFound || pastMax[0] != 0
+	){
+		fputs("findPrimesInRange() found the wrong primes.\n", stderr);
+		allPass = false;
+	}
+
+	if(allPass){
+		puts("All passed!");
+	}
+	else {
+		fputs("ERROR: One or more tests failed!\n", stderr);
+	}
+}
+
 /* Returns the current time in microseconds. */
 static long getMicrotime(){
 	struct timeval currentTime;
@@ -59,18 +273,18 @@ static long getMicrotime(){
  */
 static void test_findNthPrimeNumberSpeed(void){
 	puts("Testing speed of findNthPrimeNumber(1000000):");
-	unsigned int expectedPrime = 15485863;
+	uint64_t expectedPrime = 15485863;
 
 	long totalTime = 0;
 	const int numTests = 10;
 	for(int test = 0; test < numTests; test++){
 		long startTime = getMicrotime();
-		unsigned int prime = findNthPrimeNumber(1e6);
+		uint64_t prime = findNthPrimeNumber(1e6);
 		long deltaTime = getMicrotime() - startTime;
 		if(prime != expectedPrime){
 			fprintf(
-				stderr, "ERROR: actual %d did not match expected %d!\n",
-				prime, expectedPrime
+				stderr, "ERROR: actual %llu did not match expected %llu!\n",
+				(unsigned long long)prime, (unsigned long long)expectedPrime
 			);
 		}
 		else {
@@ -84,6 +298,10 @@ static void test_findNthPrimeNumberSpeed(void){
 
 int main(){
 	test_findNthPrimeNumber();
+	test_findNthPrimeNumberLarge();
+	test_findNthPrimeNumberParallel();
+	test_countPrimesUpTo();
+	test_PrimeIter();
 	test_findNthPrimeNumberSpeed();
 	return 0;
 }
@@ -1,14 +1,177 @@
-#include <stdio.h>
-#include <string.h>
 #include <math.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sieve_of_eratosthenes.h"
+
+/*
+ * The number of bytes sieved at once, each covering 30 numbers. A segment
+ * stays in the L2 cache, and mostly in L1; this measured faster than one that
+ * fits in a 32K L1 cache, which leaves each larger sieving prime fewer
+ * multiples to cross off per segment. Must be a multiple of 8, so that
+ * segments can be counted a word at a time.
+ */
+#define SEGMENT_BYTES (64 * 1024)
+
+/*
+ * The number of segments in a block, which `findNthPrimeNumberParallel()`
+ * hands to one thread at a time: enough that pointing the sieving primes at
+ * the start of each block costs little.
+ */
+#define BLOCK_SEGMENTS 16
+
+/*
+ * The `n` from which `findNthPrimeNumber()` counts the primes up to an
+ * estimate of the `n`th, rather than sieving up to it.
+ */
+#define COUNTING_THRESHOLD 100000
+
+/*
+ * The largest sieving prime an iterator keeps from one segment to the next,
+ * along with where its next multiple is. Those above it, only needed from
+ * 2^54 on, are found again for each segment instead, which keeps the kept
+ * ones to about 120MB.
+ */
+#define ITER_KEPT_ROOT (1 << 27)
+
+/*
+ * The byte an iterator stops at: the numbers from it on don't fit in 64 bits,
+ * and the largest prime that does, `LARGEST_64_BIT_PRIME`, is before it.
+ */
+#define END_BYTE (UINT64_MAX / 30)
+
+// Convenience macros for converting an odd number to a slot in the sieve that
+// finds the sieving primes, and back.
+#define NUM_TO_IND(num) (((num) - 3) / 2)
+#define IND_TO_NUM(ind) ((ind) * 2 + 3)
+
+/*
+ * A prime that crosses off multiples in the segments, and where its next
+ * multiple is: the byte it's in, and the wheel index of the multiplier, which
+ * together with `prime % 30` determine the bit.
+ */
+typedef struct SievingPrime {
+	uint32_t prime;
+	uint32_t wheelIndex;
+	uint64_t byte;
+} SievingPrime_t;
+
+/*
+ * The state shared by the threads of `findNthPrimeNumberParallel()`, which
+ * count the primes in a range a block at a time.
+ */
+typedef struct {
+	SievingPrime_t *sievingPrimes; // Pointed at 0; threads use copies.
+	size_t numSievingPrimes;
+	uint64_t numBytes;
+	uint64_t numBlocks;
+	uint64_t *blockCounts; // The number of primes in each block.
+
+	pthread_mutex_t lock; // Guards the fields below.
+	uint64_t nextBlock; // The first block no thread has taken yet.
+	bool failed; // Set if a thread couldn't allocate memory.
+} PrimeCount_t;
+
+/*
+ * The residues modulo 30 of the numbers that aren't multiples of 2, 3 or 5
+ * (the "wheel"), one per bit of a byte, followed by that of the next turn.
+ */
+static const int wheel[] = {1, 7, 11, 13, 17, 19, 23, 29, 31};
+
+/* The wheel index of the first residue at or above each value below 30. */
+static const int nextWheelIndex[] = {
+	0, 0, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 4, 4, 4, 4, 5, 5, 6, 6, 6, 6, 7,
+	7, 7, 7, 7, 7
+};
+
+/*
+ * For a prime with residue `wheel[row]`, and the multiplier with residue
+ * `wheel[column]`: the mask that clears the bit of their product, and how
+ * many bytes further the product with the next multiplier is, less
+ * `(prime / 30) * (wheel[column + 1] - wheel[column])`.
+ */
+static const uint8_t crossOffMasks[8][8] = {
+	{0xfe, 0xfd, 0xfb, 0xf7, 0xef, 0xdf, 0xbf, 0x7f},
+	{0xfd, 0xdf, 0xef, 0xfe, 0x7f, 0xf7, 0xfb, 0xbf},
+	{0xfb, 0xef, 0xfe, 0xbf, 0xfd, 0x7f, 0xf7, 0xdf},
+	{0xf7, 0xfe, 0xbf, 0xdf, 0xfb, 0xfd, 0x7f, 0xef},
+	{0xef, 0x7f, 0xfd, 0xfb, 0xdf, 0xbf, 0xfe, 0xf7},
+	{0xdf, 0xf7, 0x7f, 0xfd, 0xbf, 0xfe, 0xef, 0xfb},
+	{0xbf, 0xfb, 0xf7, 0x7f, 0xfe, 0xef, 0xdf, 0xfd},
+	{0x7f, 0xbf, 0xdf, 0xef, 0xf7, 0xfb, 0xfd, 0xfe}
+};
+static const uint8_t byteCarries[8][8] = {
+	{0, 0, 0, 0, 0, 0, 0, 1},
+	{1, 1, 1, 0, 1, 1, 1, 1},
+	{2, 2, 0, 2, 0, 2, 2, 1},
+	{3, 1, 1, 2, 1, 1, 3, 1},
+	{3, 3, 1, 2, 1, 3, 3, 1},
+	{4, 2, 2, 2, 2, 2, 4, 1},
+	{5, 3, 1, 4, 1, 3, 5, 1},
+	{6, 4, 2, 4, 2, 4, 6, 1}
+};
+
+/*
+ * The entry point of a `findNthPrimeNumberParallel()` thread: count the
+ * primes in blocks until there are none left. Takes a `PrimeCount_t`.
+ */
+static void *countBlocks(void *count);
+
+/*
+ * Return an estimate of the `n`th prime, for `n >= 6`: the first terms of
+ * Cipolla's asymptotic expansion, which are within 0.1% of it from
+ * `n = 10^5` on, and 0.001% from `n = 10^7` on.
+ */
+static uint64_t nthPrimeEstimate(uint64_t n){
+	double logN = log(n), logLogN = log(logN);
+	return n * (
+		logN + logLogN - 1 + (logLogN - 2) / logN -
+		(logLogN * logLogN - 6 * logLogN + 11) / (2 * logN * logN)
+	);
+}
+
+/* Return the square root of `x`, rounded down. */
+static uint64_t integerSqrt(uint64_t x){
+	// Rounding can take the root of numbers near 2^64 to 2^32, whose square
+	// overflows.
+	uint64_t root = sqrt(x);
+	if(root > UINT32_MAX){
+		root = UINT32_MAX;
+	}
+	while(root * root > x){
+		root--;
+	}
+	while(root < UINT32_MAX && (root + 1) * (root + 1) <= x){
+		root++;
+	}
+	return root;
+}
+
+/*
+ * Sieve the segment of an iterator starting at byte `startByte`, having found
+ * more sieving primes if it needs them, and point the iterator at its first
+ * word. Return `false` if memory couldn't be allocated.
+ */
+static bool sieveIteratorSegment(PrimeIter_t *iter, uint64_t startByte);
+
+/*
+ * Load 8 bytes as a word, the first in the least significant byte, whatever
+ * the host's byte order.
+ */
+static uint64_t loadWord(const uint8_t *bytes);
 
 /* Return the upper bound for the `n`th prime. */
-static unsigned int nthPrimeUpperBound(int n){
-	if(n >= 7022){
+static uint64_t nthPrimeUpperBound(uint64_t n){
+	if(n >= 39017){
 		/*
-		 * See page 2 of https://www.maa.org/sites/default/files/jaroma03200545640.pdf
+		 * See Dusart, "The kth prime is greater than k(ln k + ln ln k - 1) for
+		 * k >= 2", Mathematics of Computation 68 (1999). (The bound with
+		 * 0.9385 for `n >= 7022` that this used before undershoots some
+		 * primes, the first being the 7022nd.)
 		 */
-		return n * (log(n) + log(log(n)) - 0.9385);
+		return n * (log(n) + log(log(n)) - 0.9484);
 	}
 	else if(n >= 6){
 		/*
@@ -24,65 +187,804 @@ static unsigned int nthPrimeUpperBound(int n){
 	}
 }
 
-unsigned int findNthPrimeNumber(int n){
+/*
+ * Return an upper bound for the number of primes up to `x`: see Dusart, "The
+ * kth prime is greater than k(ln k + ln ln k - 1) for k >= 2", Mathematics of
+ * Computation 68 (1999).
+ */
+static uint64_t primeCountUpperBound(uint64_t x){
+	if(x < 2){
+		return 0;
+	}
+	double logX = log(x);
+	return x / logX * (1 + 1.2762 / logX) + 1;
+}
+
+/*
+ * Return the odd primes up to and including `limit` in an array that must be
+ * deallocated by the caller, and write their number to `numPrimes`. Return
+ * `NULL` if memory couldn't be allocated.
+ */
+static uint32_t *findSievingPrimes(uint32_t limit, size_t *numPrimes){
+	size_t numNumbers = (limit >= 3) ? NUM_TO_IND(limit) + 1 : 0;
+	char *numbers = calloc(numNumbers + 1, 1);
+	uint32_t *primes = malloc((numNumbers + 1) * sizeof(uint32_t));
+	if(numbers == NULL || primes == NULL){
+		free(numbers);
+		free(primes);
+		return NULL;
+	}
+
+	*numPrimes = 0;
+	for(size_t ind = 0; ind < numNumbers; ind++){
+		if(numbers[ind] == 1){
+			continue;
+		}
+
+		uint32_t prime = IND_TO_NUM(ind);
+		primes[(*numPrimes)++] = prime;
+		for(
+			size_t multiple = NUM_TO_IND((uint64_t)prime * prime);
+			multiple < numNumbers; multiple += prime
+		){
+			numbers[multiple] = 1;
+		}
+	}
+
+	free(numbers);
+	return primes;
+}
+
+/*
+ * Point a sieving prime at its first multiple that's at least its square and
+ * at least `30 * startByte`, and not a multiple of 2, 3 or 5. If that's past
+ * 2^64, it's pointed at the last byte instead, past any segment.
+ */
+static void initSievingPrime(
+	SievingPrime_t *sievingPrime, uint32_t prime, uint64_t startByte
+){
+	uint64_t startNumber = startByte * 30;
+	uint64_t multiplier = startNumber / prime + (startNumber % prime != 0);
+	if(multiplier < prime){
+		multiplier = prime;
+	}
+
+	int wheelIndex = nextWheelIndex[multiplier % 30];
+	multiplier += wheel[wheelIndex] - multiplier % 30;
+	uint64_t multiple;
+	sievingPrime->prime = prime;
+	sievingPrime->wheelIndex = wheelIndex;
+	sievingPrime->byte = __builtin_mul_overflow(prime, multiplier, &multiple) ?
+		UINT64_MAX : multiple / 30;
+}
+
+/*
+ * Clear the bits of the multiples of `sievingPrimes` (which must be in
+ * increasing order) in the `numBytes` bytes of the segment starting at byte
+ * `startByte`, and advance each prime to its first multiple past the segment.
+ */
+static void crossOffMultiples(
+	uint8_t *segment, uint64_t startByte, size_t numBytes,
+	SievingPrime_t *sievingPrimes, size_t numSievingPrimes
+){
+	uint64_t endNumber = (startByte + numBytes) * 30;
+	for(size_t ind = 0; ind < numSievingPrimes; ind++){
+		SievingPrime_t *sievingPrime = &sievingPrimes[ind];
+		uint64_t prime = sievingPrime->prime;
+
+		// Primes are crossed off from their squares, so once one's square is
+		// past the segment, so is every larger one's.
+		if(prime * prime >= endNumber){
+			break;
+		}
+
+		const uint8_t *masks = crossOffMasks[nextWheelIndex[prime % 30]];
+		const uint8_t *carries = byteCarries[nextWheelIndex[prime % 30]];
+		uint64_t byte = sievingPrime->byte - startByte;
+		uint32_t wheelIndex = sievingPrime->wheelIndex;
+		uint32_t turns = prime / 30;
+		if(byte >= numBytes){
+			continue;
+		}
+
+		// Every turn of the wheel (8 multiples) spans `prime` bytes, so
+		// cross off whole turns with the offsets and masks of the multiples
+		// within one worked out up front.
+		uint64_t offsets[8], offset = 0;
+		uint8_t turnMasks[8];
+		for(int step = 0; step < 8; step++){
+			int stepIndex = (wheelIndex + step) % 8;
+			offsets[step] = offset;
+			turnMasks[step] = masks[stepIndex];
+			offset += turns * (wheel[stepIndex + 1] - wheel[stepIndex]) +
+				carries[stepIndex];
+		}
+		for(; byte + offsets[7] < numBytes; byte += prime){
+			for(int step = 0; step < 8; step++){
+				segment[byte + offsets[step]] &= turnMasks[step];
+			}
+		}
+
+		while(byte < numBytes){
+			segment[byte] &= masks[wheelIndex];
+			byte += turns * (wheel[wheelIndex + 1] - wheel[wheelIndex]) +
+				carries[wheelIndex];
+			wheelIndex = (wheelIndex + 1) % 8;
+		}
+		sievingPrime->byte = byte + startByte;
+		sievingPrime->wheelIndex = wheelIndex;
+	}
+}
+
+/*
+ * Sieve the `numBytes` bytes of the segment starting at byte `startByte`:
+ * set every bit, then cross off the multiples of `sievingPrimes`. Bits past
+ * `numBytes` up to `SEGMENT_BYTES` are cleared.
+ */
+static void sieveSegment(
+	uint8_t *segment, uint64_t startByte, size_t numBytes,
+	SievingPrime_t *sievingPrimes, size_t numSievingPrimes
+){
+	memset(segment, 0xff, numBytes);
+	memset(segment + numBytes, 0, SEGMENT_BYTES - numBytes);
+	if(startByte == 0){
+		segment[0] &= 0xfe; // 1 isn't prime.
+	}
+	crossOffMultiples(
+		segment, startByte, numBytes, sievingPrimes, numSievingPrimes
+	);
+}
+
+/*
+ * Append the primes from 7 on, from `low` up to and including `high` (below
+ * 2^32), to the `*numSievingPrimes` in `*sievingPrimes`, which is reallocated
+ * to fit them, pointed at their first multiples from byte `startByte`. They're
+ * found a segment at a time, crossing off with the primes up to the square
+ * root of `high`, which a plain sieve finds. Return `false` if memory
+ * couldn't be allocated, leaving the primes already in the array as they were.
+ */
+static bool appendSievingPrimes(
+	SievingPrime_t **sievingPrimes, size_t *numSievingPrimes, uint64_t low,
+	uint64_t high, uint64_t startByte
+){
+	if(low < 7){
+		low = 7;
+	}
+	uint64_t byte = low / 30, endByte = high / 30 + 1;
+
+	// There's at most one prime per bit of the wheel.
+	uint64_t maxPrimes = primeCountUpperBound(high);
+	if(low <= high && maxPrimes > (endByte - byte) * 8){
+		maxPrimes = (endByte - byte) * 8;
+	}
+	SievingPrime_t *primes = realloc(
+		*sievingPrimes,
+		(*numSievingPrimes + maxPrimes + 1) * sizeof(SievingPrime_t)
+	);
+	if(primes == NULL){
+		return false;
+	}
+	*sievingPrimes = primes;
+	if(low > high){
+		return true;
+	}
+
+	size_t numFactors = 0;
+	uint32_t *factors = findSievingPrimes(integerSqrt(high), &numFactors);
+	SievingPrime_t *crossers =
+		malloc((numFactors + 1) * sizeof(SievingPrime_t));
+	uint8_t *segment = malloc(SEGMENT_BYTES);
+	if(factors == NULL || crossers == NULL || segment == NULL){
+		free(factors);
+		free(crossers);
+		free(segment);
+		return false;
+	}
+
+	size_t numCrossers = 0;
+	for(size_t factor = 0; factor < numFactors; factor++){
+		if(factors[factor] >= 7){
+			initSievingPrime(&crossers[numCrossers++], factors[factor], byte);
+		}
+	}
+	free(factors);
+
+	for(; byte < endByte; byte += SEGMENT_BYTES){
+		size_t numBytes = (endByte - byte < SEGMENT_BYTES) ?
+			endByte - byte : SEGMENT_BYTES;
+		sieveSegment(segment, byte, numBytes, crossers, numCrossers);
+		for(size_t ind = 0; ind < numBytes; ind++){
+			for(unsigned bits = segment[ind]; bits != 0; bits &= bits - 1){
+				uint64_t prime = (byte + ind) * 30 + wheel[__builtin_ctz(bits)];
+				if(prime >= low && prime <= high){
+					initSievingPrime(
+						&primes[(*numSievingPrimes)++], prime, startByte
+					);
+				}
+			}
+		}
+	}
+
+	free(crossers);
+	free(segment);
+	return true;
+}
+
+/*
+ * Return the primes to cross off with to sieve up to `upperBound` (those from
+ * 7 up to its square root, since checking any factors above it would be
+ * redundant with the already visited factors below it), in increasing order
+ * and pointed at their squares, and write their number to
+ * `numSievingPrimes`. The array must be deallocated by the caller. Return
+ * `NULL` if memory couldn't be allocated.
+ */
+static SievingPrime_t *findSievingPrimesUpTo(
+	uint64_t upperBound, size_t *numSievingPrimes
+){
+	uint64_t upperFactorBound = integerSqrt(upperBound);
+	if(upperFactorBound * upperFactorBound < upperBound){
+		upperFactorBound++;
+	}
+
+	SievingPrime_t *sievingPrimes = NULL;
+	*numSievingPrimes = 0;
+	if(!appendSievingPrimes(
+		&sievingPrimes, numSievingPrimes, 0, upperFactorBound, 0
+	)){
+		free(sievingPrimes);
+		return NULL;
+	}
+	return sievingPrimes;
+}
+
+/* Return the number of set bits in a segment, counted a word at a time. */
+static uint64_t countSegment(const uint8_t *segment){
+	uint64_t count = 0;
+	for(size_t byte = 0; byte < SEGMENT_BYTES; byte += 8){
+		uint64_t word;
+		memcpy(&word, segment + byte, 8);
+		count += __builtin_popcountll(word);
+	}
+	return count;
+}
+
+/*
+ * Return the number of primes from 7 on in the bytes from `startByte` up to
+ * `endByte`, having pointed `sievingPrimes` at `startByte`, and sieved them
+ * a segment at a time in `segment`.
+ */
+static uint64_t countPrimesInRange(
+	uint64_t startByte, uint64_t endByte, SievingPrime_t *sievingPrimes,
+	size_t numSievingPrimes, uint8_t *segment
+){
+	for(size_t ind = 0; ind < numSievingPrimes; ind++){
+		initSievingPrime(
+			&sievingPrimes[ind], sievingPrimes[ind].prime, startByte
+		);
+	}
+
+	uint64_t count = 0;
+	for(
+		uint64_t segmentStart = startByte; segmentStart < endByte;
+		segmentStart += SEGMENT_BYTES
+	){
+		size_t segmentBytes = (endByte - segmentStart < SEGMENT_BYTES) ?
+			endByte - segmentStart : SEGMENT_BYTES;
+		sieveSegment(
+			segment, segmentStart, segmentBytes, sievingPrimes,
+			numSievingPrimes
+		);
+		count += countSegment(segment);
+	}
+	return count;
+}
+
+/*
+ * Sieve the bytes from `startByte` up to `endByte` a segment at a time,
+ * counting primes from `numPrimes` (the number before `startByte`), and
+ * return the `n`th prime, or 0 if it isn't in that range or memory couldn't
+ * be allocated. `sievingPrimes` are pointed at `startByte` first.
+ */
+static uint64_t findNthPrimeInRange(
+	uint64_t n, uint64_t numPrimes, uint64_t startByte, uint64_t endByte,
+	SievingPrime_t *sievingPrimes, size_t numSievingPrimes
+){
+	uint8_t *segment = malloc(SEGMENT_BYTES);
+	if(segment == NULL){
+		return 0;
+	}
+
+	for(size_t ind = 0; ind < numSievingPrimes; ind++){
+		initSievingPrime(
+			&sievingPrimes[ind], sievingPrimes[ind].prime, startByte
+		);
+	}
+
+	uint64_t nthPrime = 0;
+	for(
+		uint64_t segmentStart = startByte;
+		segmentStart < endByte && nthPrime == 0;
+		segmentStart += SEGMENT_BYTES
+	){
+		size_t segmentBytes = (endByte - segmentStart < SEGMENT_BYTES) ?
+			endByte - segmentStart : SEGMENT_BYTES;
+		sieveSegment(
+			segment, segmentStart, segmentBytes, sievingPrimes,
+			numSievingPrimes
+		);
+
+		uint64_t segmentPrimes = countSegment(segment);
+		if(numPrimes + segmentPrimes < n){
+			numPrimes += segmentPrimes;
+			continue;
+		}
+
+		// The `n`th prime is in this segment: find its byte, then its bit.
+		size_t byte = 0;
+		for(; numPrimes + __builtin_popcount(segment[byte]) < n; byte++){
+			numPrimes += __builtin_popcount(segment[byte]);
+		}
+		for(int bit = 0; bit < 8; bit++){
+			if((segment[byte] >> bit & 1) && ++numPrimes == n){
+				nthPrime = (segmentStart + byte) * 30 + wheel[bit];
+				break;
+			}
+		}
+	}
+
+	free(segment);
+	return nthPrime;
+}
+
+uint64_t findNthPrimeNumber(uint64_t n){
+	/**
+	 * This prime finder uses a segmented, wheel-factorized Sieve of
+	 * Eratosthenes. Of every 30 numbers, only the 8 that aren't multiples of
+	 * 2, 3 or 5 can be prime (bar those three), so each byte of the sieve
+	 * holds one bit for each of those: whether the number it corresponds to
+	 * could still be prime (1), or has been marked off as a multiple of a
+	 * lesser prime (0). The range is sieved `SEGMENT_BYTES` bytes at a time in
+	 * a buffer that stays in cache, and the set bits of each segment counted
+	 * a word at a time with popcount, so the search stops at the segment
+	 * containing the `n`th prime.
+	 *
+	 * The primes to cross off with (those from 7 up to the square root of the
+	 * upper bound) are found first the same way, crossing off with the primes
+	 * up to their own square root, which a plain sieve finds. Each only visits
+	 * its multiples that are on the wheel, stepping from one to the next with
+	 * `crossOffMasks` and `byteCarries`, and carries over where it got to from
+	 * one segment to the next.
+	 *
+	 * From `COUNTING_THRESHOLD` on, the sieve starts near the `n`th prime
+	 * instead, from an estimate of it and `countPrimesUpTo()` that.
+	 */
+
+	// 2, 3 and 5 aren't on the wheel.
+	if(n <= 3){
+		static const uint64_t smallPrimes[] = {0, 2, 3, 5};
+		return smallPrimes[n];
+	}
+
+	const uint64_t upperBound = nthPrimeUpperBound(n);
+	const uint64_t numBytes = upperBound / 30 + 1;
+	size_t numSievingPrimes = 0;
+	SievingPrime_t *sievingPrimes =
+		findSievingPrimesUpTo(upperBound, &numSievingPrimes);
+	uint8_t *segment = malloc(SEGMENT_BYTES);
+	if(sievingPrimes == NULL || segment == NULL){
+		free(sievingPrimes);
+		free(segment);
+		return 0;
+	}
+
+	// For large `n`, skip sieving most of the range by counting the primes
+	// up to an estimate of the `n`th, and only sieve from there on. While
+	// the estimate is too high, step back (twice as far each time),
+	// subtracting the primes stepped over.
+	uint64_t startByte = 0, numPrimes = 3;
+	if(n >= COUNTING_THRESHOLD){
+		startByte = nthPrimeEstimate(n) / 30;
+		if(startByte > numBytes){
+			startByte = numBytes;
+		}
+		numPrimes = countPrimesUpTo(startByte * 30 - 1);
+		for(uint64_t step = SEGMENT_BYTES; numPrimes >= n; step *= 2){
+			uint64_t stepStart = (startByte > step) ? startByte - step : 0;
+			numPrimes -= countPrimesInRange(
+				stepStart, startByte, sievingPrimes, numSievingPrimes, segment
+			);
+			startByte = stepStart;
+		}
+	}
+
+	uint64_t nthPrime = (numPrimes == 0) ? 0 : findNthPrimeInRange(
+		n, numPrimes, startByte, numBytes, sievingPrimes, numSievingPrimes
+	);
+	free(sievingPrimes);
+	free(segment);
+	return nthPrime;
+}
+
+uint64_t countPrimesUpTo(uint64_t x){
 	/**
-	 * This prime finder uses a moderately optimized Sieve of Eratosthenes.
-	 * The range of values is stored on the stack in a `numbers` array (note
-	 * that this is dangerous, because we may very well exceed the maximum
-	 * stack size for large enough `n`). Each index contains a binary value:
-	 * whether the number corresponding to that index has been marked off as a
-	 * multiple of a lesser number (1), or not (0). The `char` type is used to
-	 * reduce the array's footprint, but bit masking would be ideal.. as far as
-	 * space is concerned, anyway. Only odd values starting from 3 are stored
-	 * in the array, since we don't need to bother checking even values for
-	 * primality. Consequently, when we check off the multiples of each
-	 * successive prime number, we only visit the odd ones.
+	 * This uses Lucy_Hedgehog's method, from the Project Euler 10 forum: let
+	 * `S(v, p)` be the number of integers from 2 to `v` that are prime or
+	 * have no prime factor up to `p`. `S(v, 1) = v - 1`, and going from the
+	 * prime before `p` to `p` removes the numbers whose least prime factor is
+	 * `p`, so
+	 *
+	 *     S(v, p) = S(v, p - 1) - (S(v / p, p - 1) - S(p - 1, p - 1))
+	 *
+	 * for `v >= p * p` (below that, nothing changes). `S(x, sqrt(x))` is
+	 * `pi(x)`, and the only values of `v` needed are those of `x / i`, of
+	 * which there are about `2 * sqrt(x)`: every `v` up to `sqrt(x)`, in
+	 * `small`, and `x / i` for every `i` up to `sqrt(x)`, in `large`. It
+	 * takes about `x ^ (3 / 4)` time.
 	 */
+	if(x < 2){
+		return 0;
+	}
 
-	// Convenience macros for converting a number to a slot in the `numbers`
-	// array.
-	#define NUM_TO_IND(num) ((num - 3) / 2)
-	#define IND_TO_NUM(num) (num * 2 + 3)
+	const uint64_t root = integerSqrt(x);
+	uint32_t *small = malloc((root + 1) * sizeof(uint32_t));
+	uint64_t *large = malloc((root + 1) * sizeof(uint64_t));
+	if(small == NULL || large == NULL){
+		free(small);
+		free(large);
+		return 0;
+	}
 
-	// A hack necessary to account for the fact that the `numbers` array starts
-	// storing values from 3 (which is necessary because of the assumption that
-	// every value inside of it is odd), meaning that 2, which is the only even
-	// prime, is simply never accounted for.
-	if(n == 1){
-		return 2;
+	for(uint64_t v = 1; v <= root; v++){
+		small[v] = v - 1;
+		large[v] = x / v - 1;
 	}
 
-	const int upperBound = nthPrimeUpperBound(n);
-	const int numNumbers = NUM_TO_IND(upperBound) + 1;
-	char numbers[numNumbers];
-	memset(numbers, 0, numNumbers);
+	const double realX = x;
+	for(uint64_t p = 2; p <= root; p++){
+		// `p` is prime if `S(p)` went up from `S(p - 1)`.
+		if(small[p] == small[p - 1]){
+			continue;
+		}
 
-	// Checking any factors above the square-root of the upper bound would be
-	// redundant with the already visited factors below it.
-	int upperFactorBound = ceil(sqrt(upperBound));
+		const uint32_t numSmaller = small[p - 1];
+		const uint64_t square = p * p;
+		uint64_t endLarge = x / square;
+		if(endLarge > root){
+			endLarge = root;
+		}
 
-	int factor = 3;
-	int factorInd = 0;
-	while(factor <= upperFactorBound){
-		int multiple = factor * 3;
-		int multipleDelta = factor * 2;
-		while(multiple < upperBound){
-			numbers[NUM_TO_IND(multiple)] = 1;
-			multiple += multipleDelta;
+		// `x / i / p` is `x / (i * p)`, which is in `large` while `i * p` is
+		// at most `root`, and in `small` after that. Dividing in floating
+		// point and correcting is faster than 64-bit integer division.
+		uint64_t i = 1;
+		for(; i <= endLarge && i * p <= root; i++){
+			large[i] -= large[i * p] - numSmaller;
+		}
+		for(; i <= endLarge; i++){
+			uint64_t divisor = i * p, quotient = realX / divisor;
+			if(quotient * divisor > x){
+				quotient--;
+			}
+			else if((quotient + 1) * divisor <= x){
+				quotient++;
+			}
+			large[i] -= small[quotient] - numSmaller;
 		}
 
-		// Find the next prime number in `numbers`, and use that as the next
-		// factor to check off.
-		while(numbers[++factorInd] == 1);
-		factor = IND_TO_NUM(factorInd);
+		// Every `v` from `q * p` to `q * p + p - 1` has `v / p = q`. Going
+		// down, each `small[q]` is read before it's updated.
+		for(uint64_t q = root / p; q >= p; q--){
+			uint32_t delta = small[q] - numSmaller;
+			uint64_t end = (q * p + p - 1 < root) ? q * p + p - 1 : root;
+			for(uint64_t v = q * p; v <= end; v++){
+				small[v] -= delta;
+			}
+		}
 	}
 
-	int numPrimes = 1;
-	for(int ind = 0; ind < numNumbers; ind++){
-		if(numbers[ind] == 0 && ++numPrimes == n){
-			return IND_TO_NUM(ind);
+	uint64_t count = large[1];
+	free(small);
+	free(large);
+	return count;
+}
+
+uint64_t findNthPrimeNumberParallel(uint64_t n, int numThreads){
+	/**
+	 * The range up to the upper bound is split into blocks of
+	 * `BLOCK_SEGMENTS` segments, which the threads take in turn, each counting
+	 * the primes in a block into `blockCounts` with its own segment and copy
+	 * of the sieving primes. A prefix sum of the counts then gives the block
+	 * containing the `n`th prime, which is sieved again to find it.
+	 */
+	if(n <= 3 || numThreads <= 1){
+		return findNthPrimeNumber(n);
+	}
+
+	const uint64_t numBytes = nthPrimeUpperBound(n) / 30 + 1;
+	const uint64_t blockBytes = (uint64_t)BLOCK_SEGMENTS * SEGMENT_BYTES;
+	const uint64_t numBlocks = (numBytes + blockBytes - 1) / blockBytes;
+	if(numBlocks < 2){
+		return findNthPrimeNumber(n);
+	}
+
+	PrimeCount_t count = {
+		.numBytes = numBytes,
+		.numBlocks = numBlocks,
+		.blockCounts = malloc(numBlocks * sizeof(uint64_t))
+	};
+	count.sievingPrimes = findSievingPrimesUpTo(
+		numBytes * 30, &count.numSievingPrimes
+	);
+	if(count.blockCounts == NULL || count.sievingPrimes == NULL){
+		free(count.blockCounts);
+		free(count.sievingPrimes);
+		return 0;
+	}
+	pthread_mutex_init(&count.lock, NULL);
+
+	// The calling thread counts blocks too, so the count completes even if no
+	// other thread could be started.
+	if((uint64_t)numThreads > numBlocks){
+		numThreads = numBlocks;
+	}
+	pthread_t threads[numThreads - 1];
+	bool started[numThreads - 1];
+	for(int thread = 0; thread < numThreads - 1; thread++){
+		started[thread] =
+			pthread_create(&threads[thread], NULL, countBlocks, &count) == 0;
+	}
+	countBlocks(&count);
+	for(int thread = 0; thread < numThreads - 1; thread++){
+		if(started[thread]){
+			pthread_join(threads[thread], NULL);
 		}
 	}
+	pthread_mutex_destroy(&count.lock);
+
+	uint64_t nthPrime = 0, numPrimes = 3;
+	for(uint64_t block = 0; block < numBlocks && !count.failed; block++){
+		if(numPrimes + count.blockCounts[block] >= n){
+			uint64_t endByte = (block + 1) * blockBytes;
+			nthPrime = findNthPrimeInRange(
+				n, numPrimes, block * blockBytes,
+				(endByte < numBytes) ? endByte : numBytes,
+				count.sievingPrimes, count.numSievingPrimes
+			);
+			break;
+		}
+		numPrimes += count.blockCounts[block];
+	}
+
+	free(count.blockCounts);
+	free(count.sievingPrimes);
+	return nthPrime;
+}
+
+static void *countBlocks(void *countPtr){
+	PrimeCount_t *count = countPtr;
+	size_t numSievingPrimes = count->numSievingPrimes;
+	SievingPrime_t *sievingPrimes =
+		malloc((numSievingPrimes + 1) * sizeof(SievingPrime_t));
+	uint8_t *segment = malloc(SEGMENT_BYTES);
+	if(sievingPrimes == NULL || segment == NULL){
+		pthread_mutex_lock(&count->lock);
+		count->failed = true;
+		pthread_mutex_unlock(&count->lock);
+	}
+	else {
+		memcpy(
+			sievingPrimes, count->sievingPrimes,
+			numSievingPrimes * sizeof(SievingPrime_t)
+		);
+	}
+
+	const uint64_t blockBytes = (uint64_t)BLOCK_SEGMENTS * SEGMENT_BYTES;
+	while(sievingPrimes != NULL && segment != NULL){
+		pthread_mutex_lock(&count->lock);
+		uint64_t block = count->nextBlock++;
+		pthread_mutex_unlock(&count->lock);
+		if(block >= count->numBlocks){
+			break;
+		}
+
+		uint64_t startByte = block * blockBytes;
+		uint64_t endByte = startByte + blockBytes;
+		if(endByte > count->numBytes){
+			endByte = count->numBytes;
+		}
+		uint64_t blockCount = countPrimesInRange(
+			startByte, endByte, sievingPrimes, numSievingPrimes, segment
+		);
+		count->blockCounts[block] = blockCount;
+	}
+
+	free(sievingPrimes);
+	free(segment);
+	return NULL;
+}
+
+bool PrimeIter_init(PrimeIter_t *iter){
+	*iter = (PrimeIter_t){.segment = malloc(SEGMENT_BYTES)};
+	if(iter->segment == NULL){
+		return false;
+	}
+	return PrimeIter_skipTo(iter, 0);
+}
+
+void PrimeIter_free(PrimeIter_t *iter){
+	free(iter->segment);
+	free(iter->sievingPrimes);
+	*iter = (PrimeIter_t){0};
+}
+
+uint64_t PrimeIter_next(PrimeIter_t *iter){
+	// 2, 3 and 5 aren't on the wheel.
+	if(iter->numSmallPrimes < 3){
+		static const uint64_t smallPrimes[] = {2, 3, 5};
+		return smallPrimes[iter->numSmallPrimes++];
+	}
+
+	// Bit `8 * k + b` of a word is bit `b` of its `k`th byte, so the lowest
+	// set bit is always the next prime.
+	while(iter->bits == 0){
+		iter->wordByte += 8;
+		if(iter->wordByte >= SEGMENT_BYTES){
+			// Stay at the end of the last segment, if it's been reached.
+			if(END_BYTE - iter->segmentStart <= SEGMENT_BYTES){
+				iter->wordByte = SEGMENT_BYTES;
+				return 0;
+			}
+			if(!sieveIteratorSegment(iter, iter->segmentStart + SEGMENT_BYTES)){
+				return 0;
+			}
+		}
+		iter->bits = loadWord(iter->segment + iter->wordByte);
+	}
+
+	int bit = __builtin_ctzll(iter->bits);
+	iter->bits &= iter->bits - 1;
+	return (iter->segmentStart + iter->wordByte + bit / 8) * 30 +
+		wheel[bit % 8];
+}
+
+bool PrimeIter_skipTo(PrimeIter_t *iter, uint64_t x){
+	iter->numSmallPrimes = (x > 5) ? 3 : (x > 3) ? 2 : (x > 2) ? 1 : 0;
+	if(!sieveIteratorSegment(iter, x / 30)){
+		return false;
+	}
+
+	// Skip the numbers below `x` in the segment's first byte.
+	iter->bits = loadWord(iter->segment);
+	iter->bits &= ~(uint64_t)0 << nextWheelIndex[x % 30];
+	return true;
+}
+
+bool findPrimesInRange(
+	uint64_t low, uint64_t high, bool (*callback)(uint64_t, void *),
+	void *context
+){
+	// Past the largest 64-bit prime, the iterator only returns 0.
+	if(high > LARGEST_64_BIT_PRIME){
+		high = LARGEST_64_BIT_PRIME;
+	}
+	if(low > high){
+		return true;
+	}
+
+	PrimeIter_t iter;
+	if(!PrimeIter_init(&iter) || !PrimeIter_skipTo(&iter, low)){
+		PrimeIter_free(&iter);
+		return false;
+	}
+
+	bool success = true;
+	while(true){
+		uint64_t prime = PrimeIter_next(&iter);
+		if(prime == 0){
+			success = false;
+			break;
+		}
+		if(prime > high || !callback(prime, context) || prime == high){
+			break;
+		}
+	}
+
+	PrimeIter_free(&iter);
+	return success;
+}
+
+/*
+ * Cross off the multiples of the primes from `low` up to and including `high`
+ * in the `numBytes` bytes of the segment starting at byte `startByte`,
+ * finding them `30 * SEGMENT_BYTES` numbers at a time rather than keeping
+ * them. Return `false` if memory couldn't be allocated.
+ */
+static bool crossOffFoundPrimes(
+	uint8_t *segment, uint64_t startByte, size_t numBytes, uint64_t low,
+	uint64_t high
+){
+	const uint64_t chunkNumbers = (uint64_t)SEGMENT_BYTES * 30;
+	SievingPrime_t *primes = NULL;
+	bool success = true;
+	for(
+		uint64_t chunkLow = low; chunkLow <= high && success;
+		chunkLow += chunkNumbers
+	){
+		uint64_t chunkHigh = (high - chunkLow >= chunkNumbers) ?
+			chunkLow + chunkNumbers - 1 : high;
+		size_t numPrimes = 0;
+		success = appendSievingPrimes(
+			&primes, &numPrimes, chunkLow, chunkHigh, startByte
+		);
+		if(success){
+			crossOffMultiples(segment, startByte, numBytes, primes, numPrimes);
+		}
+	}
+	free(primes);
+	return success;
+}
+
+static bool sieveIteratorSegment(PrimeIter_t *iter, uint64_t startByte){
+	size_t numBytes = (END_BYTE - startByte < SEGMENT_BYTES) ?
+		END_BYTE - startByte : SEGMENT_BYTES;
+	uint64_t endNumber = (startByte + numBytes) * 30;
+	uint64_t neededRoot = integerSqrt(endNumber - 1);
+	bool isContinued = iter->sievingPrimes != NULL &&
+		startByte == iter->segmentStart + SEGMENT_BYTES;
+
+	// Keep the sieving primes up to the square root of twice the end of the
+	// segment, so that they're only extended each time the iterator gets
+	// about twice as far, a logarithmic number of times.
+	if(
+		iter->sievingPrimes == NULL ||
+		(iter->sieveRoot < neededRoot && iter->sieveRoot < ITER_KEPT_ROOT)
+	){
+		uint64_t root = integerSqrt(
+			(endNumber > UINT64_MAX / 2) ? UINT64_MAX : endNumber * 2
+		);
+		if(root > ITER_KEPT_ROOT){
+			root = ITER_KEPT_ROOT;
+		}
+		if(!appendSievingPrimes(
+			&iter->sievingPrimes, &iter->numSievingPrimes,
+			iter->sieveRoot + 1, root, startByte
+		)){
+			return false;
+		}
+		iter->sieveRoot = root;
+	}
+
+	// The sieving primes already point past the previous segment when the
+	// iterator moves on to the next one (and any just appended, at this one).
+	if(!isContinued){
+		for(size_t ind = 0; ind < iter->numSievingPrimes; ind++){
+			initSievingPrime(
+				&iter->sievingPrimes[ind], iter->sievingPrimes[ind].prime,
+				startByte
+			);
+		}
+	}
+
+	sieveSegment(
+		iter->segment, startByte, numBytes, iter->sievingPrimes,
+		iter->numSievingPrimes
+	);
+	if(numBytes > 0 && neededRoot > iter->sieveRoot && !crossOffFoundPrimes(
+		iter->segment, startByte, numBytes, iter->sieveRoot + 1,
+		neededRoot
+	)){
+		return false;
+	}
+	iter->segmentStart = startByte;
+	iter->wordByte = 0;
+	return true;
+}
 
-	return 0;
+static uint64_t loadWord(const uint8_t *bytes){
+	uint64_t word;
+	memcpy(&word, bytes, sizeof(word));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	word = __builtin_bswap64(word);
+#endif
+	return word;
 }
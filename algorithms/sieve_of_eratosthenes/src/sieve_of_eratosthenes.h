@@ -1,12 +1,90 @@
 #pragma once
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
 /*
- * Find and return the `n`th prime number using the Sieve of Eratosthenes. If
- * the prime couldn't be computed (likely an implementation error), 0 will be
+ * Find and return the `n`th prime number using a segmented Sieve of
+ * Eratosthenes. For large `n`, only the range between an estimate of the
+ * prime and the prime itself is sieved, with `countPrimesUpTo()` giving the
+ * number of primes before it. If the prime couldn't be computed (`n` is 0,
+ * or memory couldn't be allocated), 0 will be returned.
+ *
+ * Complexity:
+ *   space: sqrt(n * log(n)), plus a fixed-size segment
+ *   time: (n * log(n)) ^ (3 / 4)
+ */
+uint64_t findNthPrimeNumber(uint64_t n);
+
+/*
+ * Find and return the `n`th prime number by sieving the whole range up to it,
+ * split into blocks of segments that up to `numThreads` threads (including
+ * the calling one) count the primes of in parallel. Small `n` are left to
+ * `findNthPrimeNumber()`. If the prime couldn't be computed, 0 will be
  * returned.
+ */
+uint64_t findNthPrimeNumberParallel(uint64_t n, int numThreads);
+
+/*
+ * Count the primes up to and including `x`, without sieving up to it. If
+ * memory couldn't be allocated, 0 will be returned.
  *
  * Complexity:
- *   space: n * log(n)
- *   time: (n * log(n)) ^ (3 / 2)
+ *   space: sqrt(x)
+ *   time: x ^ (3 / 4)
+ */
+uint64_t countPrimesUpTo(uint64_t x);
+
+/* The largest prime that fits in 64 bits, 2^64 - 59. */
+#define LARGEST_64_BIT_PRIME UINT64_C(18446744073709551557)
+
+/*
+ * An iterator over the primes in increasing order, backed by a segmented
+ * sieve that's advanced one segment at a time, so that only a segment and the
+ * primes up to the square root of the current one are held in memory (and
+ * past 2^54, only those up to 2^27, finding the rest again for each segment).
+ * Treat the fields as private.
+ */
+typedef struct {
+	int numSmallPrimes; // How many of 2, 3 and 5 have been returned.
+	uint8_t *segment;
+	uint64_t segmentStart; // The byte the segment starts at.
+	size_t wordByte; // The byte of the segment that `bits` was loaded from.
+	uint64_t bits; // The bits of that word not returned yet.
+	struct SievingPrime *sievingPrimes;
+	size_t numSievingPrimes;
+	uint64_t sieveRoot; // The number `sievingPrimes` were found up to.
+} PrimeIter_t;
+
+/*
+ * Initialize an iterator at the first prime, 2. Return `false` if memory
+ * couldn't be allocated.
+ */
+bool PrimeIter_init(PrimeIter_t *iter);
+
+/* Deallocate an iterator. */
+void PrimeIter_free(PrimeIter_t *iter);
+
+/*
+ * Return the next prime, or 0 if memory couldn't be allocated to sieve the
+ * next segment, or once past `LARGEST_64_BIT_PRIME`.
+ */
+uint64_t PrimeIter_next(PrimeIter_t *iter);
+
+/*
+ * Move an iterator so that the next call to `PrimeIter_next()` returns the
+ * first prime at or above `x`, which may be lower than where it is now.
+ * Return `false` if memory couldn't be allocated.
+ */
+bool PrimeIter_skipTo(PrimeIter_t *iter, uint64_t x);
+
+/*
+ * Call `callback` with every prime from `low` to `high` inclusive, in
+ * increasing order, and `context`, until it returns `false`. Return `false`
+ * if memory couldn't be allocated.
  */
-unsigned int findNthPrimeNumber(int n);
+bool findPrimesInRange(
+	uint64_t low, uint64_t high, bool (*callback)(uint64_t, void *),
+	void *context
+);
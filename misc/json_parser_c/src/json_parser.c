@@ -31,10 +31,70 @@
 #include <stdlib.h>
 #include <ctype.h>
 #include <setjmp.h>
+#include <stdint.h>
 #include <string.h>
 
 #include "json_parser.h"
-#include "src/stretchy_buffer.h"
+
+/**
+ * Strings, and the members/elements of objects and arrays, are accumulated on
+ * scratch stacks while they're being parsed, and copied into an exactly-sized
+ * block once they're complete. Since containers can nest, the `keys` and
+ * `values` stacks are shared by every open container, each of which only owns
+ * the entries above the stack top at the time it was opened; strings never
+ * nest, so `chars` only ever holds one. This means that building a value
+ * never reallocates (or wastes) any of the memory it'll end up occupying, and
+ * that the scratch buffers themselves can be kept warm across parses by a
+ * `JsonParserSession_t`.
+ */
+typedef struct {
+	char *chars;
+	int numChars, charsCapacity;
+	JsonString_t *keys;
+	int numKeys, keysCapacity;
+	JsonVal_t *values;
+	int numValues, valuesCapacity;
+	const JsonAllocator_t *allocator; // Where the buffers are allocated from.
+} JsonParserScratch_t;
+
+/**
+ * A bump allocator backed by a linked list of chunks, which are retained when
+ * it's reset so that it can be refilled without any calls to `malloc()`.
+ */
+typedef struct JsonArenaChunk {
+	struct JsonArenaChunk *next;
+	size_t size; // The capacity of `data`.
+	size_t used; // The number of bytes of `data` handed out.
+	char data[];
+} JsonArenaChunk_t;
+
+typedef struct {
+	JsonArenaChunk_t *first, *current;
+	const JsonAllocator_t *allocator; // Where the chunks are allocated from.
+} JsonArena_t;
+
+// The size of the first chunk allocated by an arena.
+#define JSON_ARENA_CHUNK_SIZE (64 * 1024)
+
+// The maximum number of distinct keys a session will intern, which bounds the
+// memory that a stream of documents with arbitrary keys can pin down.
+#define JSON_SESSION_MAX_INTERNED_KEYS 4096
+
+struct JsonParserSession {
+	// Where the session's own memory (its arenas, scratch buffers and key
+	// table) is allocated from.
+	const JsonAllocator_t *backingAllocator;
+
+	JsonArena_t valueArena; // Holds the values of the current document.
+	JsonAllocator_t allocator; // Allocates from `valueArena`.
+	JsonParserScratch_t scratch;
+
+	// An open-addressed hash table of interned keys, which are stored in
+	// `keyArena` and shared between all the documents parsed in the session.
+	JsonArena_t keyArena;
+	JsonString_t *internedKeys;
+	int numInternedKeys;
+};
 
 /**
  * A representation of the parser's state, passed around from function to
@@ -44,11 +104,22 @@ typedef struct {
 	const char *inputStr; // The string being parsed.
 	int stringInd; // The parser's current index inside `inputStr`.
 	bool isNullTerminated; // Whether or not `inputStr` is null-terminated.
-	int inputStrLength; // The maximum number of bytes to read in `inputStr`.
+	// The number of bytes to read in `inputStr`; computed up front if it's
+	// null-terminated.
+	int inputStrLength;
 
 	int colNum; // The current column number inside `inputStr`.
 	int lineNum; // The current line number inside `inputStr`.
 
+	// The allocator used for every value (`NULL` for the standard one), and
+	// the counters to update, if any.
+	const JsonAllocator_t *allocator;
+	JsonParserStats_t *stats;
+
+	JsonParserScratch_t *scratch;
+	// The session being parsed in, if any; used to intern object keys.
+	JsonParserSession_t *session;
+
 	JsonParserError_t error; // Contains any error information.
 	// The last error-catching context (created with `setjmp()`) to `longjmp()`
 	// to in case of an error.
@@ -56,6 +127,200 @@ typedef struct {
 } JsonParser_t;
 
 static JsonVal_t JsonParser_parseValue(JsonParser_t *state);
+static void JsonParser_error(
+	JsonParser_t *state, JsonParserErrorType_t errorType,
+	char *errMsg, bool jump);
+
+/**
+ * Allocate, reallocate or deallocate blocks through `allocator`, or the
+ * standard library functions if it's `NULL`.
+ */
+static void *JsonAllocator_alloc(const JsonAllocator_t *allocator, size_t size){
+	return (allocator == NULL) ?
+		malloc(size) :
+		allocator->realloc(allocator->context, NULL, 0, size);
+}
+
+static void *JsonAllocator_realloc(
+	const JsonAllocator_t *allocator, void *ptr, size_t oldSize, size_t size){
+	return (allocator == NULL) ?
+		realloc(ptr, size) :
+		allocator->realloc(allocator->context, ptr, oldSize, size);
+}
+
+static void JsonAllocator_free(
+	const JsonAllocator_t *allocator, void *ptr, size_t size){
+	if(allocator == NULL){
+		free(ptr);
+	}
+	else if(ptr != NULL){
+		allocator->free(allocator->context, ptr, size);
+	}
+}
+
+/**
+ * Copy the `size` bytes at `src` into a new block from the parser's allocator,
+ * and return it (or `NULL` if `size` is 0). Raise an error if the allocator
+ * fails, unless `mayFail` is set, in which case `NULL` is returned.
+ */
+static void *JsonParser_copyOut(
+	JsonParser_t *state, const void *src, size_t size, bool mayFail){
+	if(size == 0){
+		return NULL;
+	}
+
+	void *block = JsonAllocator_alloc(state->allocator, size);
+	if(block == NULL){
+		if(mayFail){
+			return NULL;
+		}
+		JsonParser_error(
+			state, JSON_ERR_ALLOC, "Failed to allocate memory.", true);
+	}
+	memcpy(block, src, size);
+
+	JsonParserStats_t *stats = state->stats;
+	if(stats != NULL){
+		stats->allocations++;
+		stats->domBytes += size;
+		if(stats->domBytes > stats->peakDomBytes){
+			stats->peakDomBytes = stats->domBytes;
+		}
+	}
+	return block;
+}
+
+/**
+ * Return the number of bytes in the blocks that make up `val`, as counted by
+ * `JsonParser_copyOut()`.
+ */
+static size_t JsonVal_domBytes(const JsonVal_t *val){
+	switch(val->type){
+		case JSON_STRING:
+			return val->value.string.length;
+
+		case JSON_OBJECT:{
+			JsonObject_t obj = val->value.object;
+			size_t size =
+				obj.length * (sizeof(JsonString_t) + sizeof(JsonVal_t));
+			for(int pair = 0; pair < obj.length; pair++){
+				size += obj.keys[pair].length +
+					JsonVal_domBytes(&obj.values[pair]);
+			}
+			return size;
+		}
+
+		case JSON_ARRAY:{
+			JsonArray_t arr = val->value.array;
+			size_t size = arr.length * sizeof(JsonVal_t);
+			for(int ind = 0; ind < arr.length; ind++){
+				size += JsonVal_domBytes(&arr.values[ind]);
+			}
+			return size;
+		}
+
+		default:
+			return 0;
+	}
+}
+
+/**
+ * Deallocate a block returned by `JsonParser_copyOut()`, or a value built out
+ * of them, through the parser's allocator, and take them off its counters.
+ */
+static void JsonParser_freeBlock(
+	JsonParser_t *state, void *block, size_t size){
+	if(block != NULL && state->stats != NULL){
+		state->stats->domBytes -= size;
+	}
+	JsonAllocator_free(state->allocator, block, size);
+}
+
+static void JsonParser_freeVal(JsonParser_t *state, JsonVal_t *val){
+	if(state->stats != NULL){
+		state->stats->domBytes -= JsonVal_domBytes(val);
+	}
+	JsonVal_freeWithAllocator(val, state->allocator);
+}
+
+/**
+ * Make room for at least one more item in the scratch buffer `*buffer` of
+ * `*capacity` items, each `itemSize` bytes large, by doubling its capacity.
+ * Raise an error if memory can't be allocated; `*buffer` is left untouched in
+ * that case.
+ */
+static void JsonParser_growScratch(
+	JsonParser_t *state, void **buffer, int *capacity, size_t itemSize){
+	int newCapacity = *capacity ? 2 * *capacity : 16;
+	void *grown = JsonAllocator_realloc(
+		state->scratch->allocator, *buffer, *capacity * itemSize,
+		newCapacity * itemSize);
+	if(grown == NULL){
+		JsonParser_error(
+			state, JSON_ERR_ALLOC, "Failed to allocate memory.", true);
+	}
+	*buffer = grown;
+	*capacity = newCapacity;
+
+	if(state->stats != NULL){
+		state->stats->reallocations++;
+	}
+}
+
+static void JsonParser_pushChar(JsonParser_t *state, char chr){
+	JsonParserScratch_t *scratch = state->scratch;
+	if(scratch->numChars == scratch->charsCapacity){
+		JsonParser_growScratch(
+			state, (void **)&scratch->chars, &scratch->charsCapacity,
+			sizeof(char));
+	}
+	scratch->chars[scratch->numChars++] = chr;
+}
+
+/**
+ * Make room for one more key/value on the scratch stacks, so that an item can
+ * be parsed before it's pushed: if the stack had to grow afterwards and that
+ * failed, the item would be lost to the unwinding code, and leak. Nested
+ * containers only ever leave the stacks as big as they found them, so the
+ * room is still there once the item has been parsed.
+ */
+static void JsonParser_reserveKey(JsonParser_t *state){
+	JsonParserScratch_t *scratch = state->scratch;
+	if(scratch->numKeys == scratch->keysCapacity){
+		JsonParser_growScratch(
+			state, (void **)&scratch->keys, &scratch->keysCapacity,
+			sizeof(JsonString_t));
+	}
+}
+
+static void JsonParser_reserveValue(JsonParser_t *state){
+	JsonParserScratch_t *scratch = state->scratch;
+	if(scratch->numValues == scratch->valuesCapacity){
+		JsonParser_growScratch(
+			state, (void **)&scratch->values, &scratch->valuesCapacity,
+			sizeof(JsonVal_t));
+	}
+}
+
+static void JsonParser_pushKey(JsonParser_t *state, JsonString_t key){
+	JsonParser_reserveKey(state);
+	state->scratch->keys[state->scratch->numKeys++] = key;
+}
+
+static void JsonParser_pushValue(JsonParser_t *state, JsonVal_t val){
+	JsonParser_reserveValue(state);
+	state->scratch->values[state->scratch->numValues++] = val;
+}
+
+static void JsonParserScratch_free(JsonParserScratch_t *scratch){
+	const JsonAllocator_t *allocator = scratch->allocator;
+	JsonAllocator_free(allocator, scratch->chars, scratch->charsCapacity);
+	JsonAllocator_free(
+		allocator, scratch->keys, scratch->keysCapacity * sizeof(JsonString_t));
+	JsonAllocator_free(
+		allocator, scratch->values,
+		scratch->valuesCapacity * sizeof(JsonVal_t));
+}
 
 void JsonParserError_free(JsonParserError_t *err){
 	free(err->errMsg);
@@ -75,6 +340,7 @@ const char *JsonErrorType_toString(JsonParserErrorType_t type){
 		CASE(JSON_ERR_BOOL);
 		CASE(JSON_ERR_NUMBER);
 		CASE(JSON_ERR_VALUE);
+		CASE(JSON_ERR_ALLOC);
 
 		default:
 			return "Undefined type.";
@@ -82,28 +348,38 @@ const char *JsonErrorType_toString(JsonParserErrorType_t type){
 }
 
 void JsonVal_free(JsonVal_t *val){
+	JsonVal_freeWithAllocator(val, NULL);
+}
+
+void JsonVal_freeWithAllocator(
+	JsonVal_t *val, const JsonAllocator_t *allocator){
 	switch(val->type){
 		case JSON_STRING:
-			sb_free(val->value.string.str);
+			JsonAllocator_free(
+				allocator, val->value.string.str, val->value.string.length);
 			break;
 
 		case JSON_OBJECT:{
 			JsonObject_t obj = val->value.object;
-			for(int pair = 0; pair < val->value.object.length; pair++){
-				sb_free(obj.keys[pair].str);
-				JsonVal_free(&obj.values[pair]);
+			for(int pair = 0; pair < obj.length; pair++){
+				JsonAllocator_free(
+					allocator, obj.keys[pair].str, obj.keys[pair].length);
+				JsonVal_freeWithAllocator(&obj.values[pair], allocator);
 			}
-			sb_free(obj.keys);
-			sb_free(obj.values);
+			JsonAllocator_free(
+				allocator, obj.keys, obj.length * sizeof(JsonString_t));
+			JsonAllocator_free(
+				allocator, obj.values, obj.length * sizeof(JsonVal_t));
 			break;
 		}
 
 		case JSON_ARRAY:{
 			JsonArray_t arr = val->value.array;
-			for(int ind = 0; ind < val->value.array.length; ind++){
-				JsonVal_free(&arr.values[ind]);
+			for(int ind = 0; ind < arr.length; ind++){
+				JsonVal_freeWithAllocator(&arr.values[ind], allocator);
 			}
-			sb_free(arr.values);
+			JsonAllocator_free(
+				allocator, arr.values, arr.length * sizeof(JsonVal_t));
 			break;
 		}
 
@@ -315,21 +591,62 @@ static bool JsonParser_nextIfChr(JsonParser_t *state, char c){
 }
 
 /**
- * Advance the parser past any whitespace.
+ * Return a word with the high bit of each byte set if the corresponding byte
+ * of `word` is non-zero. Unlike the usual `(word - 0x01...) & ~word` trick, no
+ * borrows propagate between bytes, so every byte's result is exact.
+ */
+static uint64_t nonZeroBytes(uint64_t word){
+	const uint64_t lowBits = 0x7f7f7f7f7f7f7f7fULL;
+	return (((word & lowBits) + lowBits) | word) & ~lowBits;
+}
+
+/**
+ * Advance the parser past any whitespace (space, tab, line feed and carriage
+ * return, as per RFC 8259). This reads the input directly rather than through
+ * `JsonParser_next()`, since whitespace can't contain errors, and fixes up the
+ * line/column numbers once at the end. Runs of indentation, which make up most
+ * of a pretty-printed document, are skipped a word at a time.
  */
 static void JsonParser_skipWhitespace(JsonParser_t *state){
-	char c = JsonParser_peek(state);
-	while(c == ' ' || c == '\t' || c == '\n'){
-		JsonParser_next(state);
-		if(c == '\n'){
-			state->colNum = 1;
+	const uint64_t spaces = 0x2020202020202020ULL,
+		tabs = 0x0909090909090909ULL,
+		carriageReturns = 0x0d0d0d0d0d0d0d0dULL;
+	const char *input = state->inputStr;
+	int length = state->inputStrLength;
+	int startInd = state->stringInd,
+		ind = startInd,
+		lastNewlineInd = -1;
+
+	while(ind < length){
+		char chr = input[ind];
+		if(chr == '\n'){
 			state->lineNum++;
+			lastNewlineInd = ind++;
+		}
+		else if(chr == ' ' || chr == '\t' || chr == '\r'){
+			ind++;
+			uint64_t word;
+			while(ind + (int)sizeof(word) <= length){
+				memcpy(&word, input + ind, sizeof(word));
+				bool allWhitespace = !(
+					nonZeroBytes(word ^ spaces) &
+					nonZeroBytes(word ^ tabs) &
+					nonZeroBytes(word ^ carriageReturns));
+				if(!allWhitespace){
+					break;
+				}
+				ind += sizeof(word);
+			}
 		}
 		else {
-			state->colNum++;
+			break;
 		}
-		c = JsonParser_peek(state);
 	}
+
+	state->colNum = (lastNewlineInd == -1) ?
+		state->colNum + ind - startInd :
+		ind - lastNewlineInd;
+	state->stringInd = ind;
 }
 
 /**
@@ -388,96 +705,107 @@ static void encodeUtf8CodePoint(int codePoint, int *numBytes, char *dest){
 	}
 }
 
-static JsonString_t JsonParser_parseString(JsonParser_t *state){
+/**
+ * Return the session's interned copy of `key`, interning it first if it's
+ * new, or `NULL` if the intern table is full or memory couldn't be allocated.
+ * Keys are hashed with FNV-1a into a table with linear probing that's kept at
+ * most half full.
+ */
+static char *JsonParserSession_intern(
+	JsonParserSession_t *session, const char *key, int length);
+
+/**
+ * Parse a string. If `isKey` is set and the parser is running in a session,
+ * the string's contents are interned rather than copied into a new block.
+ */
+static JsonString_t JsonParser_parseString(JsonParser_t *state, bool isKey){
 	JsonParser_expect(state, '"');
-	char *volatile str = NULL;
+	state->scratch->numChars = 0;
+
+	while(JsonParser_peek(state) != '"'){
+		char chr = JsonParser_next(state);
+		if(chr == '\\'){
+			bool escapedCntrlChr = true;
+			char escapedChar = JsonParser_next(state);
+			char replacementChar;
+
+			// For brevity.
+			#define ESCAPED_REPLACEMENT(escaped, replacement) \
+				case escaped: \
+					replacementChar = replacement; \
+					break
+
+			switch(escapedChar){
+				ESCAPED_REPLACEMENT('"', '"');
+				ESCAPED_REPLACEMENT('\\', '\\');
+				ESCAPED_REPLACEMENT('/', '/');
+				ESCAPED_REPLACEMENT('b', '\b');
+				ESCAPED_REPLACEMENT('f', '\f');
+				ESCAPED_REPLACEMENT('n', '\n');
+				ESCAPED_REPLACEMENT('r', '\r');
+				ESCAPED_REPLACEMENT('t', '\t');
+
+				default:
+					escapedCntrlChr = false;
+					break;
+			}
 
-	jmp_buf prevErrorTrap;
-	copyJmpBuf(prevErrorTrap, state->errorTrap);
-	if(!setjmp(state->errorTrap)){
-		while(JsonParser_peek(state) != '"'){
-			char chr = JsonParser_next(state);
-			if(chr == '\\'){
-				bool escapedCntrlChr = true;
-				char escapedChar = JsonParser_next(state);
-				char replacementChar;
-
-				// For brevity.
-				#define ESCAPED_REPLACEMENT(escaped, replacement) \
-					case escaped: \
-						replacementChar = replacement; \
-						break
-
-				switch(escapedChar){
-					ESCAPED_REPLACEMENT('"', '"');
-					ESCAPED_REPLACEMENT('\\', '\\');
-					ESCAPED_REPLACEMENT('/', '/');
-					ESCAPED_REPLACEMENT('b', '\b');
-					ESCAPED_REPLACEMENT('f', '\f');
-					ESCAPED_REPLACEMENT('n', '\n');
-					ESCAPED_REPLACEMENT('r', '\r');
-					ESCAPED_REPLACEMENT('t', '\t');
-
-					default:
-						escapedCntrlChr = false;
-						break;
-				}
+			if(escapedCntrlChr){
+				JsonParser_pushChar(state, replacementChar);
+			}
 
-				if(escapedCntrlChr){
-					sb_push(str, replacementChar);
-				}
+			else if(escapedChar == 'u'){
+				int unicodeCodePoint;
 
-				else if(escapedChar == 'u'){
-					int unicodeCodePoint;
-
-					const char *inputStrPtr =
-						&state->inputStr[state->stringInd];
-					int numCharsRead;
-					int numItemsMatched = sscanf(
-						inputStrPtr, "%4x%n", &unicodeCodePoint, &numCharsRead);
-					if(numItemsMatched != 1 || numCharsRead != 4){
-						JsonParser_error(
-							state, JSON_ERR_STR_UNICODE_ESCAPE,
-							"Failed to read 4 hexadecimal characters", false);
-						goto error;
-					}
-					state->stringInd += 4;
-
-					char unicodeChr[4];
-					int numBytes = 0;
-					encodeUtf8CodePoint(unicodeCodePoint, &numBytes, unicodeChr);
-					for(int byte = 0; byte < numBytes; byte++){
-						sb_push(str, unicodeChr[byte]);
-					}
-				}
-				else {
+				const char *inputStrPtr = &state->inputStr[state->stringInd];
+				int numCharsRead;
+				int numItemsMatched = sscanf(
+					inputStrPtr, "%4x%n", &unicodeCodePoint, &numCharsRead);
+				if(numItemsMatched != 1 || numCharsRead != 4){
 					JsonParser_error(
-						state, JSON_ERR_STR_INVALID_ESCAPE,
-						"Invalid escaped character.", false);
-					goto error;
+						state, JSON_ERR_STR_UNICODE_ESCAPE,
+						"Failed to read 4 hexadecimal characters", true);
+				}
+				state->stringInd += 4;
+
+				char unicodeChr[4];
+				int numBytes = 0;
+				encodeUtf8CodePoint(unicodeCodePoint, &numBytes, unicodeChr);
+				for(int byte = 0; byte < numBytes; byte++){
+					JsonParser_pushChar(state, unicodeChr[byte]);
 				}
-			}
-			else if(iscntrl(chr)){
-				JsonParser_error(
-					state, JSON_ERR_STR_CONTROL_CHAR,
-					"Control characters inside strings are invalid.", false);
-				goto error;
 			}
 			else {
-				sb_push(str, chr);
+				JsonParser_error(
+					state, JSON_ERR_STR_INVALID_ESCAPE,
+					"Invalid escaped character.", true);
 			}
 		}
-		JsonParser_expect(state, '"');
-		copyJmpBuf(state->errorTrap, prevErrorTrap);
-		return (JsonString_t){
-			.length = sb_count(str),
-			.str = str
-		};
+		else if(iscntrl(chr)){
+			JsonParser_error(
+				state, JSON_ERR_STR_CONTROL_CHAR,
+				"Control characters inside strings are invalid.", true);
+		}
+		else {
+			JsonParser_pushChar(state, chr);
+		}
 	}
+	JsonParser_expect(state, '"');
 
-error:
-	sb_free(str);
-	longjmp(prevErrorTrap, 1);
+	JsonParserScratch_t *scratch = state->scratch;
+	char *str = NULL;
+	if(isKey && state->session != NULL){
+		str = JsonParserSession_intern(
+			state->session, scratch->chars, scratch->numChars);
+	}
+	if(str == NULL){
+		str = JsonParser_copyOut(
+			state, scratch->chars, scratch->numChars, false);
+	}
+	return (JsonString_t){
+		.length = scratch->numChars,
+		.str = str
+	};
 }
 
 /**
@@ -524,15 +852,16 @@ static void JsonParser_parseNumber(JsonParser_t *state, JsonVal_t *val){
 	// string contains a numeric format that `strtof()`/`strtod()` accept but
 	// the JSON spec does not, like say, 0xaf: the parser would only advance
 	// past the 0 and error later on, but `strtof()`/`strtod()` would read in
-	// the full hexadecimal value. This approach isn't ideal, but we'll stick
-	// to it in the interest of simplicity; also, there don't seem to be any
-	// immediate alternatives for parsing a number from a string while limiting
-	// the number of bytes read without some sort of intermediate allocations,
-	// anyway.
+	// the full hexadecimal value. The scratch string buffer is free while a
+	// number is being parsed, so it's reused for the copy.
 	int numChars = state->stringInd - numStartInd;
-	char *numStrBuf = malloc(numChars + 1);
-	memcpy(numStrBuf, state->inputStr + numStartInd, numChars);
-	numStrBuf[numChars] = '\0';
+	JsonParserScratch_t *scratch = state->scratch;
+	scratch->numChars = 0;
+	for(int chr = 0; chr < numChars; chr++){
+		JsonParser_pushChar(state, state->inputStr[numStartInd + chr]);
+	}
+	JsonParser_pushChar(state, '\0');
+	const char *numStrBuf = scratch->chars;
 
 	if(hasFraction){
 		float floatNum = strtof(numStrBuf, NULL);
@@ -544,8 +873,6 @@ static void JsonParser_parseNumber(JsonParser_t *state, JsonVal_t *val){
 		val->type = JSON_INT;
 		val->value.intNum = intNum;
 	}
-
-	free(numStrBuf);
 }
 
 static JsonObject_t JsonParser_parseObject(JsonParser_t *state){
@@ -561,8 +888,11 @@ static JsonObject_t JsonParser_parseObject(JsonParser_t *state){
 		};
 	}
 
-	JsonString_t *volatile keys = NULL;
-	JsonVal_t *volatile values = NULL;
+	// This object's keys and values are pushed onto the scratch stacks, above
+	// whatever the enclosing containers have pushed so far.
+	JsonParserScratch_t *scratch = state->scratch;
+	int keysBase = scratch->numKeys,
+		valuesBase = scratch->numValues;
 
 	jmp_buf prevErrorTrap;
 	copyJmpBuf(prevErrorTrap, state->errorTrap);
@@ -570,39 +900,58 @@ static JsonObject_t JsonParser_parseObject(JsonParser_t *state){
 	if(!setjmp(state->errorTrap)){
 		do {
 			JsonParser_skipWhitespace(state);
-			JsonString_t key = JsonParser_parseString(state);
-			sb_push(keys, key);
+			JsonParser_reserveKey(state);
+			JsonParser_pushKey(state, JsonParser_parseString(state, true));
 
 			JsonParser_skipWhitespace(state);
 			JsonParser_expect(state, ':');
 			JsonParser_skipWhitespace(state);
 
-			JsonVal_t value = JsonParser_parseValue(state);
-			sb_push(values, value);
+			JsonParser_reserveValue(state);
+			JsonParser_pushValue(state, JsonParser_parseValue(state));
+			JsonParser_skipWhitespace(state);
 		} while(JsonParser_nextIfChr(state, ','));
 
 		JsonParser_skipWhitespace(state);
 		JsonParser_expect(state, '}');
+
+		int length = scratch->numKeys - keysBase;
+		JsonString_t *keys = JsonParser_copyOut(
+			state, scratch->keys + keysBase, length * sizeof(JsonString_t),
+			true);
+		JsonVal_t *values = JsonParser_copyOut(
+			state, scratch->values + valuesBase, length * sizeof(JsonVal_t),
+			true);
+		if(keys == NULL || values == NULL){
+			JsonParser_freeBlock(state, keys, length * sizeof(JsonString_t));
+			JsonParser_freeBlock(state, values, length * sizeof(JsonVal_t));
+			JsonParser_error(
+				state, JSON_ERR_ALLOC, "Failed to allocate memory.", true);
+		}
+
+		scratch->numKeys = keysBase;
+		scratch->numValues = valuesBase;
 		copyJmpBuf(state->errorTrap, prevErrorTrap);
 		return (JsonObject_t){
-			.length = sb_count(keys),
+			.length = length,
 			.keys = keys,
 			.values = values
 		};
 	}
 	else {
-		// We iterate over `keys` and `values` separately since the number of
-		// keys and values might differ by 1 if, for a given key-value pair, a
-		// key was successfully parsed but the value parse failed.
-		for(int pair = 0; pair < sb_count(keys); pair++){
-			sb_free(keys[pair].str);
+		// We iterate over the keys and values separately since their number
+		// might differ by 1 if, for a given key-value pair, a key was
+		// successfully parsed but the value parse failed.
+		for(int pair = keysBase; pair < scratch->numKeys; pair++){
+			JsonParser_freeBlock(
+				state, scratch->keys[pair].str, scratch->keys[pair].length);
 		}
 
-		for(int pair = 0; pair < sb_count(values); pair++){
-			JsonVal_free(&values[pair]);
+		for(int pair = valuesBase; pair < scratch->numValues; pair++){
+			JsonParser_freeVal(state, &scratch->values[pair]);
 		}
-		sb_free(keys);
-		sb_free(values);
+		scratch->numKeys = keysBase;
+		scratch->numValues = valuesBase;
 		longjmp(prevErrorTrap, 1);
 	}
 }
@@ -619,30 +968,38 @@ static JsonArray_t JsonParser_parseArray(JsonParser_t *state){
 		};
 	}
 
+	JsonParserScratch_t *scratch = state->scratch;
+	int valuesBase = scratch->numValues;
+
 	jmp_buf prevErrorTrap;
 	copyJmpBuf(prevErrorTrap, state->errorTrap);
 
-	JsonVal_t *volatile values = NULL;
 	if(!setjmp(state->errorTrap)){
 		do {
 			JsonParser_skipWhitespace(state);
-			JsonVal_t val = JsonParser_parseValue(state);
-			sb_push(values, val);
+			JsonParser_reserveValue(state);
+			JsonParser_pushValue(state, JsonParser_parseValue(state));
 			JsonParser_skipWhitespace(state);
 		} while(JsonParser_nextIfChr(state, ','));
 
 		JsonParser_expect(state, ']');
+
+		int length = scratch->numValues - valuesBase;
+		JsonVal_t *values = JsonParser_copyOut(
+			state, scratch->values + valuesBase, length * sizeof(JsonVal_t),
+			false);
+		scratch->numValues = valuesBase;
 		copyJmpBuf(state->errorTrap, prevErrorTrap);
 		return (JsonArray_t){
-			.length = sb_count(values),
+			.length = length,
 			.values = values
 		};
 	}
 	else {
-		for(int ind = 0; ind < sb_count(values); ind++){
-			JsonVal_free(&values[ind]);
+		for(int ind = valuesBase; ind < scratch->numValues; ind++){
+			JsonParser_freeVal(state, &scratch->values[ind]);
 		}
-		sb_free(values);
+		scratch->numValues = valuesBase;
 		longjmp(prevErrorTrap, 1);
 	}
 }
@@ -703,7 +1060,7 @@ static JsonVal_t JsonParser_parseValue(JsonParser_t *state){
 
 	else if(peekedChar == '"'){
 		val.type = JSON_STRING;
-		val.value.string = JsonParser_parseString(state);
+		val.value.string = JsonParser_parseString(state, false);
 	}
 
 	else if(peekedChar == 'f' || peekedChar == 't'){
@@ -725,29 +1082,471 @@ static JsonVal_t JsonParser_parseValue(JsonParser_t *state){
 			state, JSON_ERR_VALUE, "Couldn't parse a value.\n", true);
 	}
 
+	if(state->stats != NULL){
+		state->stats->valuesByType[val.type]++;
+	}
 	return val;
 }
 
 JsonVal_t parse(
 	const char *src, bool isNullTerminated, int length, bool *failed,
 	JsonParserError_t *error){
-	JsonParser_t state = (JsonParser_t){
+	return parseWithOptions(
+		src, isNullTerminated, length, failed, error,
+		&(JsonParserOptions_t){.allocator = NULL, .stats = NULL});
+}
+
+/**
+ * Create the initial parser state for parsing `src` (see `parse()` for the
+ * meaning of the arguments).
+ */
+static JsonParser_t JsonParser_create(
+	const char *src, bool isNullTerminated, int length,
+	JsonParserScratch_t *scratch){
+	return (JsonParser_t){
 		.isNullTerminated = isNullTerminated,
-		.inputStrLength = length,
+		.inputStrLength = isNullTerminated ? (int)strlen(src) : length,
 		.colNum = 1,
 		.lineNum = 1,
 		.stringInd = 0,
-		.inputStr = src
+		.inputStr = src,
+		.scratch = scratch,
+		.error = {.errMsg = NULL}
 	};
+}
+
+/**
+ * Parse a single value using a fully set-up `state`, with `failed` and
+ * `error` behaving like they do for `parse()`.
+ */
+static JsonVal_t JsonParser_parse(
+	JsonParser_t *state, bool *failed, JsonParserError_t *error){
+	if(state->stats != NULL){
+		*state->stats = (JsonParserStats_t){.bytesConsumed = 0};
+	}
 
 	JsonVal_t parsedVal;
-	if(!setjmp(state.errorTrap)){
-		parsedVal = JsonParser_parseValue(&state);
+	if(!setjmp(state->errorTrap)){
+		JsonParser_skipWhitespace(state);
+		parsedVal = JsonParser_parseValue(state);
 		*failed = false;
 	}
 	else {
 		*failed = true;
-		*error = state.error;
+		*error = state->error;
+	}
+
+	if(state->stats != NULL){
+		state->stats->bytesConsumed = state->stringInd;
 	}
 	return parsedVal;
 }
+
+JsonVal_t parseWithOptions(
+	const char *src, bool isNullTerminated, int length, bool *failed,
+	JsonParserError_t *error, const JsonParserOptions_t *options){
+	JsonParserScratch_t scratch = {
+		.chars = NULL,
+		.keys = NULL,
+		.values = NULL,
+		.allocator = options->allocator
+	};
+	JsonParser_t state = JsonParser_create(
+		src, isNullTerminated, length, &scratch);
+	state.allocator = options->allocator;
+	state.stats = options->stats;
+
+	JsonVal_t parsedVal = JsonParser_parse(&state, failed, error);
+	JsonParserScratch_free(&scratch);
+	return parsedVal;
+}
+
+/**
+ * Deallocate the members of the schema struct `dest` that correspond to the
+ * fields of `schema` whose bits are set in `fieldMask`.
+ */
+static void JsonSchema_freeFields(
+	const JsonSchema_t *schema, void *dest, unsigned long long fieldMask){
+	for(int field = 0; field < schema->numFields; field++){
+		if(!(fieldMask & (1ULL << field))){
+			continue;
+		}
+
+		const JsonSchemaField_t *schemaField = &schema->fields[field];
+		char *member = (char *)dest + schemaField->offset;
+		JsonVal_t val = {.type = schemaField->type};
+		switch(schemaField->type){
+			case JSON_STRING:
+				val.value.string = *(JsonString_t *)member;
+				break;
+
+			case JSON_OBJECT:
+				val.value.object = *(JsonObject_t *)member;
+				break;
+
+			case JSON_ARRAY:
+				val.value.array = *(JsonArray_t *)member;
+				break;
+
+			default:
+				continue;
+		}
+		JsonVal_free(&val);
+	}
+}
+
+void JsonSchema_free(const JsonSchema_t *schema, void *dest){
+	JsonSchema_freeFields(schema, dest, ~0ULL);
+}
+
+/**
+ * Parse an object key directly out of the input string, without allocating
+ * it, and return the index of the matching field in `schema`. `expectedField`
+ * is checked first, since records tend to list their keys in the same order
+ * as the schema. Jump to the error-catching context if the key can't be read
+ * without unescaping it, or doesn't belong to the schema.
+ */
+static int JsonParser_parseSchemaKey(
+	JsonParser_t *state, const JsonSchema_t *schema, int expectedField){
+	JsonParser_expect(state, '"');
+	const char *key = state->inputStr + state->stringInd;
+	char chr;
+	while((chr = JsonParser_next(state)) != '"'){
+		if(chr == '\\' || iscntrl(chr)){
+			longjmp(state->errorTrap, 1);
+		}
+	}
+	int keyLength = state->inputStr + state->stringInd - 1 - key;
+
+	const JsonSchemaField_t *fields = schema->fields;
+	if(expectedField < schema->numFields &&
+		fields[expectedField].keyLength == keyLength &&
+		memcmp(fields[expectedField].key, key, keyLength) == 0){
+		return expectedField;
+	}
+
+	for(int field = 0; field < schema->numFields; field++){
+		if(fields[field].keyLength == keyLength &&
+			memcmp(fields[field].key, key, keyLength) == 0){
+			return field;
+		}
+	}
+	longjmp(state->errorTrap, 1);
+}
+
+/**
+ * Parse a value of the type required by `field` into the corresponding member
+ * of `dest`, jumping to the error-catching context if the next value in the
+ * input has a different type.
+ */
+static void JsonParser_parseSchemaValue(
+	JsonParser_t *state, const JsonSchemaField_t *field, void *dest){
+	char *member = (char *)dest + field->offset;
+	char peekedChar = JsonParser_peek(state);
+	switch(field->type){
+		case JSON_STRING:
+			if(peekedChar == '"'){
+				*(JsonString_t *)member = JsonParser_parseString(state, false);
+				return;
+			}
+			break;
+
+		case JSON_INT:
+		case JSON_FLOAT:
+			if(peekedChar == '-' || isdigit(peekedChar)){
+				JsonVal_t num;
+				JsonParser_parseNumber(state, &num);
+				if(field->type == JSON_FLOAT){
+					*(JsonFloat_t *)member = (num.type == JSON_FLOAT) ?
+						num.value.floatNum :
+						num.value.intNum;
+					return;
+				}
+				else if(num.type == JSON_INT){
+					*(JsonInt_t *)member = num.value.intNum;
+					return;
+				}
+			}
+			break;
+
+		case JSON_OBJECT:
+			if(peekedChar == '{'){
+				*(JsonObject_t *)member = JsonParser_parseObject(state);
+				return;
+			}
+			break;
+
+		case JSON_ARRAY:
+			if(peekedChar == '['){
+				*(JsonArray_t *)member = JsonParser_parseArray(state);
+				return;
+			}
+			break;
+
+		case JSON_BOOL:
+			if(peekedChar == 't' || peekedChar == 'f'){
+				*(JsonBool_t *)member = JsonParser_parseBoolean(state);
+				return;
+			}
+			break;
+
+		case JSON_NULL:
+			if(peekedChar == 'n'){
+				*(JsonNull_t *)member = JsonParser_parseNull(state);
+				return;
+			}
+			break;
+	}
+	longjmp(state->errorTrap, 1);
+}
+
+bool parseWithSchema(
+	const JsonSchema_t *schema, void *dest, const char *src,
+	bool isNullTerminated, int length, JsonVal_t *fallback, bool *failed,
+	JsonParserError_t *error){
+	// Parsed fields are tracked in the bits of a 64-bit mask.
+	if(schema->numFields > JSON_SCHEMA_MAX_FIELDS){
+		*fallback = parse(src, isNullTerminated, length, failed, error);
+		return false;
+	}
+
+	JsonParserScratch_t scratch = {.chars = NULL, .keys = NULL, .values = NULL};
+	JsonParser_t state = JsonParser_create(
+		src, isNullTerminated, length, &scratch);
+
+	// A bit is set for every field that's been written to `dest`, both to
+	// detect missing and duplicate keys, and to know which members to
+	// deallocate if the input turns out not to match the schema.
+	volatile unsigned long long parsedFields = 0;
+	if(!setjmp(state.errorTrap)){
+		JsonParser_skipWhitespace(&state);
+		JsonParser_expect(&state, '{');
+		int field = 0;
+		do {
+			JsonParser_skipWhitespace(&state);
+			field = JsonParser_parseSchemaKey(&state, schema, field);
+			if(parsedFields & (1ULL << field)){
+				longjmp(state.errorTrap, 1);
+			}
+
+			JsonParser_skipWhitespace(&state);
+			JsonParser_expect(&state, ':');
+			JsonParser_skipWhitespace(&state);
+
+			JsonParser_parseSchemaValue(&state, &schema->fields[field], dest);
+			parsedFields |= 1ULL << field;
+			field++;
+			JsonParser_skipWhitespace(&state);
+		} while(JsonParser_nextIfChr(&state, ','));
+
+		JsonParser_skipWhitespace(&state);
+		JsonParser_expect(&state, '}');
+
+		unsigned long long allFields =
+			(schema->numFields == JSON_SCHEMA_MAX_FIELDS) ?
+			~0ULL :
+			(1ULL << schema->numFields) - 1;
+		if(parsedFields == allFields){
+			JsonParserScratch_free(&scratch);
+			*failed = false;
+			return true;
+		}
+	}
+	JsonParserScratch_free(&scratch);
+
+	// Either the input doesn't match the schema, or it's malformed; in both
+	// cases, the generic parser takes over (and reports any actual errors).
+	JsonSchema_freeFields(schema, dest, parsedFields);
+	JsonParserError_free(&state.error);
+	*fallback = parse(src, isNullTerminated, length, failed, error);
+	return false;
+}
+
+/**
+ * Return `size` bytes from `arena`, or `NULL` if a new chunk was needed but
+ * couldn't be allocated. Chunks left over from before the last
+ * `JsonArena_reset()` are reused (and lazily emptied) before any new ones are
+ * allocated.
+ */
+static void *JsonArena_alloc(JsonArena_t *arena, size_t size){
+	// Keep every block pointer-aligned.
+	size = (size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+
+	JsonArenaChunk_t *chunk = arena->current;
+	while(chunk != NULL && chunk->used + size > chunk->size){
+		chunk = chunk->next;
+		if(chunk != NULL){
+			chunk->used = 0;
+		}
+	}
+
+	if(chunk == NULL){
+		size_t chunkSize = (arena->current == NULL) ?
+			JSON_ARENA_CHUNK_SIZE :
+			2 * arena->current->size;
+		if(chunkSize < size){
+			chunkSize = size;
+		}
+
+		chunk = JsonAllocator_alloc(
+			arena->allocator, sizeof(JsonArenaChunk_t) + chunkSize);
+		if(chunk == NULL){
+			return NULL;
+		}
+		chunk->size = chunkSize;
+		chunk->used = 0;
+
+		// Splice the new chunk in after the current one, ahead of any
+		// too-small leftover chunks, so that none are lost.
+		if(arena->current == NULL){
+			chunk->next = NULL;
+			arena->first = chunk;
+		}
+		else {
+			chunk->next = arena->current->next;
+			arena->current->next = chunk;
+		}
+	}
+
+	arena->current = chunk;
+	void *block = chunk->data + chunk->used;
+	chunk->used += size;
+	return block;
+}
+
+/**
+ * Release everything allocated from `arena` in O(1), keeping its chunks.
+ */
+static void JsonArena_reset(JsonArena_t *arena){
+	arena->current = arena->first;
+	if(arena->first != NULL){
+		arena->first->used = 0;
+	}
+}
+
+static void JsonArena_free(JsonArena_t *arena){
+	JsonArenaChunk_t *chunk = arena->first;
+	while(chunk != NULL){
+		JsonArenaChunk_t *next = chunk->next;
+		JsonAllocator_free(
+			arena->allocator, chunk, sizeof(JsonArenaChunk_t) + chunk->size);
+		chunk = next;
+	}
+}
+
+/**
+ * The `JsonAllocator_t` functions of a session, which allocate from its value
+ * arena; individual blocks are never deallocated, but reclaimed all at once
+ * when the session is reset.
+ */
+static void *JsonParserSession_realloc(
+	void *context, void *ptr, size_t oldSize, size_t size){
+	JsonParserSession_t *session = context;
+	void *block = JsonArena_alloc(&session->valueArena, size);
+	if(block != NULL && ptr != NULL){
+		memcpy(block, ptr, (oldSize < size) ? oldSize : size);
+	}
+	return block;
+}
+
+static void JsonParserSession_noopFree(void *context, void *ptr, size_t size){
+	(void)context;
+	(void)ptr;
+	(void)size;
+}
+
+static char *JsonParserSession_intern(
+	JsonParserSession_t *session, const char *key, int length){
+	const int tableSize = 2 * JSON_SESSION_MAX_INTERNED_KEYS;
+	if(length == 0){
+		return NULL;
+	}
+
+	if(session->internedKeys == NULL){
+		session->internedKeys = JsonAllocator_alloc(
+			session->backingAllocator, tableSize * sizeof(JsonString_t));
+		if(session->internedKeys == NULL){
+			return NULL;
+		}
+		memset(session->internedKeys, 0, tableSize * sizeof(JsonString_t));
+	}
+
+	uint32_t hash = 2166136261u;
+	for(int chr = 0; chr < length; chr++){
+		hash = (hash ^ (unsigned char)key[chr]) * 16777619u;
+	}
+
+	int slot = hash & (tableSize - 1);
+	JsonString_t *entry;
+	while((entry = &session->internedKeys[slot])->str != NULL){
+		if(entry->length == length && memcmp(entry->str, key, length) == 0){
+			return entry->str;
+		}
+		slot = (slot + 1) & (tableSize - 1);
+	}
+
+	if(session->numInternedKeys == JSON_SESSION_MAX_INTERNED_KEYS){
+		return NULL;
+	}
+
+	char *internedKey = JsonArena_alloc(&session->keyArena, length);
+	if(internedKey == NULL){
+		return NULL;
+	}
+	memcpy(internedKey, key, length);
+	*entry = (JsonString_t){
+		.length = length,
+		.str = internedKey
+	};
+	session->numInternedKeys++;
+	return internedKey;
+}
+
+JsonParserSession_t *JsonParserSession_create(void){
+	return JsonParserSession_createWithAllocator(NULL);
+}
+
+JsonParserSession_t *JsonParserSession_createWithAllocator(
+	const JsonAllocator_t *allocator){
+	JsonParserSession_t *session =
+		JsonAllocator_alloc(allocator, sizeof(JsonParserSession_t));
+	if(session != NULL){
+		*session = (JsonParserSession_t){
+			.backingAllocator = allocator,
+			.valueArena = {.allocator = allocator},
+			.allocator = {
+				.realloc = JsonParserSession_realloc,
+				.free = JsonParserSession_noopFree,
+				.context = session
+			},
+			.scratch = {.allocator = allocator},
+			.keyArena = {.allocator = allocator}
+		};
+	}
+	return session;
+}
+
+void JsonParserSession_destroy(JsonParserSession_t *session){
+	const JsonAllocator_t *allocator = session->backingAllocator;
+	JsonArena_free(&session->valueArena);
+	JsonArena_free(&session->keyArena);
+	JsonParserScratch_free(&session->scratch);
+	JsonAllocator_free(
+		allocator, session->internedKeys,
+		2 * JSON_SESSION_MAX_INTERNED_KEYS * sizeof(JsonString_t));
+	JsonAllocator_free(allocator, session, sizeof(JsonParserSession_t));
+}
+
+JsonVal_t JsonParserSession_parse(
+	JsonParserSession_t *session, const char *src, bool isNullTerminated,
+	int length, bool *failed, JsonParserError_t *error){
+	JsonArena_reset(&session->valueArena);
+	session->scratch.numKeys = 0;
+	session->scratch.numValues = 0;
+
+	JsonParser_t state = JsonParser_create(
+		src, isNullTerminated, length, &session->scratch);
+	state.allocator = &session->allocator;
+	state.session = session;
+	return JsonParser_parse(&state, failed, error);
+}
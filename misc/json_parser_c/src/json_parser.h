@@ -5,6 +5,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
 
 /**
  * The following types are used to represent JSON values. `JsonVal_t` is the
@@ -87,7 +88,8 @@ typedef enum {
 	JSON_ERR_STR_CONTROL_CHAR,
 	JSON_ERR_BOOL,
 	JSON_ERR_NUMBER,
-	JSON_ERR_VALUE
+	JSON_ERR_VALUE,
+	JSON_ERR_ALLOC
 } JsonParserErrorType_t;
 
 // A parser error.
@@ -108,12 +110,200 @@ JsonVal_t parse(
 	const char *src, bool isNullTerminated, int length, bool *failed,
 	JsonParserError_t *error);
 
+/**
+ * The following types let the user plug a custom allocator into the parser,
+ * and collect counters about a single parse (for sizing arenas, or spotting
+ * pathological inputs), via `parseWithOptions()`.
+ */
+
+// A custom allocator for the blocks that make up parsed values, and the
+// scratch buffers the parser grows while building them. `realloc` must
+// behave like the standard `realloc()` (`ptr` may be `NULL`, in which case
+// `oldSize` is 0), and may return `NULL` to signal failure, which aborts the
+// parse with `JSON_ERR_ALLOC`. The old and current sizes of each block are
+// passed back in, so the allocator doesn't need to track them itself.
+// `context` is passed through untouched.
+typedef struct {
+	void *(*realloc)(void *context, void *ptr, size_t oldSize, size_t size);
+	void (*free)(void *context, void *ptr, size_t size);
+	void *context;
+} JsonAllocator_t;
+
+// Counters for a single parse.
+typedef struct {
+	int bytesConsumed; // The number of input bytes the parser advanced past.
+	int valuesByType[JSON_NULL + 1]; // Parsed values, indexed by `JsonType_t`.
+	int allocations; // The number of blocks allocated for the parsed value.
+	int reallocations; // The number of times a scratch buffer had to grow.
+	// The bytes currently held by the parsed value; blocks released while a
+	// failed parse unwinds are taken off again, leaving it at 0.
+	size_t domBytes;
+	size_t peakDomBytes; // The high-water mark of `domBytes`.
+} JsonParserStats_t;
+
+typedef struct {
+	// The allocator used for every value; `NULL` for `malloc()` and friends.
+	const JsonAllocator_t *allocator;
+	// If not `NULL`, reset and then updated with counters for the parse.
+	JsonParserStats_t *stats;
+} JsonParserOptions_t;
+
+/**
+ * Like `parse()`, but with the custom allocator and/or counters in `options`.
+ * A value parsed with a custom allocator must be deallocated with
+ * `JsonVal_freeWithAllocator()`.
+ */
+JsonVal_t parseWithOptions(
+	const char *src, bool isNullTerminated, int length, bool *failed,
+	JsonParserError_t *error, const JsonParserOptions_t *options);
+
+/**
+ * A parse session, for parsing many documents one after the other without
+ * allocating memory in the steady state. It owns an arena that every value is
+ * allocated from, the parser's scratch buffers, and a table of interned object
+ * keys, all of which are kept across documents; starting a new document is
+ * O(1).
+ */
+typedef struct JsonParserSession JsonParserSession_t;
+
+/**
+ * Allocate a `JsonParserSession_t`, or return `NULL` if memory couldn't be
+ * allocated. Must be deallocated with `JsonParserSession_destroy()`.
+ */
+JsonParserSession_t *JsonParserSession_create(void);
+
+/**
+ * Like `JsonParserSession_create()`, but the session's own memory is allocated
+ * with `allocator` (which may be `NULL` for the default one), which must
+ * outlive it.
+ */
+JsonParserSession_t *JsonParserSession_createWithAllocator(
+	const JsonAllocator_t *allocator);
+
+/**
+ * Deallocate `session`, along with every value parsed in it.
+ */
+void JsonParserSession_destroy(JsonParserSession_t *session);
+
+/**
+ * Like `parse()`, but allocates from `session`. The returned value is owned by
+ * the session and stays valid until the next call to
+ * `JsonParserSession_parse()` or `JsonParserSession_destroy()`; it must *not*
+ * be passed to `JsonVal_free()`.
+ */
+JsonVal_t JsonParserSession_parse(
+	JsonParserSession_t *session, const char *src, bool isNullTerminated,
+	int length, bool *failed, JsonParserError_t *error);
+
+/**
+ * The following types describe a known record shape (a "schema"): a JSON
+ * object with a fixed set of keys, whose values are decoded straight into the
+ * members of a user-defined C struct by `parseWithSchema()`. This skips the
+ * allocation of the generic `JsonObject_t` keys and values arrays entirely,
+ * and matches keys against the lengths and contents precomputed in the schema
+ * rather than building and comparing `JsonString_t`s.
+ */
+
+// A single field of a schema.
+typedef struct {
+	const char *key; // The field's key.
+	int keyLength; // The length of `key`, excluding the null-terminator.
+	JsonType_t type; // The type of value expected for `key`.
+	size_t offset; // The offset of the destination member in the user struct.
+} JsonSchemaField_t;
+
+// The most fields a schema can have; `parseWithSchema()` hands every input to
+// `parse()` for larger ones.
+#define JSON_SCHEMA_MAX_FIELDS 64
+
+// A full schema, of no more than `JSON_SCHEMA_MAX_FIELDS` fields.
+typedef struct {
+	int numFields;
+	const JsonSchemaField_t *fields;
+} JsonSchema_t;
+
+// The C types that each `JsonType_t` decodes to inside a schema struct, for use
+// by `JSON_SCHEMA_MEMBER()`.
+#define JSON_SCHEMA_CTYPE_STRING JsonString_t
+#define JSON_SCHEMA_CTYPE_INT JsonInt_t
+#define JSON_SCHEMA_CTYPE_FLOAT JsonFloat_t
+#define JSON_SCHEMA_CTYPE_OBJECT JsonObject_t
+#define JSON_SCHEMA_CTYPE_ARRAY JsonArray_t
+#define JSON_SCHEMA_CTYPE_BOOL JsonBool_t
+#define JSON_SCHEMA_CTYPE_NULL JsonNull_t
+
+/**
+ * X-macros for generating both a record struct and its schema from a single
+ * field list, where every field is declared as `FIELD(structType, member,
+ * valType)` and `valType` is one of `JsonType_t`'s names minus the `JSON_`
+ * prefix. For example:
+ *
+ *     #define POINT_FIELDS(FIELD) \
+ *         FIELD(Point_t, x, FLOAT) \
+ *         FIELD(Point_t, y, FLOAT) \
+ *         FIELD(Point_t, label, STRING)
+ *
+ *     typedef struct {
+ *         POINT_FIELDS(JSON_SCHEMA_MEMBER)
+ *     } Point_t;
+ *
+ *     static const JsonSchemaField_t pointFields[] = {
+ *         POINT_FIELDS(JSON_SCHEMA_FIELD)
+ *     };
+ *     static const JsonSchema_t pointSchema = JSON_SCHEMA(pointFields);
+ */
+#define JSON_SCHEMA_MEMBER(structType, member, valType) \
+	JSON_SCHEMA_CTYPE_##valType member;
+
+#define JSON_SCHEMA_FIELD(structType, member, valType) \
+	{ \
+		.key = #member, \
+		.keyLength = sizeof(#member) - 1, \
+		.type = JSON_##valType, \
+		.offset = offsetof(structType, member) \
+	},
+
+#define JSON_SCHEMA(fieldsArray) \
+	{ \
+		.numFields = sizeof(fieldsArray) / sizeof((fieldsArray)[0]), \
+		.fields = fieldsArray \
+	}
+
+/**
+ * Parse an object that's expected to match `schema` from `src` (with
+ * `isNullTerminated` and `length` behaving like they do for `parse()`),
+ * writing its values into the struct pointed to by `dest` and returning
+ * `true`. Every field in `schema` must be present exactly once, with no other
+ * keys (or escape sequences inside the keys); `JSON_FLOAT` fields also accept
+ * integers. If the input doesn't match, it's handed off to `parse()` instead:
+ * `false` is returned, `*fallback`, `*failed` and `*error` are set just like
+ * `parse()`'s return value and arguments would be, and the contents of `dest`
+ * are unspecified.
+ */
+bool parseWithSchema(
+	const JsonSchema_t *schema, void *dest, const char *src,
+	bool isNullTerminated, int length, JsonVal_t *fallback, bool *failed,
+	JsonParserError_t *error);
+
+/**
+ * Deallocate the members of a struct populated by `parseWithSchema()`; `dest`
+ * itself will *not* be free'd.
+ */
+void JsonSchema_free(const JsonSchema_t *schema, void *dest);
+
 /**
  * Recursively deallocate a value returned by `parse()`. Note that the `val`
  * pointer itself will *not* be free'd.
  */
 void JsonVal_free(JsonVal_t *val);
 
+/**
+ * Like `JsonVal_free()`, for values returned by `parseWithOptions()` with a
+ * custom `allocator` (which may be `NULL` for the default one).
+ */
+void JsonVal_freeWithAllocator(
+	JsonVal_t *val, const JsonAllocator_t *allocator);
+
 /**
  * Intended for debugging: recursively print the contents of `val` to stdout.
  * This will look more or less like JSON.
@@ -0,0 +1,529 @@
+/**
+ * The JSONPath query compiler and evaluator. See `json_path.h` for the
+ * supported syntax.
+ *
+ * A path is compiled into an array of `JsonPathOp_t` selectors, one per path
+ * segment, with every key and string literal pre-split and length-prefixed so
+ * that matching them against a document is a plain length check and
+ * `memcmp()`. Evaluation walks the selectors and the document in lockstep: each
+ * selector maps the current value to zero or more child values, and the
+ * remaining selectors are recursively applied to each of them until none are
+ * left, at which point the value is a match. Only the subtrees that a selector
+ * actually selects are ever visited.
+ */
+
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "json_path.h"
+#include "src/stretchy_buffer.h"
+
+typedef enum {
+	JSON_PATH_KEY, // An object member.
+	JSON_PATH_INDEX, // An array element.
+	JSON_PATH_WILDCARD, // Every member/element.
+	JSON_PATH_DESCENT, // The current value and all of its descendants.
+	JSON_PATH_FILTER // Every member/element that passes a filter.
+} JsonPathOpType_t;
+
+typedef enum {
+	JSON_PATH_EXISTS,
+	JSON_PATH_EQ,
+	JSON_PATH_NE,
+	JSON_PATH_LT,
+	JSON_PATH_LE,
+	JSON_PATH_GT,
+	JSON_PATH_GE
+} JsonPathComparison_t;
+
+// A single compiled selector.
+typedef struct {
+	JsonPathOpType_t type;
+	JsonString_t key; // The member name for `JSON_PATH_KEY`.
+	int index; // The element index for `JSON_PATH_INDEX`.
+
+	// The `@.a.b` member chain, comparison, and literal of a
+	// `JSON_PATH_FILTER`. `filterKeys` is a stretchy buffer.
+	JsonString_t *filterKeys;
+	JsonPathComparison_t comparison;
+	JsonVal_t literal;
+} JsonPathOp_t;
+
+struct JsonPath {
+	JsonPathOp_t *ops; // A stretchy buffer of the compiled selectors.
+
+	// A copy of the path string, which all the keys and string literals in
+	// `ops` point into.
+	char *source;
+};
+
+// The state of a path compilation.
+typedef struct {
+	const char *src; // The (null-terminated) path being compiled.
+	int ind; // The compiler's current index inside `src`.
+} JsonPathCompiler_t;
+
+// The state of a path evaluation.
+typedef struct {
+	JsonPathCallback_t callback;
+	void *context;
+	int numMatches;
+} JsonPathEval_t;
+
+static void JsonPathCompiler_skipWhitespace(JsonPathCompiler_t *compiler){
+	while(isspace(compiler->src[compiler->ind])){
+		compiler->ind++;
+	}
+}
+
+/**
+ * Advance the compiler past `str` if the input continues with it.
+ */
+static bool JsonPathCompiler_nextIfStr(
+	JsonPathCompiler_t *compiler, const char *str){
+	int length = strlen(str);
+	bool matches = strncmp(compiler->src + compiler->ind, str, length) == 0;
+	if(matches){
+		compiler->ind += length;
+	}
+	return matches;
+}
+
+static bool isKeyChr(char chr){
+	return isalnum(chr) || chr == '_' || chr == '-' || chr == '$';
+}
+
+/**
+ * Read a dot-notation member name into `*key`; return `false` if there isn't
+ * one.
+ */
+static bool JsonPathCompiler_key(
+	JsonPathCompiler_t *compiler, JsonString_t *key){
+	int startInd = compiler->ind;
+	while(isKeyChr(compiler->src[compiler->ind])){
+		compiler->ind++;
+	}
+	*key = (JsonString_t){
+		.length = compiler->ind - startInd,
+		.str = (char *)compiler->src + startInd
+	};
+	return key->length > 0;
+}
+
+/**
+ * Read a single- or double-quoted string into `*str`; return `false` if there
+ * isn't one.
+ */
+static bool JsonPathCompiler_string(
+	JsonPathCompiler_t *compiler, JsonString_t *str){
+	char quote = compiler->src[compiler->ind];
+	if(quote != '\'' && quote != '"'){
+		return false;
+	}
+
+	const char *start = compiler->src + compiler->ind + 1;
+	const char *end = strchr(start, quote);
+	if(end == NULL){
+		return false;
+	}
+
+	*str = (JsonString_t){
+		.length = end - start,
+		.str = (char *)start
+	};
+	compiler->ind += str->length + 2;
+	return true;
+}
+
+/**
+ * Read an optionally negative integer into `*num`; return `false` if there
+ * isn't one, or it doesn't fit in an `int` (and so couldn't index an array).
+ */
+static bool JsonPathCompiler_int(JsonPathCompiler_t *compiler, int *num){
+	const char *start = compiler->src + compiler->ind;
+	char *end;
+	errno = 0;
+	long parsed = strtol(start, &end, 10);
+	if(end == start || !(isdigit(*start) || *start == '-') ||
+		errno == ERANGE || parsed < INT_MIN || parsed > INT_MAX){
+		return false;
+	}
+	*num = parsed;
+	compiler->ind += end - start;
+	return true;
+}
+
+/**
+ * Read a filter literal (see `json_path.h`) into `*literal`; return `false` if
+ * there isn't one.
+ */
+static bool JsonPathCompiler_literal(
+	JsonPathCompiler_t *compiler, JsonVal_t *literal){
+	char peekedChar = compiler->src[compiler->ind];
+	if(JsonPathCompiler_string(compiler, &literal->value.string)){
+		literal->type = JSON_STRING;
+	}
+	else if(JsonPathCompiler_nextIfStr(compiler, "true")){
+		*literal = CREATE_JSON_VAL(JSON_BOOL, {.boolean = true});
+	}
+	else if(JsonPathCompiler_nextIfStr(compiler, "false")){
+		*literal = CREATE_JSON_VAL(JSON_BOOL, {.boolean = false});
+	}
+	else if(JsonPathCompiler_nextIfStr(compiler, "null")){
+		*literal = CREATE_JSON_VAL(JSON_NULL, {.null = 0});
+	}
+	else if(peekedChar == '-' || isdigit(peekedChar)){
+		const char *start = compiler->src + compiler->ind;
+		char *end;
+		*literal = CREATE_JSON_VAL(
+			JSON_FLOAT, {.floatNum = strtod(start, &end)});
+		compiler->ind += end - start;
+	}
+	else {
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Compile the body of a `[?(...)]` filter, starting right after the `?(`,
+ * into `op`.
+ */
+static bool JsonPathCompiler_filter(
+	JsonPathCompiler_t *compiler, JsonPathOp_t *op){
+	op->type = JSON_PATH_FILTER;
+	op->comparison = JSON_PATH_EXISTS;
+
+	JsonPathCompiler_skipWhitespace(compiler);
+	if(!JsonPathCompiler_nextIfStr(compiler, "@")){
+		return false;
+	}
+
+	while(JsonPathCompiler_nextIfStr(compiler, ".")){
+		JsonString_t key;
+		if(!JsonPathCompiler_key(compiler, &key)){
+			return false;
+		}
+		sb_push(op->filterKeys, key);
+	}
+	JsonPathCompiler_skipWhitespace(compiler);
+
+	// Two-character operators must be checked before their one-character
+	// prefixes.
+	static const struct {
+		const char *str;
+		JsonPathComparison_t comparison;
+	} operators[] = {
+		{"==", JSON_PATH_EQ},
+		{"!=", JSON_PATH_NE},
+		{"<=", JSON_PATH_LE},
+		{">=", JSON_PATH_GE},
+		{"<", JSON_PATH_LT},
+		{">", JSON_PATH_GT}
+	};
+	for(size_t ind = 0; ind < sizeof(operators) / sizeof(operators[0]); ind++){
+		if(JsonPathCompiler_nextIfStr(compiler, operators[ind].str)){
+			op->comparison = operators[ind].comparison;
+			JsonPathCompiler_skipWhitespace(compiler);
+			if(!JsonPathCompiler_literal(compiler, &op->literal)){
+				return false;
+			}
+			JsonPathCompiler_skipWhitespace(compiler);
+			break;
+		}
+	}
+
+	return JsonPathCompiler_nextIfStr(compiler, ")");
+}
+
+/**
+ * Compile a bracketed selector, starting right after the `[`, into `op`.
+ */
+static bool JsonPathCompiler_bracket(
+	JsonPathCompiler_t *compiler, JsonPathOp_t *op){
+	JsonPathCompiler_skipWhitespace(compiler);
+	bool compiled;
+	if(JsonPathCompiler_nextIfStr(compiler, "*")){
+		op->type = JSON_PATH_WILDCARD;
+		compiled = true;
+	}
+	else if(JsonPathCompiler_nextIfStr(compiler, "?(")){
+		compiled = JsonPathCompiler_filter(compiler, op);
+	}
+	else if(JsonPathCompiler_string(compiler, &op->key)){
+		op->type = JSON_PATH_KEY;
+		compiled = true;
+	}
+	else {
+		op->type = JSON_PATH_INDEX;
+		compiled = JsonPathCompiler_int(compiler, &op->index);
+	}
+
+	JsonPathCompiler_skipWhitespace(compiler);
+	return compiled && JsonPathCompiler_nextIfStr(compiler, "]");
+}
+
+/**
+ * Compile a member selector that follows a `.` or `..` into `op`.
+ */
+static bool JsonPathCompiler_member(
+	JsonPathCompiler_t *compiler, JsonPathOp_t *op){
+	if(JsonPathCompiler_nextIfStr(compiler, "*")){
+		op->type = JSON_PATH_WILDCARD;
+		return true;
+	}
+	op->type = JSON_PATH_KEY;
+	return JsonPathCompiler_key(compiler, &op->key);
+}
+
+JsonPath_t *JsonPath_compile(const char *pathStr){
+	JsonPath_t *path = malloc(sizeof(JsonPath_t));
+	if(path == NULL){
+		return NULL;
+	}
+	int pathLength = strlen(pathStr);
+	path->ops = NULL;
+	path->source = malloc(pathLength + 1);
+	if(path->source != NULL){
+		memcpy(path->source, pathStr, pathLength + 1);
+	}
+
+	JsonPathCompiler_t compiler = {
+		.src = path->source,
+		.ind = 0
+	};
+	if(path->source == NULL || !JsonPathCompiler_nextIfStr(&compiler, "$")){
+		JsonPath_free(path);
+		return NULL;
+	}
+
+	while(compiler.src[compiler.ind] != '\0'){
+		JsonPathOp_t op = {.filterKeys = NULL};
+		bool compiled;
+		if(JsonPathCompiler_nextIfStr(&compiler, "..")){
+			sb_push(path->ops, (JsonPathOp_t){.type = JSON_PATH_DESCENT});
+			compiled = JsonPathCompiler_nextIfStr(&compiler, "[") ?
+				JsonPathCompiler_bracket(&compiler, &op) :
+				JsonPathCompiler_member(&compiler, &op);
+		}
+		else if(JsonPathCompiler_nextIfStr(&compiler, ".")){
+			compiled = JsonPathCompiler_member(&compiler, &op);
+		}
+		else if(JsonPathCompiler_nextIfStr(&compiler, "[")){
+			compiled = JsonPathCompiler_bracket(&compiler, &op);
+		}
+		else {
+			compiled = false;
+		}
+
+		// `op` is pushed even if it failed to compile, so that any
+		// `filterKeys` it holds get deallocated by `JsonPath_free()`.
+		sb_push(path->ops, op);
+		if(!compiled){
+			JsonPath_free(path);
+			return NULL;
+		}
+	}
+
+	return path;
+}
+
+void JsonPath_free(JsonPath_t *path){
+	for(int op = 0; op < sb_count(path->ops); op++){
+		sb_free(path->ops[op].filterKeys);
+	}
+	sb_free(path->ops);
+	free(path->source);
+	free(path);
+}
+
+/**
+ * Return the value of the member of `obj` named `key`, or `NULL` if there
+ * isn't one.
+ */
+static JsonVal_t *JsonPath_findMember(JsonVal_t *obj, const JsonString_t *key){
+	if(obj->type != JSON_OBJECT){
+		return NULL;
+	}
+
+	JsonObject_t *object = &obj->value.object;
+	for(int pair = 0; pair < object->length; pair++){
+		if(object->keys[pair].length == key->length &&
+			memcmp(object->keys[pair].str, key->str, key->length) == 0){
+			return &object->values[pair];
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Compare `val` against a filter's literal, returning `true` if it satisfies
+ * `comparison`. Numbers are compared numerically and strings bytewise;
+ * booleans and `null` can only be tested for (in)equality.
+ */
+static bool JsonPath_compare(
+	const JsonVal_t *val, JsonPathComparison_t comparison,
+	const JsonVal_t *literal){
+	int order;
+	if((val->type == JSON_INT || val->type == JSON_FLOAT) &&
+		literal->type == JSON_FLOAT){
+		double num = (val->type == JSON_INT) ?
+			val->value.intNum :
+			val->value.floatNum;
+		double literalNum = literal->value.floatNum;
+		order = (num > literalNum) - (num < literalNum);
+	}
+	else if(val->type == JSON_STRING && literal->type == JSON_STRING){
+		const JsonString_t *str = &val->value.string,
+			*literalStr = &literal->value.string;
+		int minLength = (str->length < literalStr->length) ?
+			str->length :
+			literalStr->length;
+		order = memcmp(str->str, literalStr->str, minLength);
+		if(order == 0){
+			order = str->length - literalStr->length;
+		}
+	}
+	else {
+		bool equal = val->type == literal->type && (
+			val->type == JSON_NULL ||
+			(val->type == JSON_BOOL &&
+				!val->value.boolean == !literal->value.boolean));
+		if(comparison == JSON_PATH_EQ){
+			return equal;
+		}
+		return comparison == JSON_PATH_NE && !equal;
+	}
+
+	switch(comparison){
+		case JSON_PATH_EQ:
+			return order == 0;
+		case JSON_PATH_NE:
+			return order != 0;
+		case JSON_PATH_LT:
+			return order < 0;
+		case JSON_PATH_LE:
+			return order <= 0;
+		case JSON_PATH_GT:
+			return order > 0;
+		case JSON_PATH_GE:
+			return order >= 0;
+		default:
+			return true;
+	}
+}
+
+/**
+ * Whether `val` passes the filter compiled into `op`.
+ */
+static bool JsonPath_filter(const JsonPathOp_t *op, JsonVal_t *val){
+	for(int key = 0; key < sb_count(op->filterKeys) && val != NULL; key++){
+		val = JsonPath_findMember(val, &op->filterKeys[key]);
+	}
+
+	if(val == NULL){
+		return false;
+	}
+	return op->comparison == JSON_PATH_EXISTS ||
+		JsonPath_compare(val, op->comparison, &op->literal);
+}
+
+/**
+ * Apply the `numOps` selectors starting at `ops` to `val`, reporting every
+ * match to `eval`. Return `false` if the evaluation was stopped by the
+ * callback.
+ */
+static bool JsonPath_evalOps(
+	const JsonPathOp_t *ops, int numOps, JsonVal_t *val,
+	JsonPathEval_t *eval){
+	if(numOps == 0){
+		eval->numMatches++;
+		return eval->callback == NULL || eval->callback(val, eval->context);
+	}
+
+	int numChildren = 0;
+	JsonVal_t *children = NULL;
+	if(val->type == JSON_OBJECT){
+		numChildren = val->value.object.length;
+		children = val->value.object.values;
+	}
+	else if(val->type == JSON_ARRAY){
+		numChildren = val->value.array.length;
+		children = val->value.array.values;
+	}
+
+	switch(ops->type){
+		case JSON_PATH_KEY:{
+			JsonVal_t *member = JsonPath_findMember(val, &ops->key);
+			return member == NULL ||
+				JsonPath_evalOps(ops + 1, numOps - 1, member, eval);
+		}
+
+		case JSON_PATH_INDEX:{
+			if(val->type != JSON_ARRAY){
+				return true;
+			}
+			int index = (ops->index < 0) ?
+				numChildren + ops->index :
+				ops->index;
+			return index < 0 || index >= numChildren ||
+				JsonPath_evalOps(ops + 1, numOps - 1, &children[index], eval);
+		}
+
+		case JSON_PATH_WILDCARD:
+		case JSON_PATH_FILTER:
+			for(int child = 0; child < numChildren; child++){
+				if(ops->type == JSON_PATH_FILTER &&
+					!JsonPath_filter(ops, &children[child])){
+					continue;
+				}
+				if(!JsonPath_evalOps(
+					ops + 1, numOps - 1, &children[child], eval)){
+					return false;
+				}
+			}
+			return true;
+
+		case JSON_PATH_DESCENT:
+			if(!JsonPath_evalOps(ops + 1, numOps - 1, val, eval)){
+				return false;
+			}
+			for(int child = 0; child < numChildren; child++){
+				if(!JsonPath_evalOps(ops, numOps, &children[child], eval)){
+					return false;
+				}
+			}
+			return true;
+	}
+	return true;
+}
+
+int JsonPath_eval(
+	const JsonPath_t *path, JsonVal_t *doc, JsonPathCallback_t callback,
+	void *context){
+	JsonPathEval_t eval = {
+		.callback = callback,
+		.context = context,
+		.numMatches = 0
+	};
+	JsonPath_evalOps(path->ops, sb_count(path->ops), doc, &eval);
+	return eval.numMatches;
+}
+
+/**
+ * A `JsonPathCallback_t` for `JsonPath_first()` that stores the first match in
+ * `*context` and stops the evaluation.
+ */
+static bool JsonPath_storeFirst(JsonVal_t *match, void *context){
+	*(JsonVal_t **)context = match;
+	return false;
+}
+
+JsonVal_t *JsonPath_first(const JsonPath_t *path, JsonVal_t *doc){
+	JsonVal_t *first = NULL;
+	JsonPath_eval(path, doc, JsonPath_storeFirst, &first);
+	return first;
+}
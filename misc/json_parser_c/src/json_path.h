@@ -0,0 +1,61 @@
+/**
+ * Compiled JSONPath-style queries over values returned by `parse()`. A path
+ * string is compiled once into a flat list of selectors with
+ * `JsonPath_compile()`, and can then be evaluated against any number of
+ * documents without re-interpreting it.
+ *
+ * The supported syntax is a practical subset of JSONPath:
+ *
+ *     $              the root value (must begin every path)
+ *     .key  ['key']  an object member
+ *     [3]  [-1]      an array element, counting from the end if negative
+ *     .*  [*]        every member/element
+ *     ..key  ..*     recursive descent: the selector that follows is applied
+ *                    to the current value and all of its descendants
+ *     [?(@.a.b)]     every member/element that contains `a.b`
+ *     [?(@.a op v)]  every member/element whose `a` compares true against the
+ *                    literal `v` (a number, 'string', "string", true, false or
+ *                    null), where `op` is one of ==, !=, <, <=, >, >=
+ *
+ * Strings inside paths can't contain escape sequences.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+#include "json_parser.h"
+
+typedef struct JsonPath JsonPath_t;
+
+/**
+ * Called once for every value matched by a path, in document order. `context`
+ * is passed through from `JsonPath_eval()`. Return `false` to stop the
+ * evaluation early.
+ */
+typedef bool (*JsonPathCallback_t)(JsonVal_t *match, void *context);
+
+/**
+ * Compile `path` into a query. Return `NULL` if `path` is malformed or memory
+ * couldn't be allocated. Must be deallocated with `JsonPath_free()`.
+ */
+JsonPath_t *JsonPath_compile(const char *path);
+
+/**
+ * Deallocate a query returned by `JsonPath_compile()`.
+ */
+void JsonPath_free(JsonPath_t *path);
+
+/**
+ * Evaluate `path` against `doc`, calling `callback` (if it's not `NULL`) on
+ * every match. Return the number of values that were matched.
+ */
+int JsonPath_eval(
+	const JsonPath_t *path, JsonVal_t *doc, JsonPathCallback_t callback,
+	void *context);
+
+/**
+ * Return the first value in `doc` matched by `path`, or `NULL` if there are
+ * none.
+ */
+JsonVal_t *JsonPath_first(const JsonPath_t *path, JsonVal_t *doc);
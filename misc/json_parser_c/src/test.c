@@ -8,6 +8,7 @@
 #include <string.h>
 
 #include "src/json_parser.h"
+#include "src/json_path.h"
 
 /**
  * Test whether parsing `inputStr` throws an error of type `type`.
@@ -54,6 +55,27 @@ static void testBadInputs(void){
 	testBadInput("\"\\9\"", JSON_ERR_STR_INVALID_ESCAPE);
 }
 
+/**
+ * Test whether the line and column numbers of parse errors are tracked
+ * correctly across whitespace.
+ */
+static void testErrorLocation(void){
+	const char *inputStr =
+		"{\r\n    \"a\": 1 ,\r\n                    \"b\": [\r\n\t\tx]}";
+	note("Testing error location in `%s`\n", inputStr);
+	bool failed;
+	JsonParserError_t error;
+	parse(inputStr, true, strlen(inputStr), &failed, &error);
+	ok(
+		failed && error.type == JSON_ERR_VALUE,
+		"Error type matches expected.");
+	ok(
+		error.lnNum == 4 && error.colNum == 3,
+		"Error is on line 4, column 3 (got line %d, column %d).",
+		error.lnNum, error.colNum);
+	JsonParserError_free(&error);
+}
+
 /**
  * Test whether parsing `inputStr` returns a value that's equal to `expected`.
  */
@@ -75,6 +97,7 @@ void testGoodInput(const char *inputStr, JsonVal_t expected){
  */
 static void testGoodInputs(void){
 	testGoodInput("1", CREATE_JSON_VAL(JSON_INT, {.intNum = 1}));
+	testGoodInput(" \r\n\t1", CREATE_JSON_VAL(JSON_INT, {.intNum = 1}));
 	testGoodInput("4e4", CREATE_JSON_VAL(JSON_INT, {.intNum = 40000}));
 
 	testGoodInput(
@@ -102,6 +125,19 @@ static void testGoodInputs(void){
 		CREATE_STRING("ǾǿȀȁȂȃȄȅȆȇȈȉȊȋȌȍȎȏȐȑȒȓȔȕ"));
 
 	testGoodInput("false", CREATE_JSON_VAL(JSON_BOOL, {.boolean = false}));
+	testGoodInput(
+		"[\r\n        null ,\r\n\t\t\t\t\t\t\t\t\t\ttrue\r\n]",
+		CREATE_JSON_VAL(
+			JSON_ARRAY, {
+				.array = (JsonArray_t){
+					.length = 2,
+					.values = (JsonVal_t []){
+						CREATE_JSON_VAL(JSON_NULL, {}),
+						CREATE_JSON_VAL(JSON_BOOL, {.boolean = true})
+					}
+				}
+			}
+		));
 	testGoodInput("[null, true, false]", CREATE_JSON_VAL(
 		JSON_ARRAY, {
 			.array = (JsonArray_t){
@@ -167,8 +203,436 @@ static void testGoodInputs(void){
 	);
 }
 
+// The record shape used by `testSchema()`.
+#define POINT_FIELDS(FIELD) \
+	FIELD(Point_t, x, FLOAT) \
+	FIELD(Point_t, y, FLOAT) \
+	FIELD(Point_t, id, INT) \
+	FIELD(Point_t, label, STRING) \
+	FIELD(Point_t, visible, BOOL)
+
+typedef struct {
+	POINT_FIELDS(JSON_SCHEMA_MEMBER)
+} Point_t;
+
+static const JsonSchemaField_t pointFields[] = {
+	POINT_FIELDS(JSON_SCHEMA_FIELD)
+};
+static const JsonSchema_t pointSchema = JSON_SCHEMA(pointFields);
+
+/**
+ * Test `parseWithSchema()` on both matching and non-matching records.
+ */
+static void testSchema(void){
+	note("Testing parseWithSchema()\n");
+	bool failed;
+	JsonParserError_t error;
+	JsonVal_t fallback;
+	Point_t point;
+
+	const char *matching =
+		"{\"x\": 1.5, \"y\": -2, \"id\": 7, \"label\": \"a\\tb\",\n"
+		"\"visible\": true}";
+	bool matched = parseWithSchema(
+		&pointSchema, &point, matching, true, strlen(matching), &fallback,
+		&failed, &error);
+	ok(matched && !failed, "Matching record takes the schema path.");
+	ok(
+		point.x == 1.5 && point.y == -2 && point.id == 7 && point.visible,
+		"Numeric and boolean fields match expected.");
+	ok(
+		point.label.length == 3 && strncmp(point.label.str, "a\tb", 3) == 0,
+		"String field matches expected.");
+	JsonSchema_free(&pointSchema, &point);
+
+	const char *reordered =
+		"{\"label\":\"\",\"visible\":false,\"id\":1,\"y\":2,\"x\":3}";
+	matched = parseWithSchema(
+		&pointSchema, &point, reordered, true, strlen(reordered), &fallback,
+		&failed, &error);
+	ok(matched && point.x == 3, "Reordered keys take the schema path.");
+	JsonSchema_free(&pointSchema, &point);
+
+	const char *indented =
+		"\n  {\"x\":1,\"y\":2,\"id\":3,\"label\":\"\",\"visible\":true}";
+	matched = parseWithSchema(
+		&pointSchema, &point, indented, true, strlen(indented), &fallback,
+		&failed, &error);
+	ok(matched && point.id == 3, "Leading whitespace takes the schema path.");
+	JsonSchema_free(&pointSchema, &point);
+
+	// Too many fields to track in a mask; every field is `point.id`.
+	JsonSchemaField_t wideFields[JSON_SCHEMA_MAX_FIELDS + 1];
+	for(int field = 0; field <= JSON_SCHEMA_MAX_FIELDS; field++){
+		wideFields[field] = pointFields[2];
+	}
+	const JsonSchema_t wideSchema = JSON_SCHEMA(wideFields);
+	const char *wide = "{\"id\": 1}";
+	matched = parseWithSchema(
+		&wideSchema, &point, wide, true, strlen(wide), &fallback, &failed,
+		&error);
+	ok(
+		!matched && !failed && fallback.type == JSON_OBJECT,
+		"A schema of more than %d fields falls back to parse().",
+		JSON_SCHEMA_MAX_FIELDS);
+	JsonVal_free(&fallback);
+
+	const char *mismatched[] = {
+		"{\"x\":1,\"y\":2,\"id\":3,\"label\":\"a\"}",
+		"{\"x\":1,\"y\":2,\"id\":3,\"label\":\"a\",\"visible\":true,\"z\":1}",
+		"{\"x\":1,\"y\":2,\"id\":3.5,\"label\":\"a\",\"visible\":true}",
+		"{\"x\":1,\"x\":2,\"id\":3,\"label\":\"a\",\"visible\":true}",
+		"[1, 2]"
+	};
+	for(size_t ind = 0; ind < sizeof(mismatched) / sizeof(mismatched[0]);
+		ind++){
+		matched = parseWithSchema(
+			&pointSchema, &point, mismatched[ind], true,
+			strlen(mismatched[ind]), &fallback, &failed, &error);
+		ok(
+			!matched && !failed,
+			"Mismatched record `%s` falls back to parse().", mismatched[ind]);
+		JsonVal_free(&fallback);
+	}
+
+	const char *malformed = "{\"x\": 1, \"y\": [}";
+	matched = parseWithSchema(
+		&pointSchema, &point, malformed, true, strlen(malformed), &fallback,
+		&failed, &error);
+	ok(!matched && failed, "Malformed record reports a parse error.");
+	JsonParserError_free(&error);
+}
+
+/**
+ * A `JsonPathCallback_t` that sums numeric matches into `*(float *)context`,
+ * ignoring any others.
+ */
+static bool sumMatches(JsonVal_t *match, void *context){
+	if(match->type == JSON_INT){
+		*(float *)context += match->value.intNum;
+	}
+	else if(match->type == JSON_FLOAT){
+		*(float *)context += match->value.floatNum;
+	}
+	return true;
+}
+
+/**
+ * Test whether compiling `pathStr` and evaluating it against `doc` matches
+ * `expectedMatches` values whose numeric sum is `expectedSum`.
+ */
+static void testPath(
+	const char *pathStr, JsonVal_t *doc, int expectedMatches,
+	float expectedSum){
+	JsonPath_t *path = JsonPath_compile(pathStr);
+	if(path == NULL){
+		fail("Path `%s` failed to compile.", pathStr);
+		return;
+	}
+
+	float sum = 0;
+	int numMatches = JsonPath_eval(path, doc, sumMatches, &sum);
+	ok(
+		numMatches == expectedMatches && sum == expectedSum,
+		"Path `%s` matched %d values summing to %f.", pathStr, numMatches,
+		sum);
+	JsonPath_free(path);
+}
+
+/**
+ * Test the JSONPath query compiler and evaluator.
+ */
+static void testJsonPath(void){
+	note("Testing JsonPath_compile() and JsonPath_eval()\n");
+	const char *inputStr =
+		"{\"items\": ["
+			"{\"price\": 10, \"tag\": \"a\", \"meta\": {\"ok\": true}},"
+			"{\"price\": 2.5, \"tag\": \"b\"},"
+			"{\"price\": 7, \"tag\": \"a\", \"meta\": {\"ok\": false}}"
+		"], \"total\": 1}";
+	bool failed;
+	JsonParserError_t error;
+	JsonVal_t doc = parse(inputStr, true, strlen(inputStr), &failed, &error);
+
+	testPath("$.items[*].price", &doc, 3, 19.5);
+	testPath("$['items'][0].price", &doc, 1, 10);
+	testPath("$.items[-1].price", &doc, 1, 7);
+	testPath("$.items[5].price", &doc, 0, 0);
+	testPath("$..price", &doc, 3, 19.5);
+	testPath("$.items[?(@.price > 5)].price", &doc, 2, 17);
+	testPath("$.items[?(@.tag == 'a')].price", &doc, 2, 17);
+	testPath("$.items[?(@.tag != \"a\")].price", &doc, 1, 2.5);
+	testPath("$.items[?(@.meta.ok == true)].price", &doc, 1, 10);
+	testPath("$.items[?(@.meta)].price", &doc, 2, 17);
+	testPath("$.*", &doc, 2, 1);
+
+	JsonPath_t *path = JsonPath_compile("$.items[*].tag");
+	JsonVal_t *first = JsonPath_first(path, &doc);
+	ok(
+		first != NULL && first->type == JSON_STRING &&
+		first->value.string.str[0] == 'a',
+		"JsonPath_first() returns the first match.");
+	JsonPath_free(path);
+
+	const char *badPaths[] = {
+		"items", "$.", "$[", "$[1", "$[?(@.a ==)]", "$[?(a)]", "$['a]",
+		"$[4294967296]", "$[-99999999999999999999]"
+	};
+	for(size_t ind = 0; ind < sizeof(badPaths) / sizeof(badPaths[0]); ind++){
+		ok(
+			JsonPath_compile(badPaths[ind]) == NULL,
+			"Malformed path `%s` fails to compile.", badPaths[ind]);
+	}
+
+	JsonVal_free(&doc);
+}
+
+/**
+ * A `JsonAllocator_t` that wraps the standard allocator and tracks the number
+ * of bytes it currently has outstanding in `*(size_t *)context`.
+ */
+static void *countingRealloc(
+	void *context, void *ptr, size_t oldSize, size_t size){
+	*(size_t *)context += size - oldSize;
+	return realloc(ptr, size);
+}
+
+static void countingFree(void *context, void *ptr, size_t size){
+	*(size_t *)context -= size;
+	free(ptr);
+}
+
+/**
+ * Test `parseWithOptions()`'s counters and custom allocator hook.
+ */
+static void testParserOptions(void){
+	note("Testing parseWithOptions()\n");
+	size_t outstandingBytes = 0;
+	JsonAllocator_t allocator = {
+		.realloc = countingRealloc,
+		.free = countingFree,
+		.context = &outstandingBytes
+	};
+	JsonParserStats_t stats;
+	JsonParserOptions_t options = {
+		.allocator = &allocator,
+		.stats = &stats
+	};
+
+	const char *inputStr = "{\"a\": [1, 2.5, \"xyz\", true, null], \"b\": {}}";
+	bool failed;
+	JsonParserError_t error;
+	JsonVal_t val = parseWithOptions(
+		inputStr, true, strlen(inputStr), &failed, &error, &options);
+	ok(!failed, "Boolean set to indicate success.");
+	ok(
+		stats.bytesConsumed == (int)strlen(inputStr),
+		"All input bytes were consumed.");
+	ok(
+		stats.valuesByType[JSON_OBJECT] == 2 &&
+		stats.valuesByType[JSON_ARRAY] == 1 &&
+		stats.valuesByType[JSON_INT] == 1 &&
+		stats.valuesByType[JSON_FLOAT] == 1 &&
+		stats.valuesByType[JSON_STRING] == 1 &&
+		stats.valuesByType[JSON_BOOL] == 1 &&
+		stats.valuesByType[JSON_NULL] == 1,
+		"Value counts match expected.");
+	ok(
+		stats.allocations > 0 && stats.reallocations > 0,
+		"Allocations and reallocations were counted.");
+	ok(
+		stats.peakDomBytes == outstandingBytes &&
+		stats.domBytes == outstandingBytes,
+		"DOM byte counts match the allocator's.");
+
+	JsonVal_freeWithAllocator(&val, &allocator);
+	ok(outstandingBytes == 0, "All memory was returned to the allocator.");
+
+	const char *badInputStr = "[\"abc\", [1, 2, {\"a\": tru}]]";
+	parseWithOptions(
+		badInputStr, true, strlen(badInputStr), &failed, &error, &options);
+	ok(
+		failed && outstandingBytes == 0,
+		"A failed parse returns all memory to the allocator.");
+	ok(
+		stats.domBytes == 0 && stats.peakDomBytes > 0,
+		"A failed parse leaves no DOM bytes held.");
+	JsonParserError_free(&error);
+}
+
+/**
+ * A `JsonAllocator_t` that wraps the standard allocator, tracking its
+ * outstanding bytes like `countingRealloc()`, but fails once it has granted
+ * `allocationsLeft` blocks.
+ */
+typedef struct {
+	int allocationsLeft;
+	size_t outstandingBytes;
+} FailingAllocator_t;
+
+static void *failingRealloc(
+	void *context, void *ptr, size_t oldSize, size_t size){
+	FailingAllocator_t *failing = context;
+	if(failing->allocationsLeft == 0){
+		return NULL;
+	}
+	failing->allocationsLeft--;
+	failing->outstandingBytes += size - oldSize;
+	return realloc(ptr, size);
+}
+
+static void failingFree(void *context, void *ptr, size_t size){
+	((FailingAllocator_t *)context)->outstandingBytes -= size;
+	free(ptr);
+}
+
+/**
+ * Test that a parse that runs out of memory at any point, including while
+ * growing a scratch stack over a key or value it has just parsed, returns
+ * everything it allocated.
+ */
+static void testAllocationFailures(void){
+	note("Testing allocation failures\n");
+
+	// Enough keys and values to outgrow the scratch stacks' initial capacity.
+	char inputStr[1024] = "[{";
+	for(int key = 0; key < 40; key++){
+		sprintf(
+			inputStr + strlen(inputStr), "%s\"key%d\": [\"v\", %d]",
+			(key > 0) ? ", " : "", key, key);
+	}
+	strcat(inputStr, "}, \"a\", \"b\", \"c\", \"d\", \"e\", \"f\", "
+		"\"g\", \"h\", \"i\", \"j\", \"k\", \"l\", \"m\", \"n\", "
+		"\"o\", \"p\", \"q\", \"r\"]");
+
+	FailingAllocator_t failing;
+	JsonAllocator_t allocator = {
+		.realloc = failingRealloc,
+		.free = failingFree,
+		.context = &failing
+	};
+	JsonParserOptions_t options = {.allocator = &allocator, .stats = NULL};
+
+	bool failed = true, allReleased = true;
+	int numFailures = 0;
+	for(int budget = 0; failed; budget++){
+		failing = (FailingAllocator_t){.allocationsLeft = budget};
+		JsonParserError_t error;
+		JsonVal_t val = parseWithOptions(
+			inputStr, true, strlen(inputStr), &failed, &error, &options);
+		if(failed){
+			numFailures++;
+			allReleased = allReleased && error.type == JSON_ERR_ALLOC &&
+				failing.outstandingBytes == 0;
+			JsonParserError_free(&error);
+		}
+		else {
+			JsonVal_freeWithAllocator(&val, &allocator);
+		}
+	}
+	ok(
+		allReleased && numFailures > 0,
+		"Every failed allocation (%d) returns all memory.", numFailures);
+}
+
+/**
+ * A `JsonAllocator_t` that wraps the standard allocator and counts the blocks
+ * it has allocated or reallocated in `*(int *)context`.
+ */
+static void *tallyingRealloc(
+	void *context, void *ptr, size_t oldSize, size_t size){
+	(void)oldSize;
+	(*(int *)context)++;
+	return realloc(ptr, size);
+}
+
+static void tallyingFree(void *context, void *ptr, size_t size){
+	(void)context;
+	(void)size;
+	free(ptr);
+}
+
+/**
+ * Test parsing several documents in a `JsonParserSession_t`.
+ */
+static void testParserSession(void){
+	note("Testing JsonParserSession_parse()\n");
+	JsonParserSession_t *session = JsonParserSession_create();
+	const char *inputStrs[] = {
+		"{\"id\": 1, \"tags\": [\"a\", \"b\"], \"nested\": {\"id\": 2}}",
+		"{\"id\": 3, \"tags\": [], \"nested\": {\"id\": [{}]}}",
+		"{\"id\": 4, \"tags\": [\"c\"], \"nested\": {\"id\": 5}}"
+	};
+
+	const char *firstKey = NULL;
+	for(int doc = 0; doc < 3; doc++){
+		const char *inputStr = inputStrs[doc];
+		bool failed;
+		JsonParserError_t error;
+
+		JsonVal_t expected = parse(
+			inputStr, true, strlen(inputStr), &failed, &error);
+		JsonVal_t actual = JsonParserSession_parse(
+			session, inputStr, true, strlen(inputStr), &failed, &error);
+		ok(
+			!failed && JsonVal_eq(&actual, &expected),
+			"Document %d matches the one parsed by parse().", doc);
+		JsonVal_free(&expected);
+
+		const char *key = actual.value.object.keys[0].str;
+		if(firstKey == NULL){
+			firstKey = key;
+		}
+		else {
+			ok(key == firstKey, "Document %d shares interned keys.", doc);
+		}
+
+		const char *badInputStr = "{\"id\": [1, {\"id\": tru}]}";
+		JsonParserSession_parse(
+			session, badInputStr, true, strlen(badInputStr), &failed,
+			&error);
+		ok(failed, "Malformed document fails inside the session.");
+		JsonParserError_free(&error);
+	}
+
+	JsonParserSession_destroy(session);
+
+	// Once the first parse has sized the session's buffers, parsing the same
+	// document again shouldn't allocate anything.
+	int numAllocations = 0;
+	JsonAllocator_t allocator = {
+		.realloc = tallyingRealloc,
+		.free = tallyingFree,
+		.context = &numAllocations
+	};
+	session = JsonParserSession_createWithAllocator(&allocator);
+	const char *inputStr = inputStrs[0];
+	bool failed;
+	JsonParserError_t error;
+	JsonParserSession_parse(
+		session, inputStr, true, strlen(inputStr), &failed, &error);
+	int warmAllocations = numAllocations;
+	bool allParsed = !failed;
+	for(int repeat = 0; repeat < 100; repeat++){
+		JsonParserSession_parse(
+			session, inputStr, true, strlen(inputStr), &failed, &error);
+		allParsed = allParsed && !failed;
+	}
+	ok(
+		allParsed && warmAllocations > 0 && numAllocations == warmAllocations,
+		"Repeated parses in a warm session allocate nothing (%d after the "
+		"first parse).", numAllocations - warmAllocations);
+	JsonParserSession_destroy(session);
+}
+
 int main(){
 	testBadInputs();
 	testGoodInputs();
+	testErrorLocation();
+	testSchema();
+	testJsonPath();
+	testParserOptions();
+	testAllocationFailures();
+	testParserSession();
 	return EXIT_SUCCESS;
 }